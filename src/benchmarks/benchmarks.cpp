@@ -0,0 +1,394 @@
+#include <benchmark/benchmark.h>
+
+#include "../include/3dmodel.h"
+#include "../include/gui.h"
+#include "../include/mesh_adjacency.h"
+#include "mesh_generator.h"
+
+namespace {
+
+using s21::MeshGenerator;
+using s21::MeshKind;
+
+using EdgesSet = std::unordered_set<std::pair<unsigned int, unsigned int>,
+                                    s21::PairHash>;
+
+// количество граней моделей; размеры больше S21_BENCH_MAX_FACES пропускаются
+const std::vector<size_t> kFacesCounts = {1'000,      10'000,     100'000,
+                                          1'000'000,  10'000'000, 50'000'000};
+const size_t kDefaultMaxFaces = 1'000'000;
+
+const std::vector<MeshKind> kMeshKinds = {MeshKind::kGrid, MeshKind::kSphere,
+                                          MeshKind::kSoup};
+
+size_t MaxFaces() {
+  size_t max_faces = kDefaultMaxFaces;
+  bool ok = false;
+  qulonglong value =
+      qEnvironmentVariable("S21_BENCH_MAX_FACES").toULongLong(&ok);
+  if (ok) {
+    max_faces = static_cast<size_t>(value);
+  }
+  return max_faces;
+}
+
+std::string DataDir() {
+  QString dir = qEnvironmentVariable("S21_BENCH_DATA_DIR");
+  if (dir.isEmpty()) {
+    dir = QDir::tempPath() + "/3dviewer_bench";
+  }
+  return dir.toStdString();
+}
+
+/**
+ * @brief Те же ребра, что строит ObjLoader::edges_count_(): каждое ребро грани
+ * в виде упорядоченной пары индексов
+ */
+void InsertFaceEdges(const std::vector<unsigned int> &face, EdgesSet &edges) {
+  for (size_t i = 0; i < face.size(); ++i) {
+    unsigned int first = face[i];
+    unsigned int second = face[(i + 1) % face.size()];
+    edges.insert({std::min(first, second), std::max(first, second)});
+  }
+}
+
+/**
+ * @brief Модель в памяти для бенчмарков без разбора файла. Хранится только
+ * последняя запрошенная модель: бенчмарки регистрируются сгруппированными по
+ * модели, а большие модели занимают гигабайты.
+ */
+struct MeshFixture {
+  MeshKind kind = MeshKind::kGrid;
+  size_t faces_count = 0;
+  s21::SyntheticMesh mesh;
+  EdgesSet edges;
+
+  static MeshFixture &Get(MeshKind kind, size_t faces_count) {
+    static MeshFixture fixture;
+    if (fixture.mesh.faces.empty() || fixture.kind != kind ||
+        fixture.faces_count != faces_count) {
+      fixture = MeshFixture();
+      fixture.kind = kind;
+      fixture.faces_count = faces_count;
+      fixture.mesh = MeshGenerator(kind, faces_count).Generate();
+      for (const auto &face : fixture.mesh.faces) {
+        InsertFaceEdges(face, fixture.edges);
+      }
+    }
+    return fixture;
+  }
+};
+
+void SetModelCounters(benchmark::State &state, const MeshFixture &fixture) {
+  state.counters["vertices"] =
+      static_cast<double>(fixture.mesh.vertices.size());
+  state.counters["faces"] = static_cast<double>(fixture.mesh.faces.size());
+  state.counters["edges"] = static_cast<double>(fixture.edges.size());
+}
+
+// ____________________________________________________________________________
+// разбор .obj файла целиком (чтение, вершины, грани, множество ребер)
+void BM_ObjLoad(benchmark::State &state, MeshKind kind, size_t faces_count) {
+  std::string path;
+  try {
+    path = MeshGenerator(kind, faces_count).WriteObjFile(DataDir());
+  } catch (const std::runtime_error &error) {
+    // цикл измерений после SkipWithError не выполняется
+    state.SkipWithError(error.what());
+  }
+  qint64 file_size = QFileInfo(QString::fromStdString(path)).size();
+  size_t edges_count = 0;
+  for (auto _ : state) {
+    s21::ObjLoader loader(path);
+    loader.Load();
+    if (!loader.IsLoaded()) {
+      state.SkipWithError("ObjLoader failed to load the synthetic model");
+      break;
+    }
+    edges_count = loader.GetEdges().size();
+    benchmark::DoNotOptimize(edges_count);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          file_size);
+  state.counters["edges"] = static_cast<double>(edges_count);
+}
+
+// построение множества уникальных ребер по уже разобранным граням
+void BM_EdgeDedup(benchmark::State &state, MeshKind kind, size_t faces_count) {
+  const MeshFixture &fixture = MeshFixture::Get(kind, faces_count);
+  for (auto _ : state) {
+    EdgesSet edges;
+    for (const auto &face : fixture.mesh.faces) {
+      InsertFaceEdges(face, edges);
+    }
+    benchmark::DoNotOptimize(edges.size());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(fixture.mesh.faces.size()));
+  SetModelCounters(state, fixture);
+}
+
+// копирование данных загрузчика в Model3D и расчет BoundingBox
+void BM_ModelSetData(benchmark::State &state, MeshKind kind,
+                     size_t faces_count) {
+  const MeshFixture &fixture = MeshFixture::Get(kind, faces_count);
+  for (auto _ : state) {
+    s21::Model3D model;
+    model.SetData(fixture.mesh.vertices, fixture.mesh.faces, fixture.edges);
+    benchmark::DoNotOptimize(model.GetVerticesCount());
+  }
+  SetModelCounters(state, fixture);
+}
+
+// подготовка буферов для OpenGL
+void BM_ModelToGlFormat(benchmark::State &state, MeshKind kind,
+                        size_t faces_count) {
+  const MeshFixture &fixture = MeshFixture::Get(kind, faces_count);
+  s21::Model3D model;
+  model.SetData(fixture.mesh.vertices, fixture.mesh.faces, fixture.edges);
+  for (auto _ : state) {
+    std::vector<float> vertices = model.GetVerticesToGlFormat();
+    std::vector<unsigned int> edges = model.GetEdgesToGlFormat();
+    benchmark::DoNotOptimize(vertices.data());
+    benchmark::DoNotOptimize(edges.data());
+  }
+  SetModelCounters(state, fixture);
+}
+
+// построение смежности ребер и граней (MeshAdjacency)
+void BM_MeshAdjacency(benchmark::State &state, MeshKind kind,
+                      size_t faces_count) {
+  const MeshFixture &fixture = MeshFixture::Get(kind, faces_count);
+  for (auto _ : state) {
+    s21::MeshAdjacency adjacency = s21::MeshAdjacency::Build(
+        fixture.mesh.vertices.size(), fixture.mesh.faces);
+    benchmark::DoNotOptimize(adjacency.GetEdgesCount());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(fixture.mesh.faces.size()));
+  SetModelCounters(state, fixture);
+}
+
+// ____________________________________________________________________________
+// матрицы: то, что Scene пересчитывает на каждое движение мыши
+void BM_AffineModelMatrix(benchmark::State &state) {
+  s21::Vector3D axis(0.0, 1.0, 0.0);
+  for (auto _ : state) {
+    s21::AffineTransDecorator model(
+        std::make_unique<s21::S21MatrixWrapper>(4, 4));
+    model.SetIdentity();
+    model.Translation(1.0, 2.0, 3.0);
+    model.Rotation(30.0, axis);
+    model.Scale(2.0, 2.0, 2.0);
+    benchmark::DoNotOptimize(model(0, 0));
+  }
+}
+
+void BM_AffineMVP(benchmark::State &state) {
+  s21::AffineTransDecorator affine(
+      std::make_unique<s21::S21MatrixWrapper>(4, 4));
+  affine.SetIdentity();
+  S21Matrix projection =
+      affine.CreateProjMatrixPersp(60.0, 16.0 / 9.0, 0.1, 100.0);
+  S21Matrix view = affine.CreateViewMatrix(
+      s21::Vector3D(0.0, 0.0, 5.0), s21::Vector3D(), s21::Vector3D(0.0, 1.0));
+  S21Matrix model = affine.GetMatrix();
+  for (auto _ : state) {
+    S21Matrix mvp = affine.CreateMVPMatrix(projection, view, model);
+    benchmark::DoNotOptimize(mvp(0, 0));
+  }
+}
+
+// ____________________________________________________________________________
+/**
+ * @brief GLWidget с доступом к paintGL(): кадр рисуется во внеэкранный буфер,
+ * glFinish() дожидается окончания отрисовки, чтобы измерялась работа
+ * видеокарты, а не только постановка команд в очередь
+ */
+class BenchGLWidget : public s21::GLWidget {
+ private:
+  std::unique_ptr<QOpenGLFramebufferObject> fbo_;
+
+ public:
+  BenchGLWidget() : s21::GLWidget(nullptr) {}
+
+  bool WaitForContext() {
+    show();
+    for (int i = 0; i < 100 && !isValid(); ++i) {
+      QApplication::processEvents();
+      QThread::msleep(10);
+    }
+    return isValid() && context();
+  }
+
+  void WaitForUpload() {
+    while (IsUploading()) {
+      QApplication::processEvents();
+    }
+  }
+
+  void DrawFrame(int frame_width, int frame_height) {
+    makeCurrent();
+    if (!fbo_ || fbo_->size() != QSize(frame_width, frame_height)) {
+      fbo_ = std::make_unique<QOpenGLFramebufferObject>(
+          frame_width, frame_height, QOpenGLFramebufferObject::Depth);
+    }
+    fbo_->bind();
+    glViewport(0, 0, frame_width, frame_height);
+    paintGL();
+    glFinish();
+    fbo_->release();
+    doneCurrent();
+  }
+};
+
+// виджет создается в main() после QApplication и удаляется до нее
+BenchGLWidget *render_widget = nullptr;
+
+void BM_PaintGL(benchmark::State &state, MeshKind kind, size_t faces_count) {
+  BenchGLWidget *widget = render_widget;
+  if (!widget || !widget->WaitForContext()) {
+    state.SkipWithError("OpenGL context is not available");
+  } else {
+    const MeshFixture &fixture = MeshFixture::Get(kind, faces_count);
+    s21::Model3D model;
+    model.SetData(fixture.mesh.vertices, fixture.mesh.faces, fixture.edges);
+    widget->SetModelData(model.GetVerticesToGlFormat(),
+                         model.GetEdgesToGlFormat());
+    widget->WaitForUpload();
+    for (auto _ : state) {
+      widget->DrawFrame(1920, 1080);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(fixture.edges.size()));
+    SetModelCounters(state, fixture);
+  }
+}
+
+/**
+ * @brief Загрузка модели в видеопамять: время итерации - до окончания
+ * загрузки, gui_thread_ms - сколько из него занят поток gui (SetModelData)
+ */
+void BM_GlUpload(benchmark::State &state, MeshKind kind, size_t faces_count) {
+  BenchGLWidget *widget = render_widget;
+  if (!widget || !widget->WaitForContext()) {
+    state.SkipWithError("OpenGL context is not available");
+  } else {
+    const MeshFixture &fixture = MeshFixture::Get(kind, faces_count);
+    s21::Model3D model;
+    model.SetData(fixture.mesh.vertices, fixture.mesh.faces, fixture.edges);
+    std::vector<float> vertices = model.GetVerticesToGlFormat();
+    std::vector<unsigned int> edges = model.GetEdgesToGlFormat();
+    double gui_thread_ms = 0;
+    for (auto _ : state) {
+      auto start = std::chrono::steady_clock::now();
+      widget->SetModelData(vertices, edges);
+      gui_thread_ms += std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+      widget->WaitForUpload();
+    }
+    state.counters["gui_thread_ms"] = benchmark::Counter(
+        gui_thread_ms, benchmark::Counter::kAvgIterations);
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations()) *
+        static_cast<int64_t>(vertices.size() * sizeof(float) +
+                             edges.size() * sizeof(unsigned int)));
+    SetModelCounters(state, fixture);
+  }
+}
+
+// ____________________________________________________________________________
+bool HasDisplay() {
+  return qEnvironmentVariableIsSet("DISPLAY") ||
+         qEnvironmentVariableIsSet("WAYLAND_DISPLAY") ||
+         qEnvironmentVariableIsSet("QT_QPA_PLATFORM");
+}
+
+template <typename Function>
+void RegisterModelBenchmark(const std::string &name, Function function,
+                            MeshKind kind, size_t faces_count) {
+  std::string full_name = name + "/" + MeshGenerator::KindName(kind) + "/" +
+                          std::to_string(faces_count);
+  benchmark::RegisterBenchmark(full_name.c_str(), function, kind, faces_count)
+      ->Unit(benchmark::kMillisecond)
+      ->UseRealTime();
+}
+
+/**
+ * @brief Регистрация бенчмарков моделей. Бенчмарки идут группами по модели,
+ * чтобы каждая модель генерировалась один раз (см. MeshFixture).
+ */
+void RegisterBenchmarks(bool with_render) {
+  const size_t max_faces = MaxFaces();
+  benchmark::RegisterBenchmark("Affine/ModelMatrix", BM_AffineModelMatrix);
+  benchmark::RegisterBenchmark("Affine/MVP", BM_AffineMVP);
+  for (size_t faces_count : kFacesCounts) {
+    if (faces_count > max_faces) {
+      std::cerr << "skipping models with " << faces_count
+                << " faces (S21_BENCH_MAX_FACES=" << max_faces << ")\n";
+    }
+    for (size_t i = 0; faces_count <= max_faces && i < kMeshKinds.size();
+         ++i) {
+      MeshKind kind = kMeshKinds[i];
+      RegisterModelBenchmark("ObjLoader/Load", BM_ObjLoad, kind, faces_count);
+      RegisterModelBenchmark("Edges/Dedup", BM_EdgeDedup, kind, faces_count);
+      RegisterModelBenchmark("Model3D/SetData", BM_ModelSetData, kind,
+                             faces_count);
+      RegisterModelBenchmark("Model3D/ToGlFormat", BM_ModelToGlFormat, kind,
+                             faces_count);
+      RegisterModelBenchmark("Model3D/Adjacency", BM_MeshAdjacency, kind,
+                             faces_count);
+      if (with_render) {
+        RegisterModelBenchmark("GLWidget/PaintGL", BM_PaintGL, kind,
+                               faces_count);
+        RegisterModelBenchmark("GLWidget/Upload", BM_GlUpload, kind,
+                               faces_count);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief По умолчанию результаты, кроме консоли, пишутся в
+ * benchmark_results.json (формат Google Benchmark, удобно сравнивать прогоны
+ * скриптом compare.py из поставки Google Benchmark). Любые флаги
+ * --benchmark_* передаются как есть.
+ */
+int main(int argc, char *argv[]) {
+  std::vector<char *> arguments(argv, argv + argc);
+  std::string out_flag = "--benchmark_out=benchmark_results.json";
+  std::string format_flag = "--benchmark_out_format=json";
+  bool has_out = std::any_of(arguments.begin(), arguments.end(), [](char *arg) {
+    return std::string(arg).rfind("--benchmark_out=", 0) == 0;
+  });
+  if (!has_out) {
+    arguments.push_back(out_flag.data());
+    arguments.push_back(format_flag.data());
+  }
+  int arguments_count = static_cast<int>(arguments.size());
+  benchmark::Initialize(&arguments_count, arguments.data());
+  if (benchmark::ReportUnrecognizedArguments(arguments_count,
+                                             arguments.data())) {
+    return 1;
+  }
+
+  // без дисплея (например, в CI без xvfb) измеряется только процессорная часть
+  std::unique_ptr<QApplication> application;
+  std::unique_ptr<BenchGLWidget> widget;
+  if (HasDisplay()) {
+    application = std::make_unique<QApplication>(argc, argv);
+    widget = std::make_unique<BenchGLWidget>();
+    widget->resize(800, 600);
+    render_widget = widget.get();
+  } else {
+    std::cerr << "no display: GLWidget benchmarks are disabled\n";
+  }
+  RegisterBenchmarks(widget != nullptr);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  render_widget = nullptr;
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include "mesh_generator.h"
+
+namespace s21 {
+
+MeshGenerator::MeshGenerator(MeshKind kind, size_t target_faces,
+                             unsigned int seed)
+    : kind_(kind), target_faces_(target_faces), seed_(seed) {
+  if (target_faces == 0) {
+    throw std::invalid_argument(
+        "MeshGenerator::MeshGenerator(): faces count cannot be 0!");
+  }
+}
+
+SyntheticMesh MeshGenerator::Generate() const {
+  SyntheticMesh mesh;
+  generate_(
+      [&mesh](double x, double y, double z) {
+        mesh.vertices.emplace_back(x, y, z);
+      },
+      [&mesh](unsigned int a, unsigned int b, unsigned int c) {
+        mesh.faces.push_back({a, b, c});
+      });
+  return mesh;
+}
+
+/**
+ * @brief Потоковая запись модели в формате .obj (индексы с единицы)
+ */
+void MeshGenerator::WriteObj(std::ostream &out) const {
+  out << "# synthetic " << KindName(kind_) << " mesh, " << target_faces_
+      << " faces\n";
+  generate_(
+      [&out](double x, double y, double z) {
+        out << "v " << x << ' ' << y << ' ' << z << '\n';
+      },
+      [&out](unsigned int a, unsigned int b, unsigned int c) {
+        out << "f " << a + 1 << ' ' << b + 1 << ' ' << c + 1 << '\n';
+      });
+}
+
+/**
+ * @brief Запись модели в dir. Уже сгенерированный файл используется повторно,
+ * поэтому большие модели генерируются один раз. Файл пишется во временный и
+ * переименовывается, только если запись прошла целиком.
+ * @return путь к файлу
+ * @throw std::runtime_error - не удалось записать или переименовать файл
+ */
+std::string MeshGenerator::WriteObjFile(const std::string &dir) const {
+  std::string path = dir + "/" + KindName(kind_) + "_" +
+                     std::to_string(target_faces_) + ".obj";
+  if (!QFileInfo::exists(QString::fromStdString(path))) {
+    QDir().mkpath(QString::fromStdString(dir));
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out.is_open()) {
+      throw std::runtime_error(
+          "MeshGenerator::WriteObjFile(): unable to open " + tmp_path);
+    }
+    WriteObj(out);
+    out.close();
+    if (out.fail()) {
+      std::remove(tmp_path.c_str());
+      throw std::runtime_error(
+          "MeshGenerator::WriteObjFile(): unable to write " + tmp_path);
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      std::remove(tmp_path.c_str());
+      throw std::runtime_error(
+          "MeshGenerator::WriteObjFile(): unable to rename " + tmp_path);
+    }
+  }
+  return path;
+}
+
+std::string MeshGenerator::KindName(MeshKind kind) {
+  std::string name = "soup";
+  if (kind == MeshKind::kGrid) {
+    name = "grid";
+  } else if (kind == MeshKind::kSphere) {
+    name = "sphere";
+  }
+  return name;
+}
+
+template <typename VertexSink, typename FaceSink>
+void MeshGenerator::generate_(VertexSink add_vertex, FaceSink add_face) const {
+  if (kind_ == MeshKind::kGrid) {
+    // n x n квадратов, по два треугольника в каждом
+    size_t n = std::max<size_t>(
+        1, static_cast<size_t>(std::sqrt(target_faces_ / 2.0)));
+    for (size_t row = 0; row <= n; ++row) {
+      for (size_t column = 0; column <= n; ++column) {
+        add_vertex(static_cast<double>(column) / n - 0.5,
+                   static_cast<double>(row) / n - 0.5, 0.0);
+      }
+    }
+    for (size_t row = 0; row < n; ++row) {
+      for (size_t column = 0; column < n; ++column) {
+        auto top_left = static_cast<unsigned int>(row * (n + 1) + column);
+        auto bottom_left = static_cast<unsigned int>(top_left + n + 1);
+        add_face(top_left, bottom_left, top_left + 1);
+        add_face(top_left + 1, bottom_left, bottom_left + 1);
+      }
+    }
+  } else if (kind_ == MeshKind::kSphere) {
+    // stacks x slices четырехугольников, по два треугольника в каждом;
+    // полюса - отдельные вершины
+    size_t slices = std::max<size_t>(
+        4, static_cast<size_t>(std::sqrt(static_cast<double>(target_faces_))));
+    size_t stacks = std::max<size_t>(2, slices / 2);
+    add_vertex(0.0, 0.0, 1.0);
+    for (size_t stack = 1; stack < stacks; ++stack) {
+      double theta = M_PI * stack / stacks;
+      for (size_t slice = 0; slice < slices; ++slice) {
+        double phi = 2.0 * M_PI * slice / slices;
+        add_vertex(std::sin(theta) * std::cos(phi),
+                   std::sin(theta) * std::sin(phi), std::cos(theta));
+      }
+    }
+    auto south = static_cast<unsigned int>(1 + (stacks - 1) * slices);
+    add_vertex(0.0, 0.0, -1.0);
+    auto ring = [slices](size_t stack, size_t slice) {
+      return static_cast<unsigned int>(1 + (stack - 1) * slices +
+                                       slice % slices);
+    };
+    for (size_t slice = 0; slice < slices; ++slice) {
+      add_face(0, ring(1, slice), ring(1, slice + 1));
+      add_face(south, ring(stacks - 1, slice + 1), ring(stacks - 1, slice));
+    }
+    for (size_t stack = 1; stack + 1 < stacks; ++stack) {
+      for (size_t slice = 0; slice < slices; ++slice) {
+        add_face(ring(stack, slice), ring(stack + 1, slice),
+                 ring(stack, slice + 1));
+        add_face(ring(stack, slice + 1), ring(stack + 1, slice),
+                 ring(stack + 1, slice + 1));
+      }
+    }
+  } else {
+    std::mt19937 generator(seed_);
+    std::uniform_real_distribution<double> coordinate(-1.0, 1.0);
+    for (size_t face = 0; face < target_faces_; ++face) {
+      for (int i = 0; i < 3; ++i) {
+        add_vertex(coordinate(generator), coordinate(generator),
+                   coordinate(generator));
+      }
+      auto first = static_cast<unsigned int>(face * 3);
+      add_face(first, first + 1, first + 2);
+    }
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,54 @@
+#ifndef MESH_GENERATOR_H
+#define MESH_GENERATOR_H
+
+#include "../include/affine.h"
+#include "../include/include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Вид синтетической модели для бенчмарков:
+ * kGrid - плоская сетка из квадратов, разбитых на треугольники (почти все
+ * ребра общие для двух граней);
+ * kSphere - UV-сфера (замкнутая поверхность, как у типичной модели);
+ * kSoup - отдельные треугольники со случайными вершинами (ребра не
+ * повторяются, худший случай для хэш-множества ребер).
+ */
+enum class MeshKind { kGrid, kSphere, kSoup };
+
+struct SyntheticMesh {
+  std::vector<Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+};
+
+/**
+ * @brief Генератор треугольных моделей с заданным (приблизительно, с
+ * точностью до размеров сетки) количеством граней. Генерация детерминирована:
+ * при одинаковых параметрах получается одна и та же модель.
+ * @details Большие модели (десятки миллионов граней) не помещаются в
+ * SyntheticMesh, поэтому .obj файл пишется потоково, без хранения модели в
+ * памяти.
+ */
+class MeshGenerator {
+ private:
+  MeshKind kind_;
+  size_t target_faces_;
+  unsigned int seed_;
+
+ public:
+  MeshGenerator(MeshKind kind, size_t target_faces, unsigned int seed = 21);
+
+  SyntheticMesh Generate() const;
+  void WriteObj(std::ostream &out) const;
+  std::string WriteObjFile(const std::string &dir) const;
+
+  static std::string KindName(MeshKind kind);
+
+ private:
+  template <typename VertexSink, typename FaceSink>
+  void generate_(VertexSink add_vertex, FaceSink add_face) const;
+};
+
+}  // namespace s21
+
+#endif
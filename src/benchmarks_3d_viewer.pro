@@ -0,0 +1,91 @@
+TEMPLATE = app
+CONFIG += c++20 console qt
+QT += core gui widgets opengl openglwidgets
+
+TARGET = benchmark_3d_viewer
+
+INCLUDEPATH += \
+    . \
+    include \
+    benchmarks
+
+SOURCES += \
+    cpp_files/gui.cpp \
+    cpp_files/affine.cpp \
+    include/matrix/s21_matrix_oop.cpp \
+    include/matrix/s21_matrix_oop_private.cpp \
+    cpp_files/3dmodel.cpp \
+    cpp_files/camera.cpp \
+    cpp_files/controller.cpp \
+    cpp_files/projection.cpp \
+    cpp_files/scene.cpp \
+    cpp_files/viewer_memento.cpp \
+    cpp_files/gif_creator.cpp \
+    cpp_files/frame_buffer.cpp \
+    cpp_files/gif_encoder.cpp \
+    cpp_files/image_encoder.cpp \
+    cpp_files/gl_uploader.cpp \
+    cpp_files/job_system.cpp \
+    cpp_files/memory_stats.cpp \
+    cpp_files/tracer.cpp \
+    cpp_files/mesh_cache.cpp \
+    cpp_files/mesh_lod.cpp \
+    cpp_files/interaction_quality.cpp \
+    cpp_files/edge_clusters.cpp \
+    cpp_files/feature_edges.cpp \
+    cpp_files/mesh_adjacency.cpp \
+    cpp_files/mesh_validation.cpp \
+    cpp_files/model_cache.cpp \
+    cpp_files/model_prefetcher.cpp \
+    cpp_files/thumbnail.cpp \
+    cpp_files/batch_cli.cpp \
+    cpp_files/session_store.cpp \
+    cpp_files/tiled_screenshot.cpp \
+    benchmarks/mesh_generator.cpp \
+    benchmarks/benchmarks.cpp
+
+HEADERS += \
+    include/gui.h \
+    include/3dmodel.h \
+    include/controller.h \
+    include/scene.h \
+    include/gif_creator.h \
+    include/frame_buffer.h \
+    include/gif_encoder.h \
+    include/image_encoder.h \
+    include/gl_uploader.h \
+    include/job_system.h \
+    include/memory_stats.h \
+    include/tracer.h \
+    include/mesh_cache.h \
+    include/mesh_lod.h \
+    include/interaction_quality.h \
+    include/edge_clusters.h \
+    include/feature_edges.h \
+    include/mesh_adjacency.h \
+    include/mesh_validation.h \
+    include/model_cache.h \
+    include/model_prefetcher.h \
+    include/thumbnail.h \
+    include/batch_cli.h \
+    include/session_store.h \
+    include/tiled_screenshot.h \
+    benchmarks/mesh_generator.h
+
+# ImageMagick
+IMAGEMAGICK_CFLAGS = $$system(pkg-config --cflags Magick++-6.Q16)
+IMAGEMAGICK_LIBS   = $$system(pkg-config --libs Magick++-6.Q16 MagickWand-6.Q16 MagickCore-6.Q16)
+
+QMAKE_CXXFLAGS += $$IMAGEMAGICK_CFLAGS
+LIBS += $$IMAGEMAGICK_LIBS
+
+# OpenMP
+QMAKE_CXXFLAGS += -fopenmp
+LIBS += -fopenmp
+
+# измерения имеют смысл только для оптимизированной сборки
+CONFIG += release
+QMAKE_CXXFLAGS += -O2 -Wall -Wextra -Werror
+
+# Google Benchmark
+LIBS += -lbenchmark -pthread
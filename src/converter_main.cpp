@@ -0,0 +1,16 @@
+#include "./include/batch_cli.h"
+#include "./include/include_common.h"
+#include "./include/tracer.h"
+
+/**
+ * @brief obj_converter: прогрев кэша моделей для 3d_viewer. Обходит каталоги,
+ * параллельно разбирает .obj файлы и пишет двоичные кэши и миниатюры.
+ */
+int main(int argc, char *argv[]) {
+  s21::Tracer::StartFromEnvironment(argc, argv);
+  s21::Tracer::Instance().SetThreadName("main");
+  QCoreApplication app(argc, argv);
+  int result = s21::BatchCli::RunConverter(app.arguments());
+  s21::Tracer::Instance().Stop();
+  return result;
+}
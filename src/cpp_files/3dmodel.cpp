@@ -1,5 +1,8 @@
 #include "./../include/3dmodel.h"
 
+#include "./../include/mesh_adjacency.h"
+#include "./../include/mesh_cache.h"
+
 namespace s21 {
 
 Model3DDataGl::Model3DDataGl(std::vector<float> verts,
@@ -29,31 +32,177 @@ const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash> &
 ObjLoader::GetEdges() {
   return edges_;
 }
+
+/**
+ * @brief Забрать прочитанные данные без копирования (загрузчик после этого
+ * пуст)
+ */
+MeshData ObjLoader::TakeData() {
+  MeshData mesh;
+  mesh.vertices = std::move(vertices_);
+  mesh.faces = std::move(faces_);
+  mesh.edges = std::move(edges_);
+  vertices_.clear();
+  faces_.clear();
+  edges_.clear();
+  return mesh;
+}
 // ________________________________________________________________________
 
+void ObjLoader::SetMode(ObjLoadMode mode) { mode_ = mode; }
+
+void ObjLoader::SetCancellationToken(const CancellationToken &token) {
+  cancel_token_ = token;
+}
+
+const std::vector<std::string> &ObjLoader::GetErrors() const { return errors_; }
+
+bool ObjLoader::IsLoaded() const { return is_loaded_; }
+
+bool ObjLoader::IsCancelled() const { return is_cancelled_; }
+
+void ObjLoader::SetCacheDir(const QString &cache_dir) { cache_dir_ = cache_dir; }
+
+bool ObjLoader::IsFromCache() const { return is_from_cache_; }
+
 /**
  * @brief Метод для чтения OBJ файла. В процессе чтения записываются данные о
- * вершинах (vertices_), гранях (faces_), количестве ребер (edges_)
+ * вершинах (vertices_), гранях (faces_), количестве ребер (edges_).
+ * Loaded испускается, только если файл прочитан до конца: не было отмены и (в
+ * строгом режиме) ошибок. Индекс вершины вне диапазона в строгом режиме
+ * по-прежнему выбрасывает std::out_of_range.
  */
 void ObjLoader::Load() {
-  std::ifstream in;
-  in.open(obj_file_);
-  if (in.is_open()) {
-    std::string line;
-    Vector3D vertix;
-    line.reserve(256);
-    while (std::getline(in, line)) {
-      if (is_vertex_(line)) {
-        add_vertex_(line);
-      } else if (is_face_(line)) {
-        add_face_(line);
+  TraceScope trace("ObjLoader::Load", "loader");
+  vertices_.clear();
+  faces_.clear();
+  edges_.clear();
+  errors_.clear();
+  is_loaded_ = false;
+  is_cancelled_ = false;
+  is_from_cache_ = false;
+  if (load_from_cache_()) {
+    is_loaded_ = true;
+    is_from_cache_ = true;
+  } else {
+    std::ifstream in;
+    in.open(obj_file_, std::ios::binary | std::ios::ate);
+    if (in.is_open()) {
+      qint64 total_bytes = static_cast<qint64>(in.tellg());
+      in.seekg(0);
+      is_loaded_ = parse_stream_(in, total_bytes);
+    } else {
+      errors_.push_back("Model3D::ReadObjFile(): file does not exist!");
+    }
+    in.close();
+  }
+  report_load_errors_();
+  if (is_loaded_) {
+    emit Loaded(vertices_, faces_, edges_);
+  }
+}
+
+/**
+ * @brief Чтение модели из двоичного кэша. Кэш пишется только для файлов без
+ * ошибок, поэтому результат совпадает с разбором в любом режиме. Поврежденный
+ * кэш не является ошибкой загрузки: файл просто разбирается заново.
+ * @return true - модель прочитана из кэша
+ */
+bool ObjLoader::load_from_cache_() {
+  TraceScope trace("ObjLoader::load_from_cache_", "loader");
+  bool result = false;
+  QString source = QString::fromStdString(obj_file_);
+  if (!cache_dir_.isEmpty()) {
+    QString cache_path = MeshCache::CachePathFor(cache_dir_, source);
+    if (MeshCache::IsValid(cache_path, source)) {
+      try {
+        MeshData mesh = MeshCache::Read(cache_path);
+        vertices_ = std::move(mesh.vertices);
+        faces_ = std::move(mesh.faces);
+        edges_ = std::move(mesh.edges);
+        qint64 total_bytes = QFileInfo(source).size();
+        emit Progress(total_bytes, total_bytes);
+        result = true;
+      } catch (std::invalid_argument &error) {
+        qDebug() << "ObjLoader: cache ignored:" << error.what();
       }
     }
-  } else {
-    emit LoadError("Model3D::ReadObjFile(): file does not exist!");
   }
-  in.close();
-  emit Loaded(vertices_, faces_, edges_);
+  return result;
+}
+
+/**
+ * @brief Построчный разбор файла с проверкой отмены и отчетом о прогрессе
+ * @return true - файл прочитан до конца
+ */
+bool ObjLoader::parse_stream_(std::istream &in, qint64 total_bytes) {
+  TraceScope trace("ObjLoader::parse_stream_", "loader");
+  std::string line;
+  line.reserve(256);
+  size_t line_number = 0;
+  qint64 bytes_read = 0;
+  const qint64 progress_step = std::max<qint64>(1, total_bytes / 100);
+  qint64 next_progress = progress_step;
+  qint64 reported_bytes = 0;
+  bool result = true;
+  while (result && std::getline(in, line)) {
+    ++line_number;
+    bytes_read += static_cast<qint64>(line.size()) + 1;
+    try {
+      parse_line_(line);
+    } catch (std::invalid_argument &error) {
+      errors_.push_back("line " + std::to_string(line_number) + ": " +
+                        error.what());
+      result = mode_ == ObjLoadMode::kLenient;
+    } catch (std::out_of_range &error) {
+      if (mode_ == ObjLoadMode::kStrict) throw;
+      errors_.push_back("line " + std::to_string(line_number) + ": " +
+                        error.what());
+    }
+    if (line_number % cancel_check_lines_ == 0 && cancel_token_.IsCancelled()) {
+      is_cancelled_ = true;
+      result = false;
+    }
+    if (bytes_read >= next_progress) {
+      reported_bytes = std::min(bytes_read, total_bytes);
+      emit Progress(reported_bytes, total_bytes);
+      next_progress = bytes_read + progress_step;
+    }
+  }
+  if (result && reported_bytes != total_bytes) {
+    emit Progress(total_bytes, total_bytes);
+  }
+  return result;
+}
+
+void ObjLoader::parse_line_(const std::string &line) {
+  if (is_vertex_(line)) {
+    add_vertex_(line);
+  } else if (is_face_(line)) {
+    add_face_(line);
+  }
+}
+
+/**
+ * @brief Отчет об ошибках одним сигналом. В мягком режиме перечисляются
+ * первые max_reported_errors_ ошибок и их общее количество.
+ */
+void ObjLoader::report_load_errors_() {
+  if (!errors_.empty() && !is_cancelled_) {
+    std::string message = errors_.front();
+    if (mode_ == ObjLoadMode::kLenient) {
+      message = "Skipped " + std::to_string(errors_.size()) +
+                " incorrect line(s):";
+      for (size_t i = 0; i < errors_.size() && i < max_reported_errors_; ++i) {
+        message += "\n" + errors_[i];
+      }
+    }
+    emit LoadError(message);
+  }
+}
+
+void ObjLoader::throw_format_error_(const std::string &message) const {
+  throw std::invalid_argument(message);
 }
 
 /**
@@ -62,7 +211,7 @@ void ObjLoader::Load() {
  */
 
 bool ObjLoader::is_vertex_(const std::string &line) const {
-  return (line[0] == 'v' && line[1] == ' ');
+  return (line.size() > 1 && line[0] == 'v' && line[1] == ' ');
 }
 
 /**
@@ -70,7 +219,7 @@ bool ObjLoader::is_vertex_(const std::string &line) const {
  * @return true - строка является вершиной, false - не является
  */
 bool ObjLoader::is_face_(const std::string &line) const {
-  return (line[0] == 'f' && line[1] == ' ');
+  return (line.size() > 1 && line[0] == 'f' && line[1] == ' ');
 }
 
 /**
@@ -89,9 +238,9 @@ void ObjLoader::add_vertex_(const std::string &line) {
   }
   exception_invalid_data_stream_(line, "add_vertex_()", str_stream);
   if (coords.size() != 3) {
-    emit LoadError(
+    throw_format_error_(
         "Model3D::add_vertex_(): count of coords must be 3! Current count: " +
-        coords.size());
+        std::to_string(coords.size()));
   }
 
   vertices_.push_back(Vector3D(coords[0], coords[1], coords[2]));
@@ -117,7 +266,7 @@ void ObjLoader::add_face_(const std::string &line) {
     std::istringstream another_stream(another_line);
     another_stream >> index;
     if (index == 0) {
-      emit LoadError("Model3D::add_face_(): index cannot be 0!");
+      throw_format_error_("Model3D::add_face_(): index cannot be 0!");
     }
     exception_invalid_data_stream_(line, "add_face_()", another_stream);
     index_correction_(index);
@@ -125,7 +274,8 @@ void ObjLoader::add_face_(const std::string &line) {
   }
   exception_invalid_data_stream_(line, "add_face_()", str_stream);
   if (indexes.size() < 3) {
-    emit LoadError("Model3D::add_face(): there must be 3 or more indexes!");
+    throw_format_error_(
+        "Model3D::add_face(): there must be 3 or more indexes!");
   }
   if (!is_there_same_face_indexes_(indexes)) {
     edges_count_(indexes);
@@ -151,8 +301,8 @@ void ObjLoader::exception_invalid_data_stream_(
     const std::string &line, const std::string &method_name,
     const std::istringstream &str_stream) {
   if (str_stream.fail() && !str_stream.eof()) {
-    emit LoadError("Model3D::" + method_name +
-                   ": incorrect data format in line: " + line);
+    throw_format_error_("Model3D::" + method_name +
+                        ": incorrect data format in line: " + line);
   }
 }
 
@@ -175,7 +325,7 @@ void ObjLoader::index_correction_(int &index) const {
   } else if (index < 0) {
     index = vertices_.size() + index;
   }
-  if (static_cast<size_t>(index) > vertices_.size()) {
+  if (index < 0 || static_cast<size_t>(index) >= vertices_.size()) {
     throw std::out_of_range(
         "ObjLoader::index_correction_(): index is out of range!");
   }
@@ -205,6 +355,7 @@ void Model3D::SetData(
     const std::vector<std::vector<unsigned int>> &faces,
     const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
         &edges) {
+  TraceScope trace("Model3D::SetData", "model");
   if (vertices.size() == 0) {
     throw std::invalid_argument(
         "Model3D::SetData(): data is empty, there is no vertices!");
@@ -213,13 +364,21 @@ void Model3D::SetData(
   faces_ = faces;
   edges_ = edges;
   CalculateBoundingBox();
+  std::lock_guard<std::mutex> build_lock(adjacency_build_mutex_);
+  std::lock_guard<std::mutex> lock(adjacency_mutex_);
+  adjacency_.reset();
 }
 
 void Model3D::CalculateBoundingBox() {
-  std::vector<Vector3D> vertices = vertices_;
-  Vector3D max_b = vertices[0], min_b = vertices[0];
+  // у пустой модели (например, в нестрогом режиме отброшены все вершины)
+  // рамка нулевая
+  Vector3D max_b, min_b;
+  if (!vertices_.empty()) {
+    max_b = vertices_[0];
+    min_b = vertices_[0];
+  }
 
-  for (const auto &vertex : vertices) {
+  for (const auto &vertex : vertices_) {
     max_b.x = std::max(max_b.x, vertex.x);
     max_b.y = std::max(max_b.y, vertex.y);
     max_b.z = std::max(max_b.z, vertex.z);
@@ -234,6 +393,7 @@ void Model3D::CalculateBoundingBox() {
 }
 
 std::vector<float> Model3D::GetVerticesToGlFormat() {
+  TraceScope trace("Model3D::GetVerticesToGlFormat", "model");
   std::vector<float> gl_vertices;
   gl_vertices.reserve(vertices_.size() * 3);
   for (const auto &vertex : vertices_) {
@@ -246,6 +406,7 @@ std::vector<float> Model3D::GetVerticesToGlFormat() {
 }
 
 std::vector<unsigned int> Model3D::GetEdgesToGlFormat() {
+  TraceScope trace("Model3D::GetEdgesToGlFormat", "model");
   std::vector<unsigned int> gl_edges;
   gl_edges.reserve(edges_.size() * 2);
   for (const auto &edge : edges_) {
@@ -255,9 +416,11 @@ std::vector<unsigned int> Model3D::GetEdgesToGlFormat() {
   return gl_edges;
 }
 
-const std::vector<Vector3D> &Model3D::GetVertices() { return vertices_; }
+const std::vector<Vector3D> &Model3D::GetVertices() const {
+  return vertices_;
+}
 
-const std::vector<std::vector<unsigned int>> &Model3D::GetFaces() {
+const std::vector<std::vector<unsigned int>> &Model3D::GetFaces() const {
   return faces_;
 }
 
@@ -272,4 +435,82 @@ size_t Model3D::GetEdgesCount() { return edges_.size(); }
 
 size_t Model3D::GetVerticesCount() { return vertices_.size(); }
 
+/**
+ * @brief Смежность вершин, ребер и граней (MeshAdjacency). Строится при первом
+ * вызове, параллельные вызовы ждут одного построения. Модель нельзя менять
+ * (SetData), пока ее читают другие потоки.
+ */
+std::shared_ptr<const MeshAdjacency> Model3D::GetAdjacency() const {
+  std::lock_guard<std::mutex> build_lock(adjacency_build_mutex_);
+  std::shared_ptr<const MeshAdjacency> result;
+  {
+    std::lock_guard<std::mutex> lock(adjacency_mutex_);
+    result = adjacency_;
+  }
+  if (!result) {
+    result = std::make_shared<const MeshAdjacency>(
+        MeshAdjacency::Build(vertices_.size(), faces_));
+    std::lock_guard<std::mutex> lock(adjacency_mutex_);
+    adjacency_ = result;
+  }
+  return result;
+}
+
+/**
+ * @brief Построена ли смежность (не ждет идущего построения)
+ */
+bool Model3D::HasAdjacency() const {
+  std::lock_guard<std::mutex> lock(adjacency_mutex_);
+  return adjacency_ != nullptr;
+}
+
+/**
+ * @brief Запись в stats памяти, которую занимают данные модели
+ */
+void Model3D::AccountMemory(MemoryStats &stats) const {
+  AccountMeshMemory(vertices_, faces_, edges_, stats);
+  std::lock_guard<std::mutex> lock(adjacency_mutex_);
+  stats.Set(MemoryCategory::kMeshAdjacency,
+            adjacency_ ? adjacency_->GetBytes() : 0);
+}
+
+/**
+ * @brief Память вершин, граней и ребер по категориям (см. MemoryStats)
+ */
+void Model3D::AccountMeshMemory(
+    const std::vector<Vector3D> &vertices,
+    const std::vector<std::vector<unsigned int>> &faces,
+    const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
+        &edges,
+    MemoryStats &stats) {
+  stats.Set(MemoryCategory::kVertices,
+            MemoryStats::HeapBlockBytes(vertices.capacity() *
+                                        sizeof(Vector3D)));
+  size_t faces_bytes = MemoryStats::HeapBlockBytes(
+      faces.capacity() * sizeof(std::vector<unsigned int>));
+  for (const auto &face : faces) {
+    faces_bytes +=
+        MemoryStats::HeapBlockBytes(face.capacity() * sizeof(unsigned int));
+  }
+  stats.Set(MemoryCategory::kFaces, faces_bytes);
+  using Edge = std::pair<unsigned int, unsigned int>;
+  stats.Set(MemoryCategory::kEdges, edges.size() * sizeof(Edge));
+  stats.Set(MemoryCategory::kEdgesHashOverhead,
+            MemoryStats::HashSetOverheadBytes(
+                edges.size(), edges.bucket_count(), sizeof(Edge)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// реализация MeshData
+
+void MeshData::AccountMemory(MemoryStats &stats) const {
+  Model3D::AccountMeshMemory(vertices, faces, edges, stats);
+}
+
+size_t MeshData::GetBytes() const {
+  MemoryStats stats;
+  AccountMemory(stats);
+  return stats.GetCpuBytes();
+}
+
 }  // namespace s21
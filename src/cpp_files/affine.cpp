@@ -349,6 +349,62 @@ S21Matrix AffineTransDecorator::CreateMVPMatrix(const S21Matrix &projection,
   return result;
 }
 
+/**
+ * @brief Создает матрицу проецирования для одной плитки (под-пирамиды видимости)
+ * при рендеринге изображения по частям. Изображение делится на columns x rows
+ * плиток, плитка (0, 0) - левая верхняя. Матрица растягивает нужный участок
+ * NDC на весь [-1, 1], поэтому подходит и для центральной, и для параллельной
+ * проекции.
+ * @return tile * projection, размер 4х4
+ */
+S21Matrix AffineTransDecorator::CreateProjMatrixTile(const S21Matrix &projection,
+                                                     int column, int row,
+                                                     int columns, int rows) {
+  exception_check_same_size_("CreateProjMatrixTile", projection);
+  if (columns <= 0 || rows <= 0 || column < 0 || column >= columns ||
+      row < 0 || row >= rows) {
+    throw std::invalid_argument(
+        "CreateProjMatrixTile: invalid tile parameters!");
+  }
+
+  double left = -1.0 + 2.0 * column / columns;
+  double right = left + 2.0 / columns;
+  double top = 1.0 - 2.0 * row / rows;
+  double bottom = top - 2.0 / rows;
+
+  S21Matrix tile(4, 4);
+  tile.SetIdentity();
+  tile(0, 0) = 2.0 / (right - left);
+  tile(1, 1) = 2.0 / (top - bottom);
+  tile(0, 3) = -(right + left) / (right - left);
+  tile(1, 3) = -(top + bottom) / (top - bottom);
+
+  return tile * projection;
+}
+
+/**
+ * @brief Переводит матрицу проецирования, построенную для соотношения сторон
+ * aspect, на кадр с соотношением target_aspect. Высота видимой области
+ * сохраняется, меняется ширина: для симметричной центральной и параллельной
+ * проекций это то же самое, что построить их заново с новым aspect. Меняется
+ * только первая строка, поэтому можно передать и готовую MVP.
+ * @return матрица размера 4х4
+ */
+S21Matrix AffineTransDecorator::CreateProjMatrixAspect(
+    const S21Matrix &projection, double aspect, double target_aspect) {
+  exception_check_same_size_("CreateProjMatrixAspect", projection);
+  if (aspect <= 0.0 || target_aspect <= 0.0) {
+    throw std::invalid_argument("CreateProjMatrixAspect: invalid aspect!");
+  }
+
+  S21Matrix result = projection;
+  double scale = aspect / target_aspect;
+  for (int j = 0; j < 4; ++j) {
+    result(0, j) *= scale;
+  }
+  return result;
+}
+
 // создание матрицы поворота по формуле Родригеса
 void AffineTransDecorator::create_rotation_mat_(S21Matrix &rot_matrix, double t,
                                                 double cosine, double sine,
@@ -0,0 +1,408 @@
+#include "../include/batch_cli.h"
+
+namespace s21 {
+
+BatchProcessor::BatchProcessor(BatchOptions options)
+    : options_(std::move(options)) {}
+
+/**
+ * @brief Обработка всех файлов в пуле из options.threads потоков. Каждая
+ * задача пишет только в свой элемент результата, поэтому синхронизация не
+ * нужна.
+ */
+std::vector<BatchResult> BatchProcessor::Run() {
+  std::vector<BatchResult> results(options_.files.size());
+  JobSystem jobs(options_.threads);
+  for (size_t i = 0; i < options_.files.size(); ++i) {
+    jobs.Submit([this, &results, i](const CancellationToken &token) {
+      results[i] = ProcessFile(options_.files[i], options_, token);
+    });
+  }
+  jobs.WaitIdle();
+  return results;
+}
+
+/**
+ * @brief Обработка одного файла: загрузка, подсчет статистики и (если задано)
+ * запись двоичного кэша и миниатюры. Если включен skip_valid_cache, а кэш и
+ * миниатюра актуальны, файл не разбирается. Ошибки не выбрасываются, а
+ * записываются в результат.
+ */
+BatchResult BatchProcessor::ProcessFile(const QString &file,
+                                        const BatchOptions &options,
+                                        const CancellationToken &token) {
+  TraceScope trace("BatchProcessor::ProcessFile", "batch");
+  QElapsedTimer timer;
+  timer.start();
+  BatchResult result;
+  result.file = file;
+  result.bytes = QFileInfo(file).size();
+  if (!options.cache_dir.isEmpty()) {
+    result.cache_path = MeshCache::CachePathFor(options.cache_dir, file);
+  }
+  if (!options.thumbnail_dir.isEmpty()) {
+    result.thumbnail_path = QString("%1/%2.png").arg(
+        options.thumbnail_dir, MeshCache::CacheNameFor(file));
+  }
+
+  if (options.skip_valid_cache && !result.cache_path.isEmpty() &&
+      MeshCache::IsValid(result.cache_path, file) &&
+      (result.thumbnail_path.isEmpty() ||
+       QFileInfo(result.thumbnail_path).exists())) {
+    result.loaded = true;
+    result.skipped = true;
+  } else {
+    load_file_(options, token, result);
+  }
+  result.elapsed_ms = timer.elapsed();
+  return result;
+}
+
+void BatchProcessor::load_file_(const BatchOptions &options,
+                                const CancellationToken &token,
+                                BatchResult &result) {
+  ObjLoader loader(result.file.toStdString());
+  loader.SetMode(options.mode);
+  loader.SetCancellationToken(token);
+  QObject::connect(&loader, &ObjLoader::LoadError,
+                   [&result](const std::string &error_message) {
+                     result.errors.push_back(error_message);
+                   });
+  try {
+    loader.Load();
+  } catch (std::exception &error) {
+    result.errors.push_back(error.what());
+  }
+
+  if (!loader.IsLoaded()) {
+    result.cache_path.clear();
+    result.thumbnail_path.clear();
+  } else {
+    result.loaded = true;
+    Model3D model;
+    model.SetData(loader.GetVertices(), loader.GetFaces(), loader.GetEdges());
+    result.vertices = model.GetVerticesCount();
+    result.edges = model.GetEdgesCount();
+    result.faces = model.GetFaces().size();
+    result.box = model.GetBoundingBox();
+    if (options.validate) {
+      result.validation = MeshValidation::Run(model, token);
+      result.validated = true;
+    }
+    model.AccountMemory(result.memory);
+    result.memory.SetPeakRss(MemoryStats::PeakRssBytes());
+    try {
+      // кэш нужен просмотрщику, поэтому он пишется только для файлов, которые
+      // и строгий режим прочитал бы точно так же
+      if (!result.cache_path.isEmpty() && result.errors.empty()) {
+        MeshCache::Write(result.cache_path, result.file, model.GetVertices(),
+                         model.GetFaces(), model.GetEdges());
+      } else {
+        result.cache_path.clear();
+      }
+      if (!result.thumbnail_path.isEmpty()) {
+        ThumbnailRenderer renderer(options.thumbnail_size,
+                                   options.thumbnail_size);
+        if (!renderer.Render(model).save(result.thumbnail_path, "PNG")) {
+          throw std::runtime_error("unable to save thumbnail " +
+                                   result.thumbnail_path.toStdString());
+        }
+      }
+    } catch (std::exception &error) {
+      result.errors.push_back(error.what());
+    }
+  }
+}
+
+/**
+ * @brief Файл возвращается как есть, каталог обходится рекурсивно в поисках
+ * .obj файлов (в отсортированном порядке, чтобы отчеты можно было сравнивать)
+ */
+std::vector<QString> BatchProcessor::CollectObjFiles(const QString &path) {
+  std::vector<QString> files;
+  if (QFileInfo(path).isDir()) {
+    QDirIterator it(path, QStringList{"*.obj", "*.OBJ"}, QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+      files.push_back(it.next());
+    }
+    std::sort(files.begin(), files.end());
+  } else {
+    files.push_back(path);
+  }
+  return files;
+}
+
+QJsonObject BatchProcessor::ResultToJson(const BatchResult &result) {
+  QJsonObject json;
+  json["file"] = result.file;
+  json["status"] = result.loaded ? "ok" : "error";
+  QJsonArray errors;
+  for (const auto &error : result.errors) {
+    errors.append(QString::fromStdString(error));
+  }
+  json["errors"] = errors;
+  json["bytes"] = result.bytes;
+  json["elapsed_ms"] = result.elapsed_ms;
+  if (result.skipped) {
+    json["status"] = "skipped";
+  } else if (result.elapsed_ms > 0) {
+    json["mb_per_s"] = result.bytes / 1048576.0 / (result.elapsed_ms / 1000.0);
+  }
+  if (result.loaded && !result.skipped) {
+    json["vertices"] = static_cast<qint64>(result.vertices);
+    json["edges"] = static_cast<qint64>(result.edges);
+    json["faces"] = static_cast<qint64>(result.faces);
+    QJsonObject box;
+    box["min"] =
+        QJsonArray{result.box.min.x, result.box.min.y, result.box.min.z};
+    box["max"] =
+        QJsonArray{result.box.max.x, result.box.max.y, result.box.max.z};
+    json["bounding_box"] = box;
+    // пиковый RSS общий для процесса: файлы разбираются параллельно, поэтому
+    // его разность до и после файла ничего не говорит о самом файле, и в
+    // отчете это явно видно по имени поля
+    QJsonObject memory = result.memory.ToJson();
+    memory.remove("peak_rss");
+    memory["process_peak_rss"] =
+        static_cast<qint64>(result.memory.GetPeakRss());
+    json["memory"] = memory;
+    if (result.validated) json["validation"] = result.validation.ToJson();
+    if (!result.cache_path.isEmpty()) json["cache"] = result.cache_path;
+    if (!result.thumbnail_path.isEmpty()) {
+      json["thumbnail"] = result.thumbnail_path;
+    }
+  }
+  return json;
+}
+
+QJsonObject BatchProcessor::ReportToJson(
+    const std::vector<BatchResult> &results, const BatchOptions &options,
+    qint64 elapsed_ms) {
+  QJsonArray models;
+  int failed = 0, skipped = 0, invalid = 0;
+  qint64 parsed_bytes = 0;
+  for (const auto &result : results) {
+    models.append(ResultToJson(result));
+    if (!result.loaded) ++failed;
+    if (result.validated && !result.validation.IsValid()) ++invalid;
+    if (result.skipped) {
+      ++skipped;
+    } else {
+      parsed_bytes += result.bytes;
+    }
+  }
+  QJsonObject json;
+  json["models"] = models;
+  json["failed"] = failed;
+  json["skipped"] = skipped;
+  if (options.validate) json["invalid"] = invalid;
+  json["threads"] = static_cast<qint64>(options.threads);
+  json["elapsed_ms"] = elapsed_ms;
+  // общая пропускная способность считается по реальному времени работы пула,
+  // поэтому учитывает и параллельность, и пропущенные файлы
+  json["parsed_bytes"] = parsed_bytes;
+  if (elapsed_ms > 0) {
+    double seconds = elapsed_ms / 1000.0;
+    json["mb_per_s"] = parsed_bytes / 1048576.0 / seconds;
+    json["files_per_s"] = static_cast<double>(results.size()) / seconds;
+  }
+  json["peak_rss"] = static_cast<qint64>(MemoryStats::PeakRssBytes());
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// реализация BatchCli
+
+/**
+ * @brief Проверка до создания QApplication: в консольном режиме окно (и
+ * подключение к дисплею) не создается вовсе
+ */
+bool BatchCli::IsBatchMode(int argc, char *argv[]) {
+  bool result = false;
+  for (int i = 1; i < argc && !result; ++i) {
+    result = std::strcmp(argv[i], "--batch") == 0;
+  }
+  return result;
+}
+
+/**
+ * @brief Разбор параметров командной строки (первый элемент - имя программы).
+ * Каталоги заменяются списком .obj файлов в них.
+ * @param options значения по умолчанию
+ * @throw std::invalid_argument - неизвестный параметр, неверное значение или
+ * не задано ни одного файла
+ */
+BatchOptions BatchCli::ParseArguments(const QStringList &arguments,
+                                      BatchOptions options) {
+  auto next_value = [&arguments](qsizetype &i) {
+    if (i + 1 >= arguments.size()) {
+      throw std::invalid_argument("BatchCli: missing value for " +
+                                  arguments[i].toStdString());
+    }
+    return arguments[++i];
+  };
+  auto to_int = [](const QString &value, int min, int max) {
+    bool ok = false;
+    int number = value.toInt(&ok);
+    if (!ok || number < min || number > max) {
+      throw std::invalid_argument("BatchCli: incorrect number " +
+                                  value.toStdString());
+    }
+    return number;
+  };
+
+  for (qsizetype i = 1; i < arguments.size(); ++i) {
+    const QString &argument = arguments[i];
+    if (argument == "--batch" || argument.startsWith("--trace=")) {
+      // режим и трассировка уже выбраны в main()
+    } else if (argument == "--cache") {
+      options.cache_dir = next_value(i);
+    } else if (argument == "--thumbnails") {
+      options.thumbnail_dir = next_value(i);
+    } else if (argument == "--thumbnail-size") {
+      options.thumbnail_size = to_int(next_value(i), 16, 4096);
+    } else if (argument == "--threads") {
+      options.threads = static_cast<size_t>(to_int(next_value(i), 1, 256));
+    } else if (argument == "--no-thumbnails") {
+      options.thumbnail_dir.clear();
+    } else if (argument == "--lenient") {
+      options.mode = ObjLoadMode::kLenient;
+    } else if (argument == "--skip-valid") {
+      options.skip_valid_cache = true;
+    } else if (argument == "--force") {
+      options.skip_valid_cache = false;
+    } else if (argument == "--validate") {
+      options.validate = true;
+    } else if (argument.startsWith("--")) {
+      throw std::invalid_argument("BatchCli: unknown option " +
+                                  argument.toStdString());
+    } else {
+      for (QString &file : BatchProcessor::CollectObjFiles(argument)) {
+        options.files.push_back(std::move(file));
+      }
+    }
+  }
+  if (options.files.empty()) {
+    throw std::invalid_argument("BatchCli: no .obj files found");
+  }
+  return options;
+}
+
+/**
+ * @brief Запуск консольного режима 3d_viewer --batch
+ * @return 0 - все файлы загружены, 1 - часть файлов загрузить не удалось,
+ * 2 - неверные параметры
+ */
+int BatchCli::Run(const QStringList &arguments) {
+  return run_(arguments, BatchOptions(), Usage());
+}
+
+/**
+ * @brief Запуск obj_converter: по умолчанию кэши и миниатюры пишутся в общий
+ * каталог кэша просмотрщика, файлы с актуальным кэшем пропускаются
+ */
+int BatchCli::RunConverter(const QStringList &arguments) {
+  BatchOptions defaults;
+  defaults.cache_dir = MeshCache::DefaultCacheDir();
+  defaults.thumbnail_dir = MeshCache::DefaultCacheDir() + "/thumbnails";
+  defaults.skip_valid_cache = true;
+  return run_(arguments, defaults, ConverterUsage());
+}
+
+int BatchCli::run_(const QStringList &arguments, const BatchOptions &defaults,
+                   const QString &usage) {
+  int exit_code = 0;
+  if (arguments.contains("--help") || arguments.contains("-h")) {
+    std::cout << usage.toStdString();
+  } else {
+    try {
+      BatchOptions options = ParseArguments(arguments, defaults);
+      for (const QString &dir : {options.cache_dir, options.thumbnail_dir}) {
+        if (!dir.isEmpty() && !QDir().mkpath(dir)) {
+          throw std::invalid_argument("BatchCli: unable to create " +
+                                      dir.toStdString());
+        }
+      }
+      size_t predicted = 0, available = 0;
+      if (IsLoadTooLarge(options, predicted, available)) {
+        std::cerr << "warning: loading " << options.threads
+                  << " files at once is expected to need about "
+                  << MemoryStats::FormatBytes(predicted).toStdString()
+                  << ", available memory: "
+                  << MemoryStats::FormatBytes(available).toStdString()
+                  << "; consider --threads 1\n";
+      }
+      QElapsedTimer timer;
+      timer.start();
+      std::vector<BatchResult> results = BatchProcessor(options).Run();
+      QJsonObject report =
+          BatchProcessor::ReportToJson(results, options, timer.elapsed());
+      std::cout << QJsonDocument(report).toJson().toStdString();
+      exit_code = report["failed"].toInt() == 0 ? 0 : 1;
+    } catch (std::invalid_argument &error) {
+      std::cerr << error.what() << "\n\n" << usage.toStdString();
+      exit_code = 2;
+    }
+  }
+  return exit_code;
+}
+
+/**
+ * @brief Оценка памяти для пакетной обработки: одновременно загружаются
+ * options.threads файлов, в худшем случае - самые большие
+ * @return true - по оценке памяти не хватит
+ */
+bool BatchCli::IsLoadTooLarge(const BatchOptions &options, size_t &predicted,
+                              size_t &available) {
+  std::vector<qint64> sizes;
+  sizes.reserve(options.files.size());
+  for (const QString &file : options.files) {
+    sizes.push_back(QFileInfo(file).size());
+  }
+  size_t concurrent = std::min(options.threads, sizes.size());
+  std::partial_sort(sizes.begin(), sizes.begin() + concurrent, sizes.end(),
+                    std::greater<qint64>());
+  qint64 concurrent_bytes = 0;
+  for (size_t i = 0; i < concurrent; ++i) {
+    concurrent_bytes += sizes[i];
+  }
+  return MemoryStats::IsLoadTooLarge(concurrent_bytes, predicted, available);
+}
+
+QString BatchCli::Usage() {
+  return "Usage: 3d_viewer --batch [options] file.obj|dir...\n"
+         "  --threads N          number of worker threads\n"
+         "  --lenient            skip incorrect lines instead of failing\n"
+         "  --cache DIR          write binary mesh caches to DIR\n"
+         "  --thumbnails DIR     render PNG thumbnails to DIR\n"
+         "  --thumbnail-size N   thumbnail size in pixels (default 256)\n"
+         "  --skip-valid         do not parse files with an up-to-date cache\n"
+         "  --validate           check meshes for degenerate and duplicate\n"
+         "                       faces, unused vertices, non-manifold edges\n"
+         "                       and out-of-range coordinates\n"
+         "  --trace=FILE         write a Chrome trace of the run to FILE\n"
+         "Memory in the report is per model, except process_peak_rss and\n"
+         "peak_rss: the peak RSS of the whole process, which parses files\n"
+         "in parallel.\n";
+}
+
+QString BatchCli::ConverterUsage() {
+  return "Usage: obj_converter [options] file.obj|dir...\n"
+         "Parses .obj files (directories recursively) and writes the binary\n"
+         "mesh caches and thumbnails used by 3d_viewer.\n"
+         "  --threads N          number of worker threads\n"
+         "  --lenient            skip incorrect lines instead of failing\n"
+         "  --cache DIR          cache directory (default: viewer cache)\n"
+         "  --thumbnails DIR     thumbnail directory\n"
+         "  --no-thumbnails      do not render thumbnails\n"
+         "  --thumbnail-size N   thumbnail size in pixels (default 256)\n"
+         "  --force              convert files with an up-to-date cache too\n"
+         "  --validate           check meshes and report issues\n"
+         "  --trace=FILE         write a Chrome trace of the run to FILE\n"
+         "Memory in the report is per model, except process_peak_rss and\n"
+         "peak_rss: the peak RSS of the whole process, which parses files\n"
+         "in parallel.\n";
+}
+
+}  // namespace s21
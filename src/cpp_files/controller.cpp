@@ -4,10 +4,14 @@ namespace s21 {
 
 Controller::Controller(std::unique_ptr<Scene> model,
                        std::unique_ptr<MainWindow> view)
-    : model_(std::move(model)), view_(std::move(view)) {
+    : model_(std::move(model)),
+      view_(std::move(view)),
+      session_store_(std::make_shared<SessionStore>(
+          QString::fromStdString(state_path_))),
+      autosave_timer_(new QTimer(this)) {
   // подключение сигнала-слота для загрузки модели при нажатии кнопки
-  connect(view_.get(), &MainWindow::ProcessObjLoad, model_.get(),
-          &Scene::ProcessObjLoad);
+  connect(view_.get(), &MainWindow::ProcessObjLoad, this,
+          &Controller::handle_obj_load_);
 
   // подключение обработки для успешной загрузки модели в фоновом потоке
   connect(model_.get(), &Scene::Loaded, this,
@@ -19,6 +23,28 @@ Controller::Controller(std::unique_ptr<Scene> model,
   connect(model_.get(), &Scene::ErrorLoad, this,
           &Controller::handle_load_error_);
 
+  // прогресс, отмена и режим обработки ошибок загрузки
+  connect(model_.get(), &Scene::LoadProgress, this,
+          &Controller::handle_load_progress_);
+  connect(model_.get(), &Scene::LoadFinished, this,
+          &Controller::handle_load_finished_);
+  connect(model_.get(), &Scene::LodReady, this,
+          &Controller::handle_lod_ready_);
+  connect(model_.get(), &Scene::FeatureEdgesReady, this,
+          &Controller::handle_feature_edges_ready_);
+  connect(model_.get(), &Scene::ValidationReady, this,
+          &Controller::handle_validation_ready_);
+  connect(view_.get(), &MainWindow::CancelLoadClicked, model_.get(),
+          &Scene::CancelLoad);
+  connect(view_.get(), &MainWindow::LenientLoadingChanged, model_.get(),
+          &Scene::SetLenientLoading);
+  connect(view_.get(), &MainWindow::PrefetchChanged, model_.get(),
+          &Scene::SetPrefetchEnabled);
+  connect(view_.get(), &MainWindow::FeatureEdgesChanged, model_.get(),
+          &Scene::SetFeatureEdgesEnabled);
+  connect(view_.get(), &MainWindow::StepModelClicked, this,
+          &Controller::handle_step_model_);
+
   // обработка сигналов от нажатия кнопок Apply, fps
   connect_transl_sig_slots_();
   connect_rotation_sig_slots_();
@@ -36,6 +62,29 @@ Controller::Controller(std::unique_ptr<Scene> model,
 
   connect(view_.get(), &MainWindow::CreateGifFromJpegs, model_.get(),
           &Scene::CreatingGifFromJpegs);
+  connect(view_.get(), &MainWindow::StartGifEncoding, model_.get(),
+          &Scene::StartGifEncoding);
+  connect(view_.get(), &MainWindow::TiledScreenshotRequested, this,
+          &Controller::handle_tiled_screenshot_);
+
+  // автосохранение сессии и экспорт/импорт в json
+  autosave_timer_->setSingleShot(true);
+  autosave_timer_->setInterval(autosave_delay_ms_);
+  connect(autosave_timer_, &QTimer::timeout, this, &Controller::autosave_);
+  connect(model_.get(), &Scene::Loaded, this,
+          &Controller::schedule_autosave_);
+  connect(model_.get(), &Scene::LoadedMemento, this,
+          &Controller::schedule_autosave_);
+  connect(model_.get(), &Scene::UpdateMVP, this,
+          &Controller::schedule_autosave_);
+  connect(model_.get(), &Scene::UpdateTempMVP, this,
+          &Controller::schedule_autosave_);
+  connect(view_.get(), &MainWindow::ViewStateChanged, this,
+          &Controller::schedule_autosave_);
+  connect(view_.get(), &MainWindow::ExportStateRequested, this,
+          &Controller::export_state_);
+  connect(view_.get(), &MainWindow::ImportStateRequested, this,
+          &Controller::import_state_);
 }
 
 void Controller::Show() { view_->show(); }
@@ -47,73 +96,215 @@ void Controller::Start() {
 
 Controller::~Controller() = default;
 
+/**
+ * @brief Восстановление прошлой сессии. Основной источник - двоичный снимок,
+ * json прошлых версий читается, только если снимка еще нет.
+ */
 void Controller::LoadState() {
-  QString q_dir = QString::fromStdString(json_dir_);
-  QDir dir(q_dir);
-  if (dir.exists()) {
-    QString json_path = QString::fromStdString(json_path_);
-    QFile file(json_path);
-    if (file.open(QIODevice::ReadOnly)) {
-      QByteArray data = file.readAll();
-      file.close();
-      QJsonDocument json_doc = QJsonDocument::fromJson(data);
-      QJsonObject json_object = json_doc.object();
+  bool restored = false;
+  if (session_store_->Exists()) {
+    try {
+      SessionSnapshot snapshot =
+          SessionStore::Deserialize(session_store_->Read());
+      apply_state_(snapshot.scene, snapshot.gl_widget);
+      restored = true;
+    } catch (const std::exception &e) {
+      qDebug() << "Controller::LoadState():" << e.what();
+    }
+  }
+  if (!restored) {
+    load_json_state_(QString::fromStdString(json_path_));
+  }
+}
+
+bool Controller::load_json_state_(const QString &file_path) {
+  bool result = false;
+  QFile file(file_path);
+  if (file.open(QIODevice::ReadOnly)) {
+    QByteArray data = file.readAll();
+    file.close();
+    QJsonDocument json_doc = QJsonDocument::fromJson(data);
+    QJsonObject json_object = json_doc.object();
 
+    if (json_object.contains("scene") && json_object.contains("gl_widget")) {
       QJsonObject gl_json = json_object["gl_widget"].toObject();
       QJsonObject scene_json = json_object["scene"].toObject();
       SceneMemento sc_memento = SceneMemento::ReadFromJson(scene_json);
       GLWidgetMemento gl_memento = GLWidgetMemento::ReadFromJson(gl_json);
-
-      model_->SetMemento(sc_memento);
-      view_->SetMemento(gl_memento);
-      model_->LoadModelMemento();
+      apply_state_(sc_memento, gl_memento);
+      result = true;
     }
   }
+  return result;
+}
+
+void Controller::apply_state_(SceneMemento &sc_memento,
+                              GLWidgetMemento &gl_memento) {
+  model_->SetMemento(sc_memento);
+  view_->SetMemento(gl_memento);
+  // модель читается в фоне, окно уже показано и отвечает
+  model_->LoadModelMemento();
 }
 
 void Controller::handle_model_loaded_(const Model3DDataGl &gl_data) {
+  TraceScope trace("Controller::handle_model_loaded_", "controller");
   view_->SetModelData(gl_data);
   model_->InitialMVPMatrix();
   S21MatrixWrapper mvp = S21MatrixWrapper(model_->CreateMVPMatrix());
   view_->SetMVPMatrix(mvp);
   view_->SetModelInfo(model_->GetFileName(), model_->GetEdgesCount(),
                       model_->GetVerticesCount());
+  view_->SetValidation(nullptr);
+  update_memory_info_();
 }
 
 void Controller::handle_model_loaded_memento_(const Model3DDataGl &gl_data) {
+  TraceScope trace("Controller::handle_model_loaded_memento_", "controller");
   view_->SetModelData(gl_data);
   S21MatrixWrapper mvp = S21MatrixWrapper(model_->CreateMVPMatrix());
   view_->SetMVPMatrix(mvp);
   view_->SetModelInfo(model_->GetFileName(), model_->GetEdgesCount(),
                       model_->GetVerticesCount());
+  view_->SetValidation(nullptr);
+  update_memory_info_();
   view_->update();
 }
 
+/**
+ * @brief Перед загрузкой проверяется, хватит ли памяти: если по оценке
+ * (MemoryStats::PredictLoadBytes) не хватит, пользователь решает, загружать
+ * ли модель
+ */
+void Controller::handle_obj_load_(std::string &file_path) {
+  size_t predicted = 0, available = 0;
+  qint64 file_size = QFileInfo(QString::fromStdString(file_path)).size();
+  if (!MemoryStats::IsLoadTooLarge(file_size, predicted, available) ||
+      view_->ConfirmLargeLoad(predicted, available)) {
+    model_->ProcessObjLoad(file_path);
+  } else {
+    view_->HideLoadProgress();
+  }
+}
+
+/**
+ * @brief Переход к соседнему по имени .obj файлу в каталоге текущей модели
+ * (с упреждающей загрузкой он обычно уже в кэше)
+ */
+void Controller::handle_step_model_(int offset) {
+  std::string file_path = model_->GetNeighbourFile(offset);
+  if (!file_path.empty()) {
+    view_->SetLoadProgress(0, 1);
+    handle_obj_load_(file_path);
+  }
+}
+
+/**
+ * @brief Память модели по категориям: данные сцены, буферы OpenGL и пиковый
+ * RSS процесса
+ */
+void Controller::update_memory_info_() {
+  MemoryStats stats;
+  model_->AccountMemory(stats);
+  view_->AccountMemory(stats);
+  stats.SetPeakRss(MemoryStats::PeakRssBytes());
+  view_->SetMemoryInfo(stats);
+}
+
+/**
+ * @brief Синхронное сохранение при выходе. Снимок получает самое новое
+ * поколение, поэтому отстающее фоновое автосохранение его не перезапишет.
+ */
 void Controller::save_state_() {
+  autosave_timer_->stop();
   if (model_->IsModelDisplayed()) {
+    check_json_dir_();
+    session_store_->Write(create_snapshot_(),
+                          session_store_->NextGeneration());
+  }
+}
+
+void Controller::schedule_autosave_() { autosave_timer_->start(); }
+
+/**
+ * @brief Снимок сериализуется в потоке gui (это несколько сотен байт), а запись
+ * на диск уходит в пул задач с низким приоритетом
+ */
+void Controller::autosave_() {
+  if (model_->IsModelDisplayed()) {
+    check_json_dir_();
+    QByteArray data = create_snapshot_();
+    quint64 generation = session_store_->NextGeneration();
+    std::shared_ptr<SessionStore> store = session_store_;
+    model_->GetJobSystem().Submit(
+        [store, data, generation](const CancellationToken &) {
+          store->Write(data, generation);
+        },
+        JobPriority::kLow);
+  }
+}
+
+QByteArray Controller::create_snapshot_() {
+  SceneMemento sc_memento = model_->CreateMemento();
+  GLWidgetMemento gl_memento = view_->CreateMemento();
+  return SessionStore::Serialize(sc_memento, gl_memento);
+}
+
+void Controller::export_state_(QString file_path) {
+  if (!model_->IsModelDisplayed()) {
+    handle_load_error_("Load a model before exporting the state!");
+  } else {
     SceneMemento sc_memento = model_->CreateMemento();
     GLWidgetMemento gl_memento = view_->CreateMemento();
 
     QJsonObject json;
     json["scene"] = sc_memento.WriteToJson();
     json["gl_widget"] = gl_memento.WriteToJson();
-    check_json_dir_();
     QJsonDocument json_doc(json);
 
-    QString json_path = QString::fromStdString(json_path_);
-    QFile file(json_path);
-    if (file.open(QIODevice::WriteOnly)) {
-      file.write(json_doc.toJson(QJsonDocument::Indented));
-      file.close();
+    QSaveFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(json_doc.toJson(QJsonDocument::Indented)) < 0 ||
+        !file.commit()) {
+      handle_load_error_("Unable to write the state file!");
     }
   }
 }
 
+void Controller::import_state_(QString file_path) {
+  if (!load_json_state_(file_path)) {
+    handle_load_error_("The file does not contain a viewer state!");
+  }
+}
+
 void Controller::handle_load_error_(const std::string &error_message) {
   QMessageBox::critical(nullptr, "Error",
                         QString::fromStdString(error_message));
 }
 
+void Controller::handle_load_progress_(qint64 bytes_read,
+                                       qint64 total_bytes) {
+  view_->SetLoadProgress(bytes_read, total_bytes);
+}
+
+void Controller::handle_load_finished_() { view_->HideLoadProgress(); }
+
+void Controller::handle_lod_ready_(std::shared_ptr<const MeshLod> lod) {
+  view_->SetLodLevels(lod);
+  update_memory_info_();
+}
+
+void Controller::handle_feature_edges_ready_(
+    std::shared_ptr<const FeatureEdges> features) {
+  view_->SetFeatureEdges(features);
+  update_memory_info_();
+}
+
+void Controller::handle_validation_ready_(
+    std::shared_ptr<const MeshValidation> validation) {
+  view_->SetValidation(validation);
+  update_memory_info_();
+}
+
 void Controller::handle_update_mvp_() {
   S21MatrixWrapper mvp = S21MatrixWrapper(model_->CreateMVPMatrix());
   view_->SetMVPMatrix(mvp);
@@ -123,6 +314,26 @@ void Controller::handle_update_temp_mvp_(S21MatrixWrapper &mvp) {
   view_->SetMVPMatrix(mvp);
 }
 
+/**
+ * @brief Расчет матриц MVP для всех плиток скриншота и запуск рендеринга
+ */
+void Controller::handle_tiled_screenshot_(QString file_path, int tiles,
+                                          double aspect) {
+  if (!model_->IsModelDisplayed()) {
+    handle_load_error_("Load a model before taking a tiled screenshot!");
+  } else {
+    std::vector<S21MatrixWrapper> tile_mvps;
+    tile_mvps.reserve(static_cast<size_t>(tiles) * tiles);
+    for (int row = 0; row < tiles; ++row) {
+      for (int column = 0; column < tiles; ++column) {
+        tile_mvps.emplace_back(
+            model_->CreateTileMVPMatrix(column, row, tiles, tiles, aspect));
+      }
+    }
+    view_->StartTiledScreenshot(file_path, tiles, tile_mvps);
+  }
+}
+
 void Controller::connect_transl_sig_slots_() {
   connect(view_.get(), &MainWindow::ApplyTranslationClicked, model_.get(),
           &Scene::CheckTranslationData_fps);
@@ -0,0 +1,154 @@
+#include "../include/edge_clusters.h"
+
+#include "../include/mesh_lod.h"
+
+namespace s21 {
+
+/**
+ * @brief Сортировка ребер (пар индексов в формате OpenGL) по участкам.
+ * Ребра в edges переставляются на месте, их количество не меняется.
+ */
+EdgeClusters EdgeClusters::Build(const std::vector<float> &vertices,
+                                 std::vector<unsigned int> &edges) {
+  TraceScope trace("EdgeClusters::Build", "scene");
+  EdgeClusters result;
+  const long long edges_count = static_cast<long long>(edges.size() / 2);
+  result.edges_count_ = static_cast<size_t>(edges_count);
+  const BoundingBox box = MeshLod::BoxOf(vertices);
+  const double min[3] = {box.min.x, box.min.y, box.min.z};
+  const double extent[3] = {box.max.x - box.min.x, box.max.y - box.min.y,
+                            box.max.z - box.min.z};
+  const double cells = static_cast<double>((1 << kMortonBits) - 1);
+
+  // код Мортона середины ребра в старших 32 битах, номер ребра в младших
+  std::vector<std::uint64_t> keys(static_cast<size_t>(edges_count));
+#pragma omp parallel for
+  for (long long i = 0; i < edges_count; ++i) {
+    std::uint32_t code = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+      double middle = (vertices[edges[i * 2] * 3 + axis] +
+                       vertices[edges[i * 2 + 1] * 3 + axis]) *
+                      0.5;
+      double position =
+          extent[axis] > 0 ? (middle - min[axis]) / extent[axis] * cells : 0;
+      code |= spread_bits_(static_cast<std::uint32_t>(
+                  std::clamp(position, 0.0, cells)))
+              << axis;
+    }
+    keys[i] = (static_cast<std::uint64_t>(code) << 32) |
+              static_cast<std::uint64_t>(i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  const long long clusters_count =
+      (edges_count + static_cast<long long>(kClusterEdges) - 1) /
+      static_cast<long long>(kClusterEdges);
+  result.clusters_.resize(static_cast<size_t>(clusters_count));
+  std::vector<unsigned int> ordered(edges.size());
+#pragma omp parallel for
+  for (long long c = 0; c < clusters_count; ++c) {
+    size_t first = static_cast<size_t>(c) * kClusterEdges;
+    size_t last = std::min(first + kClusterEdges, result.edges_count_);
+    std::vector<unsigned int> chunk;
+    chunk.reserve((last - first) * 2);
+    for (size_t k = first; k < last; ++k) {
+      size_t edge = static_cast<size_t>(keys[k] & 0xFFFFFFFFu);
+      chunk.push_back(edges[edge * 2]);
+      chunk.push_back(edges[edge * 2 + 1]);
+    }
+    chunk = InteractionQuality::StrideOrder(chunk);
+    std::copy(chunk.begin(), chunk.end(), ordered.begin() + first * 2);
+
+    EdgeCluster &cluster = result.clusters_[static_cast<size_t>(c)];
+    cluster.first_edge = first;
+    cluster.edges_count = last - first;
+    const float *point = &vertices[chunk[0] * 3];
+    cluster.box.min = cluster.box.max = Vector3D(point[0], point[1], point[2]);
+    for (unsigned int index : chunk) {
+      point = &vertices[index * 3];
+      cluster.box.min.x = std::min<double>(cluster.box.min.x, point[0]);
+      cluster.box.min.y = std::min<double>(cluster.box.min.y, point[1]);
+      cluster.box.min.z = std::min<double>(cluster.box.min.z, point[2]);
+      cluster.box.max.x = std::max<double>(cluster.box.max.x, point[0]);
+      cluster.box.max.y = std::max<double>(cluster.box.max.y, point[1]);
+      cluster.box.max.z = std::max<double>(cluster.box.max.z, point[2]);
+    }
+  }
+  edges.swap(ordered);
+  return result;
+}
+
+/**
+ * @brief Плоскости пирамиды видимости (a, b, c, d), нормали направлены
+ * внутрь: точка видима, если a*x + b*y + c*z + d >= 0 для всех шести.
+ * Строки матрицы складываются и вычитаются, как в clip space -w <= x, y, z <= w.
+ */
+std::array<std::array<double, 4>, 6> EdgeClusters::FrustumPlanes(
+    const IMatrix &mvp) {
+  std::array<std::array<double, 4>, 6> planes;
+  for (int axis = 0; axis < 3; ++axis) {
+    for (int col = 0; col < 4; ++col) {
+      planes[axis * 2][col] = mvp(3, col) + mvp(axis, col);
+      planes[axis * 2 + 1][col] = mvp(3, col) - mvp(axis, col);
+    }
+  }
+  return planes;
+}
+
+/**
+ * @brief Рамка невидима, если целиком лежит снаружи хотя бы одной плоскости
+ * (проверяется ее угол, самый дальний по нормали плоскости). Проверка
+ * консервативная: часть невидимых рамок у ребер пирамиды считается видимыми.
+ */
+bool EdgeClusters::IsBoxVisible(
+    const std::array<std::array<double, 4>, 6> &planes,
+    const BoundingBox &box) {
+  bool result = true;
+  for (size_t i = 0; i < planes.size() && result; ++i) {
+    const std::array<double, 4> &plane = planes[i];
+    double distance = plane[0] * (plane[0] >= 0 ? box.max.x : box.min.x) +
+                      plane[1] * (plane[1] >= 0 ? box.max.y : box.min.y) +
+                      plane[2] * (plane[2] >= 0 ? box.max.z : box.min.z) +
+                      plane[3];
+    result = distance >= 0;
+  }
+  return result;
+}
+
+/**
+ * @brief Номера участков, рамки которых видны с матрицей mvp
+ */
+void EdgeClusters::Cull(const IMatrix &mvp, std::vector<size_t> &visible) const {
+  const std::array<std::array<double, 4>, 6> planes = FrustumPlanes(mvp);
+  visible.clear();
+  for (size_t i = 0; i < clusters_.size(); ++i) {
+    if (IsBoxVisible(planes, clusters_[i].box)) {
+      visible.push_back(i);
+    }
+  }
+}
+
+const std::vector<EdgeCluster> &EdgeClusters::GetClusters() const {
+  return clusters_;
+}
+
+size_t EdgeClusters::GetEdgesCount() const { return edges_count_; }
+
+size_t EdgeClusters::GetBytes() const {
+  return MemoryStats::HeapBlockBytes(clusters_.capacity() *
+                                     sizeof(EdgeCluster));
+}
+
+/**
+ * @brief Младшие kMortonBits бит value с двумя нулями между соседними битами
+ */
+std::uint32_t EdgeClusters::spread_bits_(std::uint32_t value) {
+  value &= 0x3FFu;
+  value = (value | (value << 16)) & 0x030000FFu;
+  value = (value | (value << 8)) & 0x0300F00Fu;
+  value = (value | (value << 4)) & 0x030C30C3u;
+  value = (value | (value << 2)) & 0x09249249u;
+  return value;
+}
+
+}  // namespace s21
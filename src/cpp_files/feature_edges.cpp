@@ -0,0 +1,173 @@
+#include "../include/feature_edges.h"
+
+namespace s21 {
+
+/**
+ * @brief Классификация ребер модели по смежным граням
+ * @param adjacency смежность граней faces (MeshAdjacency::Build или
+ * Model3D::GetAdjacency)
+ * @param crease_degrees ребро между гранями, нормали которых расходятся
+ * больше чем на этот угол, считается изломом
+ * @param token при отмене построение прерывается, результат неполный
+ */
+FeatureEdges FeatureEdges::Build(
+    const std::vector<Vector3D> &vertices,
+    const std::vector<std::vector<unsigned int>> &faces,
+    const MeshAdjacency &adjacency, double crease_degrees,
+    const CancellationToken &token) {
+  TraceScope trace("FeatureEdges::Build", "analysis");
+  FeatureEdges result;
+  const long long faces_count = static_cast<long long>(faces.size());
+
+  // единичные нормали и плоскости граней (у вырожденной грани нормаль нулевая)
+  std::vector<Vector3D> normals(faces.size());
+  result.face_planes_.resize(faces.size());
+#pragma omp parallel for
+  for (long long i = 0; i < faces_count; ++i) {
+    Vector3D normal = FaceNormal(vertices, faces[i]);
+    double length = normal.length();
+    if (length > 0) {
+      normal = normal * (1.0 / length);
+    }
+    double offset = faces[i].empty()
+                        ? 0.0
+                        : -normal.scalar(vertices[faces[i].front()]);
+    normals[i] = normal;
+    result.face_planes_[i] = {static_cast<float>(normal.x),
+                              static_cast<float>(normal.y),
+                              static_cast<float>(normal.z),
+                              static_cast<float>(offset)};
+  }
+
+  const double min_cos = std::cos(crease_degrees * M_PI / 180.0);
+  const long long edges_count =
+      token.IsCancelled() ? 0
+                          : static_cast<long long>(adjacency.GetEdgesCount());
+  std::vector<EdgeKind> kinds(static_cast<size_t>(edges_count));
+#pragma omp parallel for
+  for (long long i = 0; i < edges_count; ++i) {
+    std::span<const unsigned int> edge_faces = adjacency.GetEdgeFaces(i);
+    EdgeKind kind = EdgeKind::kNonManifold;
+    if (edge_faces.size() == 1) {
+      kind = EdgeKind::kBoundary;
+    } else if (edge_faces.size() == 2) {
+      double cos = normals[edge_faces[0]].scalar(normals[edge_faces[1]]);
+      kind = cos < min_cos ? EdgeKind::kCrease : EdgeKind::kSmooth;
+    }
+    kinds[i] = kind;
+  }
+
+  for (long long i = 0; i < edges_count; ++i) {
+    auto [a, b] = adjacency.GetEdge(i);
+    if (kinds[i] == EdgeKind::kSmooth) {
+      std::span<const unsigned int> edge_faces = adjacency.GetEdgeFaces(i);
+      result.smooth_edges_.insert(result.smooth_edges_.end(), {a, b});
+      result.smooth_faces_.insert(result.smooth_faces_.end(),
+                                  {edge_faces[0], edge_faces[1]});
+    } else {
+      result.feature_edges_.insert(result.feature_edges_.end(), {a, b});
+    }
+    ++result.kind_counts_[static_cast<size_t>(kinds[i])];
+  }
+  return result;
+}
+
+/**
+ * @brief Нормаль многоугольника по формуле Ньюэлла (устойчива для
+ * неплоских граней), длина - удвоенная площадь проекции
+ */
+Vector3D FeatureEdges::FaceNormal(const std::vector<Vector3D> &vertices,
+                                  const std::vector<unsigned int> &face) {
+  Vector3D normal;
+  for (size_t i = 0; i < face.size(); ++i) {
+    const Vector3D &current = vertices[face[i]];
+    const Vector3D &next = vertices[face[(i + 1) % face.size()]];
+    normal.x += (current.y - next.y) * (current.z + next.z);
+    normal.y += (current.z - next.z) * (current.x + next.x);
+    normal.z += (current.x - next.x) * (current.y + next.y);
+  }
+  return normal;
+}
+
+/**
+ * @brief Однородные координаты камеры в пространстве модели: точка, которая
+ * проецируется в x = y = w = 0. Это общий перпендикуляр строк x, y и w
+ * матрицы MVP (алгебраические дополнения). В параллельной проекции w = 0 и
+ * точка задает направление взгляда.
+ */
+std::array<double, 4> FeatureEdges::CameraPoint(const IMatrix &mvp) {
+  const int rows[3] = {0, 1, 3};
+  std::array<double, 4> result;
+  for (int skip = 0; skip < 4; ++skip) {
+    int cols[3];
+    for (int col = 0, k = 0; col < 4; ++col) {
+      if (col != skip) {
+        cols[k++] = col;
+      }
+    }
+    auto at = [&](int row, int col) { return mvp(rows[row], cols[col]); };
+    double minor = at(0, 0) * (at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1)) -
+                   at(0, 1) * (at(1, 0) * at(2, 2) - at(1, 2) * at(2, 0)) +
+                   at(0, 2) * (at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0));
+    result[skip] = skip % 2 == 0 ? minor : -minor;
+  }
+  return result;
+}
+
+/**
+ * @brief Контур для вида mvp: гладкие ребра, у которых одна смежная грань
+ * обращена к камере, а другая нет. Результат - пары индексов вершин.
+ */
+void FeatureEdges::Silhouette(const IMatrix &mvp,
+                              std::vector<unsigned int> &edges) const {
+  TraceScope trace("FeatureEdges::Silhouette", "analysis");
+  const std::array<double, 4> camera = CameraPoint(mvp);
+  const long long faces_count = static_cast<long long>(face_planes_.size());
+  std::vector<unsigned char> is_facing(face_planes_.size());
+#pragma omp parallel for
+  for (long long i = 0; i < faces_count; ++i) {
+    const std::array<float, 4> &plane = face_planes_[i];
+    is_facing[i] = plane[0] * camera[0] + plane[1] * camera[1] +
+                       plane[2] * camera[2] + plane[3] * camera[3] >
+                   0;
+  }
+  const long long smooth_count =
+      static_cast<long long>(smooth_edges_.size() / 2);
+  std::vector<unsigned char> is_contour(static_cast<size_t>(smooth_count));
+#pragma omp parallel for
+  for (long long i = 0; i < smooth_count; ++i) {
+    is_contour[i] = is_facing[smooth_faces_[i * 2]] !=
+                    is_facing[smooth_faces_[i * 2 + 1]];
+  }
+  edges.clear();
+  for (long long i = 0; i < smooth_count; ++i) {
+    if (is_contour[i]) {
+      edges.push_back(smooth_edges_[i * 2]);
+      edges.push_back(smooth_edges_[i * 2 + 1]);
+    }
+  }
+}
+
+/**
+ * @return границы, изломы и неманифолдные ребра (пары индексов вершин)
+ */
+const std::vector<unsigned int> &FeatureEdges::GetFeatureEdges() const {
+  return feature_edges_;
+}
+
+size_t FeatureEdges::GetCount(EdgeKind kind) const {
+  return kind_counts_[static_cast<size_t>(kind)];
+}
+
+size_t FeatureEdges::GetBytes() const {
+  return MemoryStats::HeapBlockBytes(feature_edges_.capacity() *
+                                     sizeof(unsigned int)) +
+         MemoryStats::HeapBlockBytes(smooth_edges_.capacity() *
+                                     sizeof(unsigned int)) +
+         MemoryStats::HeapBlockBytes(smooth_faces_.capacity() *
+                                     sizeof(unsigned int)) +
+         MemoryStats::HeapBlockBytes(face_planes_.capacity() *
+                                     sizeof(std::array<float, 4>));
+}
+
+}  // namespace s21
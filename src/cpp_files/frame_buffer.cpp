@@ -0,0 +1,140 @@
+#include "../include/frame_buffer.h"
+
+namespace s21 {
+
+RawFrame::RawFrame(int w, int h) { Resize(w, h); }
+
+void RawFrame::Resize(int w, int h) {
+  width = w;
+  height = h;
+  pixels.resize(static_cast<size_t>(w) * static_cast<size_t>(h) * 4);
+}
+
+/**
+ * @brief Копирование пикселей из QImage. Изображения в других форматах
+ * предварительно переводятся в 32-битный формат.
+ */
+void RawFrame::CopyFrom(const QImage &image) {
+  QImage frame = image;
+  if (frame.format() != QImage::Format_RGB32 &&
+      frame.format() != QImage::Format_ARGB32 &&
+      frame.format() != QImage::Format_ARGB32_Premultiplied) {
+    frame = frame.convertToFormat(QImage::Format_ARGB32);
+  }
+  if (width != frame.width() || height != frame.height()) {
+    Resize(frame.width(), frame.height());
+  }
+  const size_t row_bytes = static_cast<size_t>(frame.width()) * 4;
+  for (int y = 0; y < frame.height(); ++y) {
+    std::memcpy(pixels.data() + y * row_bytes, frame.constScanLine(y),
+                row_bytes);
+  }
+}
+
+/**
+ * @brief QImage поверх пикселей кадра без копирования, действителен, пока жив
+ * кадр и не меняется его размер
+ */
+QImage RawFrame::ToImage() const {
+  return QImage(pixels.data(), width, height, width * 4, QImage::Format_RGB32);
+}
+
+size_t RawFrame::GetBytes() const { return pixels.size(); }
+
+////////////////////////////////////////////////////////////////////////////////
+// реализация FrameRingBuffer
+
+FrameRingBuffer::FrameRingBuffer(size_t capacity, int width, int height)
+    : width_(width), height_(height) {
+  if (capacity == 0) {
+    throw std::invalid_argument(
+        "FrameRingBuffer::FrameRingBuffer(): capacity cannot be 0!");
+  }
+  slots_.reserve(capacity);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots_.emplace_back(width, height);
+  }
+}
+
+/**
+ * @brief Копирует кадр в следующий свободный слот. Если размер кадра
+ * отличается от размера слота (например, окно изменили во время записи), слот
+ * перевыделяется.
+ * @return false - буфер заполнен или закрыт, кадр отброшен
+ */
+bool FrameRingBuffer::Push(const QImage &image) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool result = false;
+  if (closed_ || count_ == slots_.size()) {
+    ++dropped_;
+  } else {
+    slots_[tail_].CopyFrom(image);
+    tail_ = (tail_ + 1) % slots_.size();
+    ++count_;
+    ++pushed_;
+    result = true;
+    not_empty_.notify_one();
+  }
+  return result;
+}
+
+/**
+ * @brief Забирает самый старый кадр без копирования: буфер пикселей слота
+ * меняется местами с буфером frame. Буфер frame до этого доводится до
+ * размера слота (вне мьютекса), чтобы следующий Push в этот слот не выделял
+ * память.
+ * @return false - буфер закрыт и все кадры уже прочитаны
+ */
+bool FrameRingBuffer::Pop(RawFrame &frame) {
+  frame.Resize(width_, height_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [this] { return count_ > 0 || closed_; });
+  bool result = false;
+  if (count_ > 0) {
+    RawFrame &slot = slots_[head_];
+    std::swap(frame.width, slot.width);
+    std::swap(frame.height, slot.height);
+    frame.pixels.swap(slot.pixels);
+    head_ = (head_ + 1) % slots_.size();
+    --count_;
+    result = true;
+  }
+  return result;
+}
+
+/**
+ * @brief Сообщает кодировщику, что новых кадров не будет
+ */
+void FrameRingBuffer::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  not_empty_.notify_all();
+}
+
+size_t FrameRingBuffer::GetCapacity() const { return slots_.size(); }
+
+size_t FrameRingBuffer::GetSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+size_t FrameRingBuffer::GetPushedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pushed_;
+}
+
+size_t FrameRingBuffer::GetDroppedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+size_t FrameRingBuffer::GetAllocatedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t bytes = 0;
+  for (const auto &slot : slots_) {
+    bytes += slot.pixels.capacity();
+  }
+  return bytes;
+}
+
+}  // namespace s21
@@ -1,51 +1,152 @@
 #include "../include/gif_creator.h"
 
+#include <sys/resource.h>
+
 namespace s21 {
 
 GifCreator::GifCreator(int target_frames, QString &gif_fr_path,
-                       QString gif_target_path, double anim_delay)
+                       QString gif_target_path, double anim_delay,
+                       qint64 record_started_ms)
     : target_frames_(target_frames),
       gif_frames_path_(gif_fr_path),
       gif_target_path_(gif_target_path),
-      animation_delay_(anim_delay) {}
+      animation_delay_(anim_delay),
+      record_started_ms_(record_started_ms) {}
+
+GifCreator::GifCreator(std::shared_ptr<FrameRingBuffer> frames,
+                       QString gif_target_path, double anim_delay,
+                       qint64 record_started_ms)
+    : target_frames_(0),
+      gif_target_path_(gif_target_path),
+      animation_delay_(anim_delay),
+      frames_(std::move(frames)),
+      record_started_ms_(record_started_ms) {}
 
+/**
+ * @brief Сборка gif. При работе с кольцевым буфером метод запускается сразу
+ * при старте записи и обрабатывает кадры по мере их поступления, поэтому к
+ * моменту окончания записи остается только закодировать кадры и сохранить
+ * файл. Кодирование (общая палитра и кадры-разности) выполняет
+ * GifFrameEncoder. Если не захвачено ни одного кадра, файл не создается, а
+ * отправляется GifError.
+ */
 void GifCreator::CreateGif() {
-  std::vector<Magick::Image> images;
+  TraceScope trace("GifCreator::CreateGif", "gif");
+  std::vector<RawFrame> frames;
   try {
-    for (int i = 1; i <= target_frames_; i++) {
-      QString frames_count = QString::number(i);
-      QString q_file_name = QString("%1/Screenshot_for_gif_%2%3")
-                                .arg(gif_frames_path_, frames_count, ".jpeg");
-      QFileInfo file_info(q_file_name);
-      if (file_info.exists()) {
-        Magick::Image image;
-        image.read(q_file_name.toStdString());
-        image.resize(Magick::Geometry(640, 480));
-        image.quantizeColors(256);
-        image.animationDelay(animation_delay_);
-        images.push_back(image);
+    {
+      TraceScope read_trace("GifCreator::read_frames", "gif");
+      if (frames_) {
+        read_frames_from_buffer_(frames);
       } else {
-        qDebug() << "File does not exists: " << q_file_name << ", skipped";
+        read_frames_from_disk_(frames);
+      }
+    }
+    QElapsedTimer encode_timer;
+    encode_timer.start();
+    GifFrameEncoder encoder(256);
+    std::vector<Magick::Image> images;
+    {
+      TraceScope encode_trace("GifFrameEncoder::Encode", "gif");
+      images = encoder.Encode(frames, animation_delay_);
+    }
+    if (images.empty()) {
+      emit GifError("GIF: no frames were captured");
+    } else {
+      {
+        TraceScope write_trace("Magick::writeImages", "gif");
+        Magick::writeImages(images.begin(), images.end(),
+                            gif_target_path_.toStdString());
       }
+      qDebug() << "GIF successfully created, path:" << gif_target_path_;
+      qDebug() << "GIF encoding:" << encode_timer.elapsed() << "ms, palette:"
+               << encoder.GetPalette().size() << "colors, written frames:"
+               << images.size() << "of" << frames.size();
+      print_record_stats_(frames.size());
     }
-    Magick::writeImages(images.begin(), images.end(),
-                        gif_target_path_.toStdString());
-    qDebug() << "GIF successfully created, path:" << gif_target_path_;
-    clear_jpegs_for_gif_();
+    if (!frames_) clear_jpegs_for_gif_();
   } catch (Magick::Exception &error) {
     emit GifError(error.what());
   }
   emit Ok();
 }
 
+/**
+ * @brief Кадры забираются из кольцевого буфера прямо в frames, без
+ * копирования; копируются только кадры не того размера, их нужно
+ * масштабировать
+ */
+void GifCreator::read_frames_from_buffer_(std::vector<RawFrame> &frames) {
+  frames.reserve(frames_->GetCapacity());
+  frames.emplace_back();
+  while (frames_->Pop(frames.back())) {
+    RawFrame &frame = frames.back();
+    if (frame.width != 640 || frame.height != 480) {
+      frame.CopyFrom(frame.ToImage().scaled(
+          640, 480, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    }
+    frames.emplace_back();
+  }
+  frames.pop_back();
+}
+
+void GifCreator::read_frames_from_disk_(std::vector<RawFrame> &frames) {
+  frames.reserve(target_frames_);
+  for (int i = 1; i <= target_frames_; i++) {
+    QString frames_count = QString::number(i);
+    QString q_file_name = QString("%1/Screenshot_for_gif_%2%3")
+                              .arg(gif_frames_path_, frames_count, ".png");
+    QFileInfo file_info(q_file_name);
+    if (file_info.exists()) {
+      add_frame_(frames, QImage(q_file_name));
+    } else {
+      qDebug() << "File does not exists: " << q_file_name << ", skipped";
+    }
+  }
+}
+
+/**
+ * @brief Приведение кадра к размеру gif (offline запись сразу рисует кадры
+ * нужного размера) и сохранение его копии
+ */
+void GifCreator::add_frame_(std::vector<RawFrame> &frames,
+                            const QImage &image) {
+  frames.emplace_back();
+  if (image.width() != 640 || image.height() != 480) {
+    frames.back().CopyFrom(image.scaled(640, 480, Qt::IgnoreAspectRatio,
+                                        Qt::SmoothTransformation));
+  } else {
+    frames.back().CopyFrom(image);
+  }
+}
+
+/**
+ * @brief Вывод времени записи (от нажатия кнопки до сохранения файла) и пикового
+ * потребления памяти процессом, чтобы можно было сравнить запись через
+ * кольцевой буфер и запись со сбросом кадров на диск
+ */
+void GifCreator::print_record_stats_(size_t frames_count) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  qint64 elapsed = QDateTime::currentMSecsSinceEpoch() - record_started_ms_;
+  qDebug() << "GIF record stats:" << (frames_ ? "in-memory" : "disk spill")
+           << "path, frames:" << frames_count << ", total time:" << elapsed
+           << "ms, peak RSS:" << usage.ru_maxrss / 1024 << "MB";
+  if (frames_) {
+    qDebug() << "GIF ring buffer:" << frames_->GetCapacity() << "slots,"
+             << frames_->GetAllocatedBytes() / (1024 * 1024)
+             << "MB, dropped frames:" << frames_->GetDroppedCount();
+  }
+}
+
 void GifCreator::clear_jpegs_for_gif_() {
   QDir dir(gif_frames_path_);
   QStringList filters;
-  filters << "Screenshot_for_gif_*.jpeg";
+  filters << "Screenshot_for_gif_*.png";
   dir.setNameFilters(filters);
   for (const auto &file : dir.entryList()) {
     dir.remove(file);
   }
 }
 
-}  // namespace s21
\ No newline at end of file
+}  // namespace s21
@@ -0,0 +1,225 @@
+#include "../include/gif_encoder.h"
+
+namespace s21 {
+
+bool FrameRect::IsEmpty() const { return width <= 0 || height <= 0; }
+
+GifFrameEncoder::GifFrameEncoder(size_t max_colors)
+    : max_colors_(std::clamp<size_t>(max_colors, 1, 256)) {}
+
+/**
+ * @brief Построение общей палитры для всех кадров. Цвета группируются по
+ * ячейкам 5-5-5 бит, гистограмма считается параллельно по кадрам. В палитру
+ * попадают max_colors_ самых частых ячеек, цвет ячейки - среднее ее пикселей.
+ */
+void GifFrameEncoder::BuildPalette(const std::vector<RawFrame> &frames) {
+  std::vector<unsigned long long> counts(kBins, 0), sum_r(kBins, 0),
+      sum_g(kBins, 0), sum_b(kBins, 0);
+  unsigned long long *count = counts.data();
+  unsigned long long *red = sum_r.data();
+  unsigned long long *green = sum_g.data();
+  unsigned long long *blue = sum_b.data();
+  const long long frames_count = static_cast<long long>(frames.size());
+
+#pragma omp parallel for schedule(dynamic) \
+    reduction(+ : count[:kBins], red[:kBins], green[:kBins], blue[:kBins])
+  for (long long f = 0; f < frames_count; ++f) {
+    const RawFrame &frame = frames[f];
+    const size_t pixels_count = frame.pixels.size() / 4;
+    for (size_t i = 0; i < pixels_count; ++i) {
+      const unsigned char *pixel = frame.pixels.data() + i * 4;
+      size_t bin = color_bin_(pixel);
+      ++count[bin];
+      blue[bin] += pixel[0];
+      green[bin] += pixel[1];
+      red[bin] += pixel[2];
+    }
+  }
+
+  std::vector<size_t> used_bins;
+  for (size_t bin = 0; bin < kBins; ++bin) {
+    if (counts[bin] > 0) used_bins.push_back(bin);
+  }
+  size_t colors = std::min(max_colors_, used_bins.size());
+  std::partial_sort(
+      used_bins.begin(), used_bins.begin() + colors, used_bins.end(),
+      [&counts](size_t a, size_t b) { return counts[a] > counts[b]; });
+
+  palette_.clear();
+  for (size_t i = 0; i < colors; ++i) {
+    size_t bin = used_bins[i];
+    unsigned int r = static_cast<unsigned int>(sum_r[bin] / counts[bin]);
+    unsigned int g = static_cast<unsigned int>(sum_g[bin] / counts[bin]);
+    unsigned int b = static_cast<unsigned int>(sum_b[bin] / counts[bin]);
+    palette_.push_back((r << 16) | (g << 8) | b);
+  }
+  if (palette_.empty()) palette_.push_back(0);
+  build_bin_palette_();
+}
+
+/**
+ * @brief Замена каждого пикселя на ближайший цвет общей палитры. Кадры
+ * обрабатываются параллельно.
+ */
+void GifFrameEncoder::ApplyPalette(std::vector<RawFrame> &frames) const {
+  if (bin_palette_.empty()) {
+    throw std::logic_error(
+        "GifFrameEncoder::ApplyPalette(): palette is not built!");
+  }
+  const long long frames_count = static_cast<long long>(frames.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for (long long f = 0; f < frames_count; ++f) {
+    RawFrame &frame = frames[f];
+    const size_t pixels_count = frame.pixels.size() / 4;
+    for (size_t i = 0; i < pixels_count; ++i) {
+      unsigned char *pixel = frame.pixels.data() + i * 4;
+      unsigned int color = palette_[bin_palette_[color_bin_(pixel)]];
+      pixel[0] = static_cast<unsigned char>(color & 0xFF);
+      pixel[1] = static_cast<unsigned char>((color >> 8) & 0xFF);
+      pixel[2] = static_cast<unsigned char>((color >> 16) & 0xFF);
+      pixel[3] = 0xFF;
+    }
+  }
+}
+
+/**
+ * @brief Поиск прямоугольника, в котором cur отличается от prev.
+ * @return весь кадр, если размеры кадров не совпадают, пустой прямоугольник,
+ * если кадры одинаковые
+ */
+FrameRect GifFrameEncoder::FindChangedRect(const RawFrame &prev,
+                                           const RawFrame &cur) {
+  FrameRect rect;
+  if (prev.width != cur.width || prev.height != cur.height) {
+    rect.width = cur.width;
+    rect.height = cur.height;
+  } else {
+    int min_x = cur.width, min_y = cur.height, max_x = -1, max_y = -1;
+    const size_t row_bytes = static_cast<size_t>(cur.width) * 4;
+    for (int y = 0; y < cur.height; ++y) {
+      const unsigned char *prev_row = prev.pixels.data() + y * row_bytes;
+      const unsigned char *cur_row = cur.pixels.data() + y * row_bytes;
+      if (std::memcmp(prev_row, cur_row, row_bytes) != 0) {
+        int x = 0;
+        while (std::memcmp(prev_row + x * 4, cur_row + x * 4, 4) == 0) ++x;
+        min_x = std::min(min_x, x);
+        x = cur.width - 1;
+        while (std::memcmp(prev_row + x * 4, cur_row + x * 4, 4) == 0) --x;
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = y;
+      }
+    }
+    if (max_x >= min_x && max_y >= min_y) {
+      rect.x = min_x;
+      rect.y = min_y;
+      rect.width = max_x - min_x + 1;
+      rect.height = max_y - min_y + 1;
+    }
+  }
+  return rect;
+}
+
+/**
+ * @brief Полный проход кодирования: общая палитра, перевод кадров в палитру,
+ * поиск изменившихся прямоугольников (параллельно) и сборка кадров Magick.
+ * Кадр без изменений не записывается, его задержка добавляется предыдущему.
+ */
+std::vector<Magick::Image> GifFrameEncoder::Encode(
+    std::vector<RawFrame> &frames, double anim_delay) {
+  std::vector<Magick::Image> images;
+  if (!frames.empty()) {
+    BuildPalette(frames);
+    ApplyPalette(frames);
+
+    const long long frames_count = static_cast<long long>(frames.size());
+    std::vector<FrameRect> rects(frames.size());
+    rects[0] = {0, 0, frames[0].width, frames[0].height};
+#pragma omp parallel for schedule(dynamic)
+    for (long long f = 1; f < frames_count; ++f) {
+      rects[f] = FindChangedRect(frames[f - 1], frames[f]);
+    }
+
+    images.reserve(frames.size());
+    for (size_t f = 0; f < frames.size(); ++f) {
+      if (rects[f].IsEmpty()) {
+        // пустой первый кадр некуда присоединить, он пропускается
+        if (!images.empty()) {
+          Magick::Image &last = images.back();
+          last.animationDelay(last.animationDelay() +
+                              static_cast<size_t>(anim_delay));
+        }
+      } else {
+        Magick::Image image = crop_frame_(frames[f], rects[f]);
+        image.gifDisposeMethod(Magick::NoneDispose);
+        image.animationDelay(static_cast<size_t>(anim_delay));
+        images.push_back(image);
+      }
+    }
+  }
+  return images;
+}
+
+const std::vector<unsigned int> &GifFrameEncoder::GetPalette() const {
+  return palette_;
+}
+
+size_t GifFrameEncoder::color_bin_(const unsigned char *pixel) {
+  return (static_cast<size_t>(pixel[2] >> (8 - kBinBits)) << (2 * kBinBits)) |
+         (static_cast<size_t>(pixel[1] >> (8 - kBinBits)) << kBinBits) |
+         static_cast<size_t>(pixel[0] >> (8 - kBinBits));
+}
+
+/**
+ * @brief Для каждой ячейки гистограммы заранее ищется ближайший цвет палитры,
+ * чтобы перевод пикселя в палитру был одним обращением к таблице
+ */
+void GifFrameEncoder::build_bin_palette_() {
+  bin_palette_.assign(kBins, 0);
+  const long long bins = static_cast<long long>(kBins);
+  const int half_step = 1 << (7 - kBinBits);
+
+#pragma omp parallel for
+  for (long long bin = 0; bin < bins; ++bin) {
+    int r = static_cast<int>((bin >> (2 * kBinBits)) << (8 - kBinBits)) +
+            half_step;
+    int g = static_cast<int>(((bin >> kBinBits) & ((1 << kBinBits) - 1))
+                             << (8 - kBinBits)) +
+            half_step;
+    int b = static_cast<int>((bin & ((1 << kBinBits) - 1)) << (8 - kBinBits)) +
+            half_step;
+    long best_distance = -1;
+    for (size_t i = 0; i < palette_.size(); ++i) {
+      int dr = r - static_cast<int>((palette_[i] >> 16) & 0xFF);
+      int dg = g - static_cast<int>((palette_[i] >> 8) & 0xFF);
+      int db = b - static_cast<int>(palette_[i] & 0xFF);
+      long distance = dr * dr + dg * dg + db * db;
+      if (best_distance < 0 || distance < best_distance) {
+        best_distance = distance;
+        bin_palette_[bin] = static_cast<unsigned short>(i);
+      }
+    }
+  }
+}
+
+Magick::Image GifFrameEncoder::crop_frame_(const RawFrame &frame,
+                                           const FrameRect &rect) {
+  std::vector<unsigned char> pixels(static_cast<size_t>(rect.width) *
+                                    rect.height * 4);
+  const size_t row_bytes = static_cast<size_t>(rect.width) * 4;
+  const size_t frame_row_bytes = static_cast<size_t>(frame.width) * 4;
+  for (int y = 0; y < rect.height; ++y) {
+    std::memcpy(pixels.data() + y * row_bytes,
+                frame.pixels.data() + (rect.y + y) * frame_row_bytes +
+                    static_cast<size_t>(rect.x) * 4,
+                row_bytes);
+  }
+  // P - пропуск байта альфа-канала, кадры gif непрозрачные
+  Magick::Image image(rect.width, rect.height, "BGRP", Magick::CharPixel,
+                      pixels.data());
+  image.page(Magick::Geometry(rect.width, rect.height, rect.x, rect.y));
+  return image;
+}
+
+}  // namespace s21
@@ -0,0 +1,152 @@
+#include "../include/gl_uploader.h"
+
+namespace s21 {
+
+/**
+ * @brief Создание контекста загрузчика (в потоке gui, как требует Qt) и
+ * запуск потока. Загрузчик недействителен, если разделяемый контекст не
+ * создался или в нем нет fence (нужен OpenGL 3.2 или GL_ARB_sync), тогда
+ * виджет загружает буферы сам.
+ */
+GlUploader::GlUploader(QOpenGLContext *share_context) : worker_(new QObject) {
+  if (share_context) {
+    surface_ = std::make_unique<QOffscreenSurface>();
+    surface_->setFormat(share_context->format());
+    surface_->create();
+    context_ = std::make_unique<QOpenGLContext>();
+    context_->setFormat(share_context->format());
+    context_->setShareContext(share_context);
+    is_valid_ = surface_->isValid() && context_->create() &&
+                context_->shareContext() == share_context &&
+                (context_->format().version() >= qMakePair(3, 2) ||
+                 context_->hasExtension(QByteArrayLiteral("GL_ARB_sync")));
+  }
+  worker_->moveToThread(&thread_);
+  connect(&thread_, &QThread::finished, worker_, &QObject::deleteLater);
+  if (is_valid_) {
+    context_->moveToThread(&thread_);
+  }
+  thread_.start();
+  thread_.setObjectName("gl uploader");
+  QMetaObject::invokeMethod(
+      worker_,
+      []() { Tracer::Instance().SetThreadName("gl uploader"); },
+      Qt::QueuedConnection);
+}
+
+/**
+ * @brief Начатая загрузка отменяется, контекст возвращается в поток gui и
+ * удаляется вместе с поверхностью уже после остановки потока
+ */
+GlUploader::~GlUploader() {
+  Cancel();
+  if (is_valid_) {
+    QThread *owner = thread();
+    QMetaObject::invokeMethod(
+        worker_,
+        [this, owner]() {
+          context_->doneCurrent();
+          context_->moveToThread(owner);
+        },
+        Qt::BlockingQueuedConnection);
+  }
+  thread_.quit();
+  thread_.wait();
+}
+
+bool GlUploader::IsValid() const { return is_valid_; }
+
+/**
+ * @brief Постановка загрузки в очередь потока загрузчика. Загрузки с меньшим
+ * номером, которые еще не закончились, прерываются.
+ */
+void GlUploader::Upload(Request request) {
+  latest_generation_ = request.generation;
+  QMetaObject::invokeMethod(
+      worker_, [this, request]() { upload_(request); }, Qt::QueuedConnection);
+}
+
+void GlUploader::Cancel() { latest_generation_ = 0; }
+
+void GlUploader::upload_(const Request &request) {
+  TraceScope trace("GlUploader::upload_", "gl");
+  if (is_latest_(request.generation)) {
+    bool done = false;
+    GLint vertex_bytes = 0, index_bytes = 0;
+    if (is_valid_ && context_->makeCurrent(surface_.get())) {
+      QOpenGLExtraFunctions *gl = context_->extraFunctions();
+      done = upload_buffer_(gl, request.vbo, request.vertices->data(),
+                            request.vertices->size() * sizeof(float),
+                            request.generation, vertex_bytes) &&
+             upload_buffer_(gl, request.ebo, request.indices->data(),
+                            request.indices->size() * sizeof(unsigned int),
+                            request.generation, index_bytes);
+      context_->doneCurrent();
+    }
+    if (done) {
+      emit Uploaded(request.generation, vertex_bytes, index_bytes);
+    } else if (is_latest_(request.generation)) {
+      emit UploadFailed(request.generation);
+    }
+  }
+}
+
+/**
+ * @brief Загрузка одного буфера частями. Буфер привязывается к
+ * GL_COPY_WRITE_BUFFER, чтобы не трогать привязки, которые использует
+ * отрисовка.
+ * @return false - загрузка отменена или ожидание fence закончилось ошибкой
+ */
+bool GlUploader::upload_buffer_(QOpenGLExtraFunctions *gl, GLuint buffer,
+                                const void *data, size_t bytes,
+                                size_t generation, GLint &uploaded_bytes) {
+  const char *chunk_data = static_cast<const char *>(data);
+  gl->glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  gl->glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytes),
+                   nullptr, GL_STATIC_DRAW);
+  bool result = true;
+  GLsync previous = nullptr;
+  for (size_t offset = 0; result && offset < bytes; offset += kChunkBytes) {
+    result = is_latest_(generation);
+    if (result) {
+      size_t chunk = std::min(kChunkBytes, bytes - offset);
+      gl->glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                          static_cast<GLsizeiptr>(chunk), chunk_data + offset);
+      GLsync fence = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      // пока копируется эта часть, ждем окончания предыдущей
+      if (previous) {
+        result = wait_fence_(gl, previous);
+      }
+      previous = fence;
+    }
+  }
+  if (previous) {
+    result = wait_fence_(gl, previous) && result;
+  }
+  gl->glGetBufferParameteriv(GL_COPY_WRITE_BUFFER, GL_BUFFER_SIZE,
+                             &uploaded_bytes);
+  gl->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  return result;
+}
+
+/**
+ * @brief Ожидание fence и его удаление. Первое ожидание отправляет команды
+ * драйверу (GL_SYNC_FLUSH_COMMANDS_BIT), иначе fence может не сработать
+ * никогда.
+ */
+bool GlUploader::wait_fence_(QOpenGLExtraFunctions *gl, GLsync fence) {
+  GLenum status = GL_TIMEOUT_EXPIRED;
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  while (status == GL_TIMEOUT_EXPIRED) {
+    status = gl->glClientWaitSync(fence, flags, kFenceTimeoutNs);
+    flags = 0;
+  }
+  gl->glDeleteSync(fence);
+  return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+bool GlUploader::is_latest_(size_t generation) const {
+  return generation == latest_generation_;
+}
+
+}  // namespace s21
@@ -2,21 +2,31 @@
 
 namespace s21 {
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent),
+      image_encoder_(std::make_unique<ImageEncodingService>()) {
   connect_timers_();
   gl_area_ = new GLWidget(this);
   setup_ui_();
   connect_all_();
-  Magick::InitializeMagick(nullptr);
 }
 
 MainWindow::~MainWindow() {}
 
 void MainWindow::SetModelData(const Model3DDataGl &gl_data) {
-  gl_area_->SetModelData(gl_data.vertices, gl_data.edges);
+  gl_area_->SetModelData(gl_data.vertices, gl_data.edges, gl_data.clusters);
   gl_area_->update();
 }
 
+void MainWindow::SetLodLevels(std::shared_ptr<const MeshLod> lod) {
+  gl_area_->SetLodLevels(std::move(lod));
+}
+
+void MainWindow::SetFeatureEdges(
+    std::shared_ptr<const FeatureEdges> features) {
+  gl_area_->SetFeatureEdges(std::move(features));
+}
+
 void MainWindow::SetMVPMatrix(const S21MatrixWrapper &mvp) {
   gl_area_->SetMVPMatrix(mvp);
   gl_area_->update();
@@ -31,6 +41,51 @@ void MainWindow::SetModelInfo(const std::string &file_name, size_t edges,
                        "; edges: " + edges_count);
 }
 
+/**
+ * @brief Память модели: сводка в панели информации, разбивка по категориям -
+ * во всплывающей подсказке
+ */
+void MainWindow::SetMemoryInfo(const MemoryStats &stats) {
+  memory_info_->setText(stats.Summary());
+  memory_info_->setToolTip(stats.Details());
+}
+
+/**
+ * @brief Итог проверки модели в панели информации, количество и места
+ * проблем - во всплывающей подсказке. Пустой указатель - проверка еще идет.
+ */
+void MainWindow::SetValidation(
+    std::shared_ptr<const MeshValidation> validation) {
+  if (validation) {
+    validation_info_->setText(validation->Summary());
+    validation_info_->setToolTip(validation->Details());
+  } else {
+    validation_info_->setText("Validation: checking...");
+    validation_info_->setToolTip(QString());
+  }
+}
+
+void MainWindow::AccountMemory(MemoryStats &stats) const {
+  gl_area_->AccountMemory(stats);
+}
+
+/**
+ * @brief Предупреждение перед загрузкой модели, которой по оценке не хватит
+ * памяти
+ * @return true - пользователь все равно хочет загрузить модель
+ */
+bool MainWindow::ConfirmLargeLoad(size_t predicted_bytes,
+                                  size_t available_bytes) {
+  QString message =
+      QString("Loading this model is expected to need about %1, but only %2 "
+              "of memory is available. Load it anyway?")
+          .arg(MemoryStats::FormatBytes(predicted_bytes),
+               MemoryStats::FormatBytes(available_bytes));
+  return QMessageBox::warning(this, "Not enough memory", message,
+                              QMessageBox::Yes | QMessageBox::No,
+                              QMessageBox::No) == QMessageBox::Yes;
+}
+
 void MainWindow::SetMemento(GLWidgetMemento &memento) {
   gl_area_->SetMemento(memento);
 }
@@ -39,11 +94,54 @@ GLWidgetMemento MainWindow::CreateMemento() {
   return gl_area_->CreateMemento();
 }
 
+/**
+ * @brief Показ прогресса загрузки модели (смещение в файле в байтах)
+ */
+void MainWindow::SetLoadProgress(qint64 bytes_read, qint64 total_bytes) {
+  int percent = 0;
+  if (total_bytes > 0) {
+    percent = static_cast<int>(bytes_read * 100 / total_bytes);
+  }
+  load_progress_->setValue(percent);
+  load_progress_->setVisible(true);
+  cancel_load_button_->setVisible(true);
+}
+
+void MainWindow::HideLoadProgress() {
+  load_progress_->setVisible(false);
+  cancel_load_button_->setVisible(false);
+}
+
+/**
+ * @brief Запуск рендеринга скриншота из tiles x tiles плиток. Матрицы MVP для
+ * плиток считаются в модели и приходят сюда через контроллер, порядок - по
+ * строкам, плитка (0, 0) - левая верхняя.
+ */
+void MainWindow::StartTiledScreenshot(
+    QString file_path, int tiles,
+    const std::vector<S21MatrixWrapper> &tile_mvps) {
+  tiles_per_side_ = tiles;
+  tile_mvps_ = tile_mvps;
+  next_tile_row_ = 0;
+  pending_strips_ = 0;
+  is_tiled_screenshot_running_ = true;
+  tile_file_path_ = file_path;
+  take_screenshot_button_->setEnabled(false);
+  start_tiled_save_thread_(file_path);
+  tile_strip_timer_->start(0);
+}
+
 /**
  * @brief обработка нужных данных перед закрытием приложения
  */
 void MainWindow::closeEvent(QCloseEvent *event) {
   qDebug() << "App is closing, saving state";
+  if (gif_shot_timer_->isActive() || offline_gif_timer_->isActive()) {
+    stop_gif_creating_();
+  }
+  if (is_tiled_screenshot_running_) {
+    stop_tiled_screenshot_();
+  }
   emit AppAboutToQuit();
   event->accept();
   QMainWindow::closeEvent(event);
@@ -56,6 +154,7 @@ void MainWindow::StartTranslModel_fps(double tx, double ty, double tz) {
   target_translation_ = {tx, ty, tz};
   animation_progress_ = 0.0;
   transl_animation_timer_->start(frame_interval_);
+  update_animating_();
 }
 
 void MainWindow::StartRotationModel_fps(double angle, Vector3D &axis) {
@@ -64,6 +163,7 @@ void MainWindow::StartRotationModel_fps(double angle, Vector3D &axis) {
   target__axis_ = axis;
   animation_progress_ = 0.0;
   rot_animation_timer_->start(frame_interval_);
+  update_animating_();
 }
 
 void MainWindow::StartScaleModel_fps(double scale_value) {
@@ -72,6 +172,7 @@ void MainWindow::StartScaleModel_fps(double scale_value) {
   current_scale_ = 1.0;
   animation_progress_ = 0.0;
   scale_animation_timer_->start(frame_interval_);
+  update_animating_();
 }
 
 void MainWindow::update_transl_animation_() {
@@ -80,6 +181,7 @@ void MainWindow::update_transl_animation_() {
   emit ProcessTranslation_fps(step.x, step.y, step.z);
   if (need_to_stop_()) {
     transl_animation_timer_->stop();
+    update_animating_();
   }
 }
 
@@ -90,6 +192,7 @@ void MainWindow::update_rotatin_animation_() {
   emit ProcessRotation_fps(step, target__axis_);
   if (need_to_stop_()) {
     rot_animation_timer_->stop();
+    update_animating_();
   }
 }
 
@@ -145,6 +248,20 @@ void MainWindow::check_timers_() {
   if (transl_animation_timer_->isActive()) transl_animation_timer_->stop();
   if (rot_animation_timer_->isActive()) rot_animation_timer_->stop();
   if (scale_animation_timer_->isActive()) stop_scale_animation_();
+  update_animating_();
+}
+
+/**
+ * @brief Передает GLWidget, идет ли анимация преобразований: пока она идет,
+ * модель рисуется упрощенной. При записи gif в реальном времени кадры
+ * снимаются с экрана, поэтому модель рисуется полностью.
+ */
+void MainWindow::update_animating_() {
+  bool is_animating = (transl_animation_timer_->isActive() ||
+                       rot_animation_timer_->isActive() ||
+                       scale_animation_timer_->isActive()) &&
+                      !gif_shot_timer_->isActive();
+  gl_area_->SetAnimating(is_animating);
 }
 
 bool MainWindow::need_to_stop_() {
@@ -158,6 +275,7 @@ bool MainWindow::need_to_stop_() {
 
 void MainWindow::stop_scale_animation_() {
   scale_animation_timer_->stop();
+  update_animating_();
   QString scale = QString::number(target_scale_);
   emit ProcessScale_nofps(scale);
 }
@@ -181,6 +299,7 @@ void MainWindow::change_line_color_() {
   }
   gl_area_->SetLineColor(color);
   gl_area_->update();
+  emit ViewStateChanged();
 }
 
 ///////////////////////////////////////////////////
@@ -200,6 +319,7 @@ void MainWindow::change_line_width_() {
   }
   gl_area_->SetLineWidth(num);
   gl_area_->update();
+  emit ViewStateChanged();
 }
 
 ///////////////////////////////////////////////////
@@ -213,6 +333,16 @@ void MainWindow::change_line_type_() {
     gl_area_->SetLineStipple(0xAAAA, 8);
   }
   gl_area_->update();
+  emit ViewStateChanged();
+}
+
+/**
+ * @brief Режим характерных ребер: GLWidget рисует их, как только сцена их
+ * построит (до этого - полный каркас)
+ */
+void MainWindow::change_feature_edges_mode_(bool enabled) {
+  gl_area_->SetFeatureEdgesMode(enabled);
+  emit FeatureEdgesChanged(enabled);
 }
 
 ///////////////////////////////////////////////////
@@ -234,6 +364,7 @@ void MainWindow::change_back_color_() {
   }
   gl_area_->SetBackgroundColor(color);
   gl_area_->update();
+  emit ViewStateChanged();
 }
 
 //////////////////////////////////////////////////
@@ -255,6 +386,7 @@ void MainWindow::change_vertex_color_() {
   }
   gl_area_->SetVertexColor(color);
   gl_area_->update();
+  emit ViewStateChanged();
 }
 
 void MainWindow::change_vertex_size_() {
@@ -271,6 +403,7 @@ void MainWindow::change_vertex_size_() {
   }
   gl_area_->SetVertexSize(size);
   gl_area_->update();
+  emit ViewStateChanged();
 }
 
 void MainWindow::change_vertex_visual_() {
@@ -283,9 +416,14 @@ void MainWindow::change_vertex_visual_() {
     gl_area_->SetNoVertexDisplay();
   }
   gl_area_->update();
+  emit ViewStateChanged();
 }
 
 void MainWindow::take_screenshot_() {
+  if (screenshot_tiles_->value() > 1) {
+    take_tiled_screenshot_();
+    return;
+  }
   // для забора расширения файла
   QString selected_filt;
   // запись пользователем куда сохранять, задача имени фала и расширения
@@ -294,7 +432,7 @@ void MainWindow::take_screenshot_() {
       &selected_filt);
   if (!file_path.isEmpty()) {
     // изображение захватили с окна GLWidget
-    QPixmap screen_image = gl_area_->grab();
+    QImage screen_image = gl_area_->grabFramebuffer();
     // разбиваем на части
     QFileInfo file_info(file_path);
     QString path = file_info.path();
@@ -311,17 +449,159 @@ void MainWindow::take_screenshot_() {
     QString file =
         QString("%1/Screenshot_%2.%3").arg(path, file_name, extension);
 
-    screen_image.save(file, extension.toUpper().toStdString().c_str());
-    qDebug() << "Screenshot saved to:" << file;
+    // сжатие и запись на диск - в потоке сервиса, gui не ждет
+    if (image_encoder_->Submit(std::move(screen_image), file,
+                               extension.toUpper().toStdString())) {
+      qDebug() << "Screenshot queued for saving to:" << file;
+    } else {
+      qDebug() << "Screenshot dropped, encoding queue is full:" << file;
+    }
+  }
+}
+
+/**
+ * @brief Скриншот большого разрешения: (tiles * 1024) x (tiles * 768).
+ * Сохраняется только в BMP - формат пишется полосами, и изображение целиком
+ * никогда не находится в памяти.
+ */
+void MainWindow::take_tiled_screenshot_() {
+  QString file_path = QFileDialog::getSaveFileName(
+      this, "Select file save location", "", "BMP (*.bmp)");
+  if (!file_path.isEmpty()) {
+    QFileInfo file_info(file_path);
+    QString file = QString("%1/Screenshot_%2.bmp")
+                       .arg(file_info.path(), file_info.completeBaseName());
+    int tiles = screenshot_tiles_->value();
+    // соотношение сторон всего изображения, а не одной плитки или окна
+    double aspect = static_cast<double>(tiles * tile_width_) /
+                    (tiles * tile_height_);
+    emit TiledScreenshotRequested(file, tiles, aspect);
+  }
+}
+
+/**
+ * @brief Рендеринг одной полосы плиток за тик таймера, чтобы окно не
+ * замирало на время всего скриншота. Если поток записи отстал на
+ * max_pending_strips_ полос, таймер останавливается до tile_strip_written_().
+ */
+void MainWindow::render_tile_strip_() {
+  if (pending_strips_ >= max_pending_strips_) {
+    tile_strip_timer_->stop();
+  } else {
+    QImage strip(tiles_per_side_ * tile_width_, tile_height_,
+                 QImage::Format_RGB32);
+    const size_t tile_row_bytes = static_cast<size_t>(tile_width_) * 4;
+    for (int column = 0; column < tiles_per_side_; ++column) {
+      QImage tile =
+          gl_area_
+              ->RenderToImage(
+                  tile_width_, tile_height_,
+                  tile_mvps_[next_tile_row_ * tiles_per_side_ + column])
+              .convertToFormat(QImage::Format_RGB32);
+      for (int y = 0; y < tile_height_ && y < tile.height(); ++y) {
+        std::memcpy(strip.scanLine(y) + column * tile_row_bytes,
+                    tile.constScanLine(y), tile_row_bytes);
+      }
+    }
+    ++pending_strips_;
+    ++next_tile_row_;
+    emit TileStripReady(strip);
+    if (next_tile_row_ == tiles_per_side_) {
+      tile_strip_timer_->stop();
+      emit TiledScreenshotRendered();
+    }
+  }
+}
+
+void MainWindow::tile_strip_written_() {
+  --pending_strips_;
+  if (is_tiled_screenshot_running_ && next_tile_row_ < tiles_per_side_ &&
+      !tile_strip_timer_->isActive()) {
+    tile_strip_timer_->start(0);
+  }
+}
+
+void MainWindow::tiled_screenshot_finished_() {
+  is_tiled_screenshot_running_ = false;
+  tile_save_thread_ = nullptr;
+  tile_mvps_.clear();
+  take_screenshot_button_->setEnabled(true);
+}
+
+void MainWindow::tiled_screenshot_error_(const std::string &error_message) {
+  if (is_tiled_screenshot_running_ && next_tile_row_ < tiles_per_side_) {
+    tile_strip_timer_->stop();
+    next_tile_row_ = tiles_per_side_;
+    emit TiledScreenshotRendered();
+  }
+  QMessageBox::critical(this, "Error", QString::fromStdString(error_message));
+}
+
+/**
+ * @brief Поток для записи полос скриншота на диск. Полосы передаются через
+ * сигнал TileStripReady (очередь событий потока), запись заканчивается по
+ * сигналу TiledScreenshotRendered.
+ */
+void MainWindow::start_tiled_save_thread_(const QString &file_path) {
+  QThread *thread = new QThread();
+  TiledScreenshotSaver *saver =
+      new TiledScreenshotSaver(file_path, tiles_per_side_ * tile_width_,
+                               tiles_per_side_ * tile_height_);
+  saver->moveToThread(thread);
+
+  connect(thread, &QThread::started, saver, &TiledScreenshotSaver::Start);
+  connect(this, &MainWindow::TileStripReady, saver,
+          &TiledScreenshotSaver::WriteStrip);
+  connect(this, &MainWindow::TiledScreenshotRendered, saver,
+          &TiledScreenshotSaver::Finish);
+
+  connect(saver, &TiledScreenshotSaver::StripWritten, this,
+          &MainWindow::tile_strip_written_);
+  connect(saver, &TiledScreenshotSaver::SaveError, this,
+          &MainWindow::tiled_screenshot_error_);
+  connect(saver, &TiledScreenshotSaver::Finished, this,
+          &MainWindow::tiled_screenshot_finished_);
+  // поток останавливается из самого себя, а не через очередь gui: при
+  // закрытии окна поток gui ждет его в stop_tiled_screenshot_()
+  connect(saver, &TiledScreenshotSaver::Finished, thread, &QThread::quit,
+          Qt::DirectConnection);
+
+  connect(thread, &QThread::finished, saver, &QObject::deleteLater);
+  connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+  tile_save_thread_ = thread;
+  thread->start();
+}
+
+/**
+ * @brief Остановка скриншота из плиток при закрытии окна. Если все полосы уже
+ * отрисованы, поток записи дописывает файл; иначе он останавливается сразу, а
+ * недописанный файл удаляется. В обоих случаях поток gui ждет его
+ * завершения, чтобы поток не работал во время удаления окна.
+ */
+void MainWindow::stop_tiled_screenshot_() {
+  tile_strip_timer_->stop();
+  bool is_rendered = next_tile_row_ == tiles_per_side_;
+  if (!is_rendered) {
+    tile_save_thread_->quit();
+  }
+  tile_save_thread_->wait();
+  if (!is_rendered) {
+    QFile::remove(tile_file_path_);
   }
+  is_tiled_screenshot_running_ = false;
+  tile_save_thread_ = nullptr;
 }
 
 void MainWindow::record_gif_anim_() {
-  if (gif_shot_timer_->isActive()) {
+  if (gif_shot_timer_->isActive() || offline_gif_timer_->isActive()) {
     stop_gif_creating_();
   }
-  check_gif_pics_dir_();
+  bool is_offline = offline_gif_check_->isChecked();
+  spill_gif_frames_ = !is_offline && spill_gif_frames_check_->isChecked();
+  if (spill_gif_frames_) check_gif_pics_dir_();
   current_frames_ = 0;
+  stored_gif_frames_ = 0;
   target_frames_ = 50;
   QString selected_filt;
   gif_path_.clear();
@@ -332,25 +612,89 @@ void MainWindow::record_gif_anim_() {
     QString path = file_info.path();
     QString file_name = file_info.completeBaseName();
     gif_path_ = QString("%1/%2.gif").arg(path, file_name);
+    record_started_ms_ = QDateTime::currentMSecsSinceEpoch();
+    if (is_offline) {
+      start_offline_gif_recording_();
+    } else if (!spill_gif_frames_) {
+      // слоты буфера выделяются сразу под размер кадра с GLWidget
+      qreal ratio = gl_area_->devicePixelRatio();
+      gif_frames_ = std::make_shared<FrameRingBuffer>(
+          gif_ring_capacity_, static_cast<int>(gl_area_->width() * ratio),
+          static_cast<int>(gl_area_->height() * ratio));
+      emit StartGifEncoding(gif_frames_, gif_path_, anim_delay_,
+                            record_started_ms_);
+    }
     record_gif_button_->setStyleSheet("background-color: red");
-    gif_shot_timer_->start(frame_gif_interval_);
+    if (!is_offline) gif_shot_timer_->start(frame_gif_interval_);
+    update_animating_();
   }
 }
 
+/**
+ * @brief Запуск offline записи gif. Таймеры анимаций продолжают считаться
+ * активными, но их сигналы блокируются: анимацию двигает только
+ * take_offline_gif_frame_(), поэтому содержимое кадров не зависит от скорости
+ * машины и от того, как часто срабатывают таймеры.
+ */
+void MainWindow::start_offline_gif_recording_() {
+  gif_frames_ = std::make_shared<FrameRingBuffer>(
+      gif_ring_capacity_, gif_frame_width_, gif_frame_height_);
+  emit StartGifEncoding(gif_frames_, gif_path_, anim_delay_,
+                        record_started_ms_);
+  block_animation_timers_(true);
+  offline_gif_timer_->start(0);
+}
+
+/**
+ * @brief Захват кадра gif. Кадр читается с видеокарты асинхронно, поэтому
+ * здесь сохраняется кадр, захваченный несколько вызовов назад (если он есть),
+ * оставшиеся кадры забираются в stop_gif_creating_().
+ */
 void MainWindow::take_picture_gif_() {
   ++current_frames_;
-  QString fr_count = QString::number(static_cast<int>(current_frames_));
-  // формирования названия файла (окончание на номер фрейма)
-  QString file = QString("%1/Screenshot_for_gif_%2%3")
-                     .arg(gif_frames_path_, fr_count, ".jpeg");
-
-  QPixmap screen_image = gl_area_->grab();
-  screen_image.save(file, "JPEG");
+  QImage screen_image;
+  if (gl_area_->CaptureFrameAsync(screen_image)) {
+    store_gif_frame_(std::move(screen_image));
+  }
   if (current_frames_ >= target_frames_) {
     stop_gif_creating_();
   }
 }
 
+void MainWindow::store_gif_frame_(QImage frame) {
+  ++stored_gif_frames_;
+  if (spill_gif_frames_) {
+    QString fr_count = QString::number(stored_gif_frames_);
+    // формирования названия файла (окончание на номер фрейма)
+    QString file = QString("%1/Screenshot_for_gif_%2%3")
+                       .arg(gif_frames_path_, fr_count, ".png");
+    image_encoder_->Submit(std::move(frame), file, "PNG");
+  } else if (gif_frames_) {
+    gif_frames_->Push(frame);
+  }
+}
+
+/**
+ * @brief Один кадр offline записи: анимация продвигается ровно на интервал
+ * между кадрами gif, кадр рисуется во внеэкранный буфер. Если кодировщик не
+ * успевает и буфер заполнен, кадр откладывается, а таймер ждет
+ * gif_ring_wait_ms_ вместо холостого вращения с нулевым интервалом.
+ */
+void MainWindow::take_offline_gif_frame_() {
+  if (gif_frames_ && gif_frames_->GetSize() < gif_frames_->GetCapacity()) {
+    offline_gif_timer_->setInterval(0);
+    ++current_frames_;
+    step_animations_(anim_steps_per_gif_frame_);
+    gif_frames_->Push(
+        gl_area_->RenderToImage(gif_frame_width_, gif_frame_height_));
+    if (current_frames_ >= target_frames_) {
+      stop_gif_creating_();
+    }
+  } else {
+    offline_gif_timer_->setInterval(gif_ring_wait_ms_);
+  }
+}
+
 void MainWindow::obj_load_clicked_() {
   // диалоговое окно для выбора файла
   QString file_path = QFileDialog::getOpenFileName(this, "Select .obj file", "",
@@ -359,12 +703,33 @@ void MainWindow::obj_load_clicked_() {
   if (!file_path.isEmpty()) {  // был ли выбран файл
     qDebug() << "Selected file:" << file_path;
     std::string path = file_path.toStdString();
+    SetLoadProgress(0, 1);
     emit ProcessObjLoad(path);
   } else {  // отмена выбора
     qDebug() << "No file selected";
   }
 }
 
+/**
+ * @brief Экспорт состояния сессии в читаемый json (основное хранилище
+ * сессии - двоичный logs/state.bin)
+ */
+void MainWindow::export_state_clicked_() {
+  QString file_path = QFileDialog::getSaveFileName(
+      this, "Select file save location", "", "JSON (*.json)");
+  if (!file_path.isEmpty()) {
+    emit ExportStateRequested(file_path);
+  }
+}
+
+void MainWindow::import_state_clicked_() {
+  QString file_path = QFileDialog::getOpenFileName(this, "Select state file",
+                                                   "", "JSON (*.json)");
+  if (!file_path.isEmpty()) {
+    emit ImportStateRequested(file_path);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // соединение сигналов от кнопок и слотов для их обработки, а также сигналов от
 // таймера и обработки истечения таймера
@@ -373,6 +738,20 @@ void MainWindow::connect_all_() {
   // для загрузки модели соединение кнопки и нажатия
   connect(load_model_button_, &QPushButton::clicked, this,
           &MainWindow::obj_load_clicked_);
+  connect(cancel_load_button_, &QPushButton::clicked, this,
+          &MainWindow::CancelLoadClicked);
+  connect(lenient_load_check_, &QCheckBox::toggled, this,
+          &MainWindow::LenientLoadingChanged);
+  connect(previous_model_button_, &QPushButton::clicked, this,
+          [this]() { emit StepModelClicked(-1); });
+  connect(next_model_button_, &QPushButton::clicked, this,
+          [this]() { emit StepModelClicked(1); });
+  connect(prefetch_check_, &QCheckBox::toggled, this,
+          &MainWindow::PrefetchChanged);
+  connect(export_state_button_, &QPushButton::clicked, this,
+          &MainWindow::export_state_clicked_);
+  connect(import_state_button_, &QPushButton::clicked, this,
+          &MainWindow::import_state_clicked_);
 
   // кнопки для внесения изменений в модель
   connect_apply_transform_();
@@ -406,6 +785,14 @@ void MainWindow::connect_timers_() {
   gif_shot_timer_ = new QTimer(this);
   connect(gif_shot_timer_, &QTimer::timeout, this,
           &MainWindow::take_picture_gif_);
+
+  offline_gif_timer_ = new QTimer(this);
+  connect(offline_gif_timer_, &QTimer::timeout, this,
+          &MainWindow::take_offline_gif_frame_);
+
+  tile_strip_timer_ = new QTimer(this);
+  connect(tile_strip_timer_, &QTimer::timeout, this,
+          &MainWindow::render_tile_strip_);
 }
 
 void MainWindow::connect_apply_transform_() {
@@ -460,6 +847,8 @@ void MainWindow::connect_line_type_buttons_() {
           &MainWindow::change_line_type_);
   connect(stipple_line_, &QPushButton::clicked, this,
           &MainWindow::change_line_type_);
+  connect(feature_edges_check_, &QCheckBox::toggled, this,
+          &MainWindow::change_feature_edges_mode_);
 }
 
 void MainWindow::connect_back_color_buttons_() {
@@ -558,6 +947,34 @@ void MainWindow::setup_ui_() {
 void MainWindow::setup_load_model_button_(QVBoxLayout *layout) {
   load_model_button_ = new QPushButton("Load model", this);
   layout->addWidget(load_model_button_);
+
+  QHBoxLayout *step_layout = new QHBoxLayout();
+  previous_model_button_ = new QPushButton("Previous model", this);
+  next_model_button_ = new QPushButton("Next model", this);
+  step_layout->addWidget(previous_model_button_);
+  step_layout->addWidget(next_model_button_);
+  layout->addLayout(step_layout);
+
+  lenient_load_check_ = new QCheckBox("Skip incorrect lines", this);
+  layout->addWidget(lenient_load_check_);
+  prefetch_check_ = new QCheckBox("Prefetch neighbouring models", this);
+  layout->addWidget(prefetch_check_);
+
+  QHBoxLayout *progress_layout = new QHBoxLayout();
+  load_progress_ = new QProgressBar(this);
+  load_progress_->setRange(0, 100);
+  cancel_load_button_ = new QPushButton("Cancel", this);
+  progress_layout->addWidget(load_progress_);
+  progress_layout->addWidget(cancel_load_button_);
+  layout->addLayout(progress_layout);
+  HideLoadProgress();
+
+  QHBoxLayout *state_layout = new QHBoxLayout();
+  export_state_button_ = new QPushButton("Export state", this);
+  import_state_button_ = new QPushButton("Import state", this);
+  state_layout->addWidget(export_state_button_);
+  state_layout->addWidget(import_state_button_);
+  layout->addLayout(state_layout);
 }
 
 /**
@@ -798,6 +1215,11 @@ void MainWindow::setup_line_type_buttons_(QVBoxLayout *layout) {
   h_layout->setAlignment(Qt::AlignLeft);
 
   layout->addLayout(h_layout);
+
+  feature_edges_check_ = new QCheckBox("Feature edges only", this);
+  feature_edges_check_->setToolTip(
+      "Draw boundaries, creases and the silhouette instead of every edge");
+  layout->addWidget(feature_edges_check_);
 }
 
 void MainWindow::setup_vertex_color_buttons_(QVBoxLayout *layout) {
@@ -908,6 +1330,10 @@ void MainWindow::setup_model_info_(QVBoxLayout *layout) {
   layout->addWidget(file_name_);
   count_info_ = new QLabel(this);
   layout->addWidget(count_info_);
+  memory_info_ = new QLabel(this);
+  layout->addWidget(memory_info_);
+  validation_info_ = new QLabel(this);
+  layout->addWidget(validation_info_);
 }
 
 void MainWindow::setup_media_buttons_(QVBoxLayout *layout) {
@@ -921,6 +1347,20 @@ void MainWindow::setup_media_buttons_(QVBoxLayout *layout) {
   h_layout->addWidget(record_gif_button_);
 
   layout->addLayout(h_layout);
+
+  spill_gif_frames_check_ = new QCheckBox("Spill gif frames to disk", this);
+  layout->addWidget(spill_gif_frames_check_);
+  offline_gif_check_ = new QCheckBox("Offline gif recording", this);
+  layout->addWidget(offline_gif_check_);
+
+  QHBoxLayout *tiles_layout = new QHBoxLayout();
+  QLabel *tiles_label = new QLabel("Screenshot tiles per side:", this);
+  screenshot_tiles_ = new QSpinBox(this);
+  screenshot_tiles_->setRange(1, max_tiles_per_side_);
+  screenshot_tiles_->setValue(1);
+  tiles_layout->addWidget(tiles_label);
+  tiles_layout->addWidget(screenshot_tiles_);
+  layout->addLayout(tiles_layout);
 }
 
 void MainWindow::setup_projection_button_(QVBoxLayout *layout) {
@@ -974,9 +1414,19 @@ void MainWindow::check_gif_pics_dir_() {
 }
 
 void MainWindow::create_gif_from_jpegs_() {
-  if (!gif_path_.isEmpty()) {
+  if (gif_frames_) {
+    // поток кодировщика уже работает, ему достаточно узнать о конце записи
+    gif_frames_->Close();
+    gif_frames_.reset();
+  } else if (!gif_path_.isEmpty()) {
+    // кадры читаются с диска, поэтому все они должны быть уже записаны
+    image_encoder_->WaitIdle();
+    qDebug() << "Gif frames encoding queue: max depth"
+             << image_encoder_->GetMaxQueueDepth() << ", dropped"
+             << image_encoder_->GetDroppedCount() << ", failed"
+             << image_encoder_->GetFailedCount();
     emit CreateGifFromJpegs(target_frames_, gif_frames_path_, gif_path_,
-                            anim_delay_);
+                            anim_delay_, record_started_ms_);
   }
 }
 
@@ -985,7 +1435,7 @@ void MainWindow::add_jpegs_to_group_(std::vector<Magick::Image> &images) {
     for (int i = 1; i <= target_frames_; ++i) {
       QString frames_count = QString::number(i);
       QString q_file_name = QString("%1/Screenshot_for_gif_%2%3")
-                                .arg(gif_frames_path_, frames_count, ".jpeg");
+                                .arg(gif_frames_path_, frames_count, ".png");
       QFileInfo file_info(q_file_name);
       if (file_info.exists()) {
         Magick::Image image;
@@ -1011,7 +1461,7 @@ void MainWindow::add_jpegs_to_group_(std::vector<Magick::Image> &images) {
 void MainWindow::clear_jpegs_for_gif_() {
   QDir dir(gif_frames_path_);
   QStringList filters;
-  filters << "Screenshot_for_gif_*.jpeg";
+  filters << "Screenshot_for_gif_*.png";
   dir.setNameFilters(filters);
   for (const auto &file : dir.entryList()) {
     dir.remove(file);
@@ -1020,19 +1470,48 @@ void MainWindow::clear_jpegs_for_gif_() {
 
 void MainWindow::stop_gif_creating_() {
   record_gif_button_->setStyleSheet("background-color: green");
+  if (offline_gif_timer_->isActive()) {
+    offline_gif_timer_->stop();
+    block_animation_timers_(false);
+  }
   check_timers_();
-  if (gif_shot_timer_->isActive()) gif_shot_timer_->stop();
+  if (gif_shot_timer_->isActive()) {
+    gif_shot_timer_->stop();
+    for (auto &frame : gl_area_->FlushCaptures()) {
+      store_gif_frame_(std::move(frame));
+    }
+  }
+  update_animating_();
   create_gif_from_jpegs_();
 }
 
+/**
+ * @brief Продвигает активную анимацию на заданное количество шагов таймера.
+ * Слоты анимаций сами останавливают свой таймер, когда анимация закончилась.
+ */
+void MainWindow::step_animations_(int steps) {
+  for (int i = 0; i < steps; ++i) {
+    if (transl_animation_timer_->isActive()) update_transl_animation_();
+    if (rot_animation_timer_->isActive()) update_rotatin_animation_();
+    if (scale_animation_timer_->isActive()) update_scale_animation_();
+  }
+}
+
+void MainWindow::block_animation_timers_(bool block) {
+  transl_animation_timer_->blockSignals(block);
+  rot_animation_timer_->blockSignals(block);
+  scale_animation_timer_->blockSignals(block);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 // реализация GLWidget
 GLWidget::GLWidget(QWidget *parent)
     : QOpenGLWidget(parent),
-      vbo_(0),
-      ebo_(0),
+      vertices_(std::make_shared<const std::vector<float>>()),
+      edges_(std::make_shared<const std::vector<unsigned int>>()),
+      idle_timer_(new QTimer(this)),
       shader_program_(0),
       mvp_matrix_(S21MatrixWrapper(4, 4)),
       line_color_(0.0f, 0.0f, 0.0f, 1.0f),
@@ -1046,10 +1525,36 @@ GLWidget::GLWidget(QWidget *parent)
       is_point_vertex_round_(true),
       point_vertex_color_(0.2f, 0.3f, 0.3f, 1.0f) {
   mvp_matrix_.SetIdentity();
+  // после вращения модель снова рисуется с полной детализацией
+  idle_timer_->setSingleShot(true);
+  idle_timer_->setInterval(idle_delay_ms_);
+  connect(idle_timer_, &QTimer::timeout, this, [this]() {
+    is_interacting_ = false;
+    update();
+  });
+}
+
+GLWidget::~GLWidget() {
+  // поток загрузчика останавливается до удаления контекста виджета
+  uploader_.reset();
+  // внеэкранный буфер, PBO и буферы уровней должны удаляться при активном
+  // контексте
+  if (offscreen_fbo_ || !capture_pbos_.empty() || !lod_buffers_.empty() ||
+      feature_ebo_) {
+    makeCurrent();
+    offscreen_fbo_.reset();
+    release_capture_pbos_();
+    release_lod_buffers_();
+    release_feature_buffers_();
+    doneCurrent();
+  }
 }
 
 void GLWidget::SetMVPMatrix(const S21MatrixWrapper &mvp) {
   mvp_matrix_ = mvp;
+  is_silhouette_dirty_ = true;
+  is_interacting_ = true;
+  idle_timer_->start();
   update();
 }
 
@@ -1089,28 +1594,474 @@ void GLWidget::SetVertexColor(QVector4D &color) { point_vertex_color_ = color; }
 
 /**
  * @brief Метод для записи данных о фигуре и передачи этих данных OpenGL для
- * дальнейшей работы
+ * дальнейшей работы. Данные загружаются в задние буферы, а до конца загрузки
+ * рисуется прежняя модель из передних. Если есть фоновый загрузчик, поток gui
+ * не ждет копирования в видеопамять (см. GlUploader).
  */
 void GLWidget::SetModelData(const std::vector<float> &vertices,
-                            const std::vector<unsigned int> &edges) {
-  vertices_ = vertices;
-  edges_ = edges;
+                            const std::vector<unsigned int> &edges,
+                            std::shared_ptr<const EdgeClusters> clusters) {
+  TraceScope trace("GLWidget::SetModelData", "gl");
+  vertices_ = std::make_shared<const std::vector<float>>(vertices);
+  edges_ = std::make_shared<const std::vector<unsigned int>>(edges);
+  clusters_ = std::move(clusters);
+  ++upload_generation_;
+  // уровни и характерные ребра прежней модели больше не нужны: для большой
+  // модели новые уровни придут через SetLodLevels, маленькой они не нужны
+  // вовсе, а характерные ребра строятся заново только в их режиме
+  lod_.reset();
+  features_.reset();
+  std::vector<unsigned int>().swap(silhouette_edges_);
   if (context()) {
-    initializeOpenGLFunctions();
+    makeCurrent();
+    release_lod_buffers_();
+    release_feature_buffers_();
+    doneCurrent();
+  }
+  if (uploader_) {
+    is_uploading_ = true;
+    const ModelBuffers &back = buffers_[1 - front_buffers_];
+    uploader_->Upload(GlUploader::Request{upload_generation_, back.vbo,
+                                          back.ebo, vertices_, edges_});
+  } else if (context()) {
+    makeCurrent();
+    upload_model_buffers_();
+    doneCurrent();
+  }
+}
+
+bool GLWidget::IsUploading() const { return is_uploading_; }
+
+/**
+ * @brief Загрузка vertices_ и edges_ в задние буферы в потоке gui и замена
+ * ими передних. Вызывается при активном контексте.
+ */
+void GLWidget::upload_model_buffers_() {
+  initializeOpenGLFunctions();
+  ModelBuffers &back = buffers_[1 - front_buffers_];
 
-    // связываем данные о модели с буферами
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, vertices_.size() * sizeof(float),
-                 vertices_.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  // связываем данные о модели с буферами
+  glBindBuffer(GL_ARRAY_BUFFER, back.vbo);
+  glBufferData(GL_ARRAY_BUFFER, vertices_->size() * sizeof(float),
+               vertices_->data(), GL_STATIC_DRAW);
+  glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &back.vertex_bytes);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, edges_.size() * sizeof(unsigned int),
-                 edges_.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, back.ebo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, edges_->size() * sizeof(unsigned int),
+               edges_->data(), GL_STATIC_DRAW);
+  glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE,
+                         &back.index_bytes);
+  swap_model_buffers_();
+}
+
+/**
+ * @brief Задние буферы (уже загруженные) становятся передними. Память
+ * прежних передних буферов в видеопамяти освобождается, сами буферы остаются
+ * для следующей загрузки. Вызывается при активном контексте.
+ */
+void GLWidget::swap_model_buffers_() {
+  ModelBuffers &back = buffers_[1 - front_buffers_];
+  back.vertices_count = static_cast<GLsizei>(vertices_->size() / 3);
+  back.indices_count = static_cast<GLsizei>(edges_->size());
+  back.clusters = clusters_;
+
+  front_buffers_ = 1 - front_buffers_;
+  front_generation_ = upload_generation_;
+  ModelBuffers &old = buffers_[1 - front_buffers_];
+  glBindBuffer(GL_ARRAY_BUFFER, old.vbo);
+  glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, old.ebo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+  old = ModelBuffers{old.vbo, old.ebo, 0, 0, 0, 0, nullptr};
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief Фоновая загрузка закончилась (поток gui). Результат применяется,
+ * только если после нее не было новой модели.
+ */
+void GLWidget::model_buffers_uploaded_(size_t generation, GLint vertex_bytes,
+                                       GLint index_bytes) {
+  if (generation == upload_generation_) {
+    TraceScope trace("GLWidget::model_buffers_uploaded_", "gl");
+    ModelBuffers &back = buffers_[1 - front_buffers_];
+    back.vertex_bytes = vertex_bytes;
+    back.index_bytes = index_bytes;
+    makeCurrent();
+    swap_model_buffers_();
+    doneCurrent();
+    is_uploading_ = false;
+    update();
   }
 }
 
+/**
+ * @brief Фоновая загрузка не удалась (например, драйвер не дождался fence):
+ * буферы загружаются в потоке gui, а загрузчик больше не используется
+ */
+void GLWidget::model_buffers_upload_failed_(size_t generation) {
+  if (generation == upload_generation_) {
+    qDebug() << "GLWidget: background buffer upload failed, uploading on the "
+                "gui thread";
+    uploader_.reset();
+    makeCurrent();
+    upload_model_buffers_();
+    doneCurrent();
+    is_uploading_ = false;
+    update();
+  }
+}
+
+/**
+ * @brief Уровни детализации текущей модели (см. MeshLod). Уровни относятся к
+ * последней переданной модели и рисуются, только когда она уже загружена в
+ * передние буферы. Уровни небольшие, поэтому загружаются в потоке gui.
+ */
+void GLWidget::SetLodLevels(std::shared_ptr<const MeshLod> lod) {
+  lod_ = std::move(lod);
+  lod_generation_ = upload_generation_;
+  if (context()) {
+    makeCurrent();
+    upload_lod_buffers_();
+    doneCurrent();
+  }
+  update();
+}
+
+/**
+ * @return уровень, нарисованный в последнем кадре, -1 - полная модель
+ */
+int GLWidget::GetDrawnLevel() const { return drawn_level_; }
+
+size_t GLWidget::GetDrawnEdgesCount() const { return drawn_edges_; }
+
+/**
+ * @return участков полной модели, видимых в последнем кадре (0, если
+ * рисовался уровень детализации или у модели нет участков)
+ */
+size_t GLWidget::GetVisibleClustersCount() const {
+  return drawn_level_ < 0 && buffers_[front_buffers_].clusters
+             ? visible_clusters_.size()
+             : 0;
+}
+
+/**
+ * @brief Начало и конец анимации преобразований (таймеры MainWindow). Пока
+ * анимация идет, модель рисуется упрощенной по бюджету кадра, после
+ * окончания сразу перерисовывается полностью, без ожидания idle_delay_ms_.
+ */
+void GLWidget::SetAnimating(bool is_animating) {
+  if (is_animating != is_animating_) {
+    is_animating_ = is_animating;
+    frame_timer_.invalidate();
+    if (is_animating_) {
+      quality_.RestartScale();
+    } else {
+      is_interacting_ = false;
+      idle_timer_->stop();
+      update();
+    }
+  }
+}
+
+bool GLWidget::IsAnimating() const { return is_animating_; }
+
+void GLWidget::upload_lod_buffers_() {
+  TraceScope trace("GLWidget::upload_lod_buffers_", "gl");
+  initializeOpenGLFunctions();
+  release_lod_buffers_();
+  for (size_t i = 0; lod_ && i < lod_->GetLevels().size(); ++i) {
+    const LodLevel &level = lod_->GetLevels()[i];
+    ModelBuffers buffers;
+    glGenBuffers(1, &buffers.vbo);
+    glGenBuffers(1, &buffers.ebo);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.vbo);
+    glBufferData(GL_ARRAY_BUFFER, level.vertices.size() * sizeof(float),
+                 level.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 level.edges.size() * sizeof(unsigned int),
+                 level.edges.data(), GL_STATIC_DRAW);
+    buffers.vertices_count = static_cast<GLsizei>(level.vertices.size() / 3);
+    buffers.indices_count = static_cast<GLsizei>(level.edges.size());
+    buffers.vertex_bytes =
+        static_cast<GLint>(level.vertices.size() * sizeof(float));
+    buffers.index_bytes =
+        static_cast<GLint>(level.edges.size() * sizeof(unsigned int));
+    lod_buffers_.push_back(buffers);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void GLWidget::release_lod_buffers_() {
+  for (const auto &buffers : lod_buffers_) {
+    glDeleteBuffers(1, &buffers.vbo);
+    glDeleteBuffers(1, &buffers.ebo);
+  }
+  lod_buffers_.clear();
+}
+
+/**
+ * @brief Характерные ребра текущей модели (см. FeatureEdges). Как и уровни
+ * детализации, рисуются, только когда модель уже в передних буферах.
+ */
+void GLWidget::SetFeatureEdges(std::shared_ptr<const FeatureEdges> features) {
+  features_ = std::move(features);
+  features_generation_ = upload_generation_;
+  is_silhouette_dirty_ = true;
+  if (context()) {
+    makeCurrent();
+    upload_feature_buffers_();
+    doneCurrent();
+  }
+  update();
+}
+
+void GLWidget::SetFeatureEdgesMode(bool enabled) {
+  is_feature_mode_ = enabled;
+  update();
+}
+
+/**
+ * @return true - кадр рисуется из характерных ребер: режим включен и ребра
+ * для показанной модели уже построены
+ */
+bool GLWidget::IsFeatureEdgesShown() const {
+  return is_feature_mode_ && features_ && feature_ebo_ &&
+         features_generation_ == front_generation_;
+}
+
+void GLWidget::upload_feature_buffers_() {
+  TraceScope trace("GLWidget::upload_feature_buffers_", "gl");
+  initializeOpenGLFunctions();
+  if (!feature_ebo_) {
+    glGenBuffers(1, &feature_ebo_);
+    glGenBuffers(1, &silhouette_ebo_);
+  }
+  const std::vector<unsigned int> &edges = features_->GetFeatureEdges();
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, feature_ebo_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, edges.size() * sizeof(unsigned int),
+               edges.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  feature_indices_count_ = static_cast<GLsizei>(edges.size());
+}
+
+void GLWidget::release_feature_buffers_() {
+  if (feature_ebo_) {
+    glDeleteBuffers(1, &feature_ebo_);
+    glDeleteBuffers(1, &silhouette_ebo_);
+    feature_ebo_ = silhouette_ebo_ = 0;
+    feature_indices_count_ = 0;
+  }
+}
+
+/**
+ * @brief Отрисовка характерных ребер и контура. Контур считается заново,
+ * только если после прошлого кадра менялась матрица MVP, и загружается в
+ * silhouette_ebo_ целиком (GL_STREAM_DRAW).
+ * @return количество нарисованных ребер
+ */
+size_t GLWidget::draw_feature_edges_() {
+  if (is_silhouette_dirty_) {
+    features_->Silhouette(mvp_matrix_, silhouette_edges_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, silhouette_ebo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 silhouette_edges_.size() * sizeof(unsigned int),
+                 silhouette_edges_.data(), GL_STREAM_DRAW);
+    is_silhouette_dirty_ = false;
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, feature_ebo_);
+  glDrawElements(GL_LINES, feature_indices_count_, GL_UNSIGNED_INT, nullptr);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, silhouette_ebo_);
+  glDrawElements(GL_LINES, static_cast<GLsizei>(silhouette_edges_.size()),
+                 GL_UNSIGNED_INT, nullptr);
+  drawn_level_ = -1;
+  return (static_cast<size_t>(feature_indices_count_) +
+          silhouette_edges_.size()) /
+         2;
+}
+
+/**
+ * @brief Выбор буферов для кадра. Уровень детализации берется самый грубый
+ * из двух: по размеру модели на экране (упрощение меньше пикселя не видно) и,
+ * во время вращения или анимации, по бюджету ребер кадра.
+ */
+GLWidget::ModelBuffers GLWidget::select_buffers_() {
+  int level = -1;
+  if (lod_ && lod_generation_ == front_generation_ && !lod_buffers_.empty() &&
+      !is_full_detail_forced_) {
+    qreal ratio = devicePixelRatio();
+    level = lod_->SelectByScreenSize(MeshLod::ScreenExtent(
+        mvp_matrix_, lod_->GetBox(), static_cast<int>(width() * ratio),
+        static_cast<int>(height() * ratio)));
+    level = std::max(level, lod_->SelectByBudget(frame_edges_budget_()));
+  }
+  drawn_level_ = level;
+  return level < 0 ? buffers_[front_buffers_]
+                   : lod_buffers_[static_cast<size_t>(level)];
+}
+
+/**
+ * @brief Бюджет ребер кадра (см. InteractionQuality). Когда анимация
+ * закончилась или модель не двигается idle_delay_ms_, бюджет снимается.
+ */
+size_t GLWidget::frame_edges_budget_() const {
+  return (is_interacting_ || is_animating_) && !is_full_detail_forced_
+             ? quality_.GetEdgesBudget()
+             : std::numeric_limits<size_t>::max();
+}
+
+/**
+ * @brief Отрисовка ребер из привязанного EBO. Если у буферов есть участки
+ * (EdgeClusters), рисуются только участки, видимые с текущей матрицей MVP,
+ * одним glMultiDrawElements, соседние участки сливаются в один диапазон. Если
+ * видимых ребер больше бюджета, от каждого участка рисуется одинаковая доля
+ * его начала, а без участков - начало всего буфера: ребра переставлены так,
+ * что начало - равномерная выборка (см. InteractionQuality::StrideOrder).
+ * @return количество нарисованных ребер
+ */
+size_t GLWidget::draw_edges_(const ModelBuffers &buffers,
+                             size_t edges_budget) {
+  size_t result = 0;
+  if (buffers.clusters) {
+    const std::vector<EdgeCluster> &clusters =
+        buffers.clusters->GetClusters();
+    buffers.clusters->Cull(mvp_matrix_, visible_clusters_);
+    size_t visible_edges = 0;
+    for (size_t index : visible_clusters_) {
+      visible_edges += clusters[index].edges_count;
+    }
+    double fraction = 1.0;
+    if (visible_edges > edges_budget) {
+      fraction = static_cast<double>(std::max(edges_budget, min_proxy_edges_)) /
+                 static_cast<double>(visible_edges);
+    }
+    draw_counts_.clear();
+    draw_offsets_.clear();
+    size_t range_end = std::numeric_limits<size_t>::max();
+    for (size_t index : visible_clusters_) {
+      const EdgeCluster &cluster = clusters[index];
+      size_t edges = std::min(
+          cluster.edges_count,
+          static_cast<size_t>(std::ceil(cluster.edges_count * fraction)));
+      if (edges == cluster.edges_count && cluster.first_edge == range_end) {
+        draw_counts_.back() += static_cast<GLsizei>(edges * 2);
+      } else {
+        draw_counts_.push_back(static_cast<GLsizei>(edges * 2));
+        draw_offsets_.push_back(reinterpret_cast<const void *>(
+            cluster.first_edge * 2 * sizeof(unsigned int)));
+      }
+      range_end = edges == cluster.edges_count
+                      ? cluster.first_edge + cluster.edges_count
+                      : std::numeric_limits<size_t>::max();
+      result += edges;
+    }
+    if (!draw_counts_.empty()) {
+      glMultiDrawElements(GL_LINES, draw_counts_.data(), GL_UNSIGNED_INT,
+                          draw_offsets_.data(),
+                          static_cast<GLsizei>(draw_counts_.size()));
+    }
+  } else {
+    size_t edges = static_cast<size_t>(buffers.indices_count) / 2;
+    if (edges > edges_budget) {
+      edges = std::min(edges, std::max(edges_budget, min_proxy_edges_));
+    }
+    glDrawElements(GL_LINES, static_cast<GLsizei>(edges * 2),
+                   GL_UNSIGNED_INT, nullptr);
+    result = edges;
+  }
+  return result;
+}
+
+/**
+ * @brief Начало замера времени отрисовки. Заодно забирается результат
+ * прошлого кадра, если видеокарта его уже посчитала (не ждем его).
+ */
+void GLWidget::begin_draw_timing_() {
+  if (has_timer_query_) {
+    size_t previous = 1 - query_index_;
+    GLuint available = 0;
+    if (query_edges_[previous] > 0) {
+      glGetQueryObjectuiv(draw_queries_[previous], GL_QUERY_RESULT_AVAILABLE,
+                          &available);
+    }
+    if (available) {
+      GLuint elapsed_ns = 0;
+      glGetQueryObjectuiv(draw_queries_[previous], GL_QUERY_RESULT,
+                          &elapsed_ns);
+      quality_.AddDrawSample(query_edges_[previous], elapsed_ns / 1e6);
+      query_edges_[previous] = 0;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, draw_queries_[query_index_]);
+  }
+}
+
+void GLWidget::end_draw_timing_(size_t edges_count) {
+  if (has_timer_query_) {
+    glEndQuery(GL_TIME_ELAPSED);
+    query_edges_[query_index_] = edges_count;
+    query_index_ = 1 - query_index_;
+  }
+}
+
+/**
+ * @brief Интервал от прошлого кадра анимации: по нему бюджет уменьшается,
+ * если кадры не успевают за таймерами анимации, и считается скорость
+ * отрисовки, если запросов времени нет
+ */
+void GLWidget::add_frame_sample_() {
+  if (is_animating_ && !is_full_detail_forced_) {
+    if (frame_timer_.isValid()) {
+      quality_.AddFrameSample(drawn_edges_, frame_timer_.nsecsElapsed() / 1e6);
+    }
+    frame_timer_.start();
+  }
+}
+
+/**
+ * @brief Запись в stats размеров буферов модели в видеопамяти и их копий,
+ * которые виджет держит в памяти процесса
+ */
+void GLWidget::AccountMemory(MemoryStats &stats) const {
+  stats.Set(MemoryCategory::kGlShadowCopies,
+            MemoryStats::HeapBlockBytes(vertices_->capacity() *
+                                        sizeof(float)) +
+                MemoryStats::HeapBlockBytes(edges_->capacity() *
+                                            sizeof(unsigned int)));
+  size_t vertex_bytes = 0, index_bytes = 0;
+  for (const auto &buffers : buffers_) {
+    vertex_bytes += static_cast<size_t>(buffers.vertex_bytes);
+    index_bytes += static_cast<size_t>(buffers.index_bytes);
+  }
+  // характерные ребра и контур
+  index_bytes += (static_cast<size_t>(feature_indices_count_) +
+                  silhouette_edges_.size()) *
+                 sizeof(unsigned int);
+  stats.Set(MemoryCategory::kGlVertexBuffer, vertex_bytes);
+  stats.Set(MemoryCategory::kGlIndexBuffer, index_bytes);
+  size_t lod_bytes = 0;
+  for (const auto &buffers : lod_buffers_) {
+    lod_bytes += static_cast<size_t>(buffers.vertex_bytes) +
+                 static_cast<size_t>(buffers.index_bytes);
+  }
+  stats.Set(MemoryCategory::kLodLevels, lod_ ? lod_->GetBytes() : 0);
+  stats.Set(MemoryCategory::kGlLodBuffers, lod_bytes);
+  size_t cluster_bytes = 0;
+  for (const auto &buffers : buffers_) {
+    cluster_bytes += buffers.clusters ? buffers.clusters->GetBytes() : 0;
+  }
+  stats.Set(MemoryCategory::kEdgeClusters, cluster_bytes);
+  stats.Set(MemoryCategory::kFeatureEdges,
+            features_ ? features_->GetBytes() +
+                            MemoryStats::HeapBlockBytes(
+                                silhouette_edges_.capacity() *
+                                sizeof(unsigned int))
+                      : 0);
+}
+
 void GLWidget::SetMemento(GLWidgetMemento &memento) {
   line_color_ = memento.GetLineColor();
   back_color_ = memento.GetBackColor();
@@ -1142,13 +2093,43 @@ void GLWidget::initializeGL() {
                back_color_.w());
   glEnable(GL_DEPTH_TEST);
 
-  glGenBuffers(1, &vbo_);
-  glGenBuffers(1, &ebo_);
+  for (auto &buffers : buffers_) {
+    glGenBuffers(1, &buffers.vbo);
+    glGenBuffers(1, &buffers.ebo);
+  }
 
   setup_shaders_();
+  // модель и уровни, переданные до создания контекста
+  if (!vertices_->empty()) {
+    upload_model_buffers_();
+  }
+  if (lod_) {
+    upload_lod_buffers_();
+  }
+  if (features_) {
+    upload_feature_buffers_();
+  }
+  has_timer_query_ =
+      context()->format().version() >= qMakePair(3, 3) ||
+      context()->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"));
+  if (has_timer_query_) {
+    glGenQueries(static_cast<GLsizei>(draw_queries_.size()),
+                 draw_queries_.data());
+  }
+
+  uploader_ = std::make_unique<GlUploader>(context());
+  if (uploader_->IsValid()) {
+    connect(uploader_.get(), &GlUploader::Uploaded, this,
+            &GLWidget::model_buffers_uploaded_);
+    connect(uploader_.get(), &GlUploader::UploadFailed, this,
+            &GLWidget::model_buffers_upload_failed_);
+  } else {
+    uploader_.reset();
+  }
 }
 
 void GLWidget::paintGL() {
+  TraceScope trace("GLWidget::paintGL", "gl");
   glClearColor(back_color_.x(), back_color_.y(), back_color_.z(),
                back_color_.w());
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1185,12 +2166,21 @@ void GLWidget::paintGL() {
     glLineStipple(stipple_factor_, stipple_pattern_);
   }
 
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  add_frame_sample_();
+  const bool is_feature_view = IsFeatureEdgesShown();
+  const ModelBuffers front =
+      is_feature_view ? buffers_[front_buffers_] : select_buffers_();
+  begin_draw_timing_();
+  glBindBuffer(GL_ARRAY_BUFFER, front.vbo);
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-  glDrawElements(GL_LINES, edges_.size(), GL_UNSIGNED_INT, nullptr);
+  if (is_feature_view) {
+    drawn_edges_ = draw_feature_edges_();
+  } else {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, front.ebo);
+    drawn_edges_ = draw_edges_(front, frame_edges_budget_());
+  }
 
   if (show_point_vertex_) {
     glPointSize(point_vertex_size_);
@@ -1204,8 +2194,9 @@ void GLWidget::paintGL() {
           show_point_vertex_location_,
           1);  // это типа передается в шейдер, и даем знать, что рисуем вершину
     }
-    glDrawArrays(GL_POINTS, 0, vertices_.size() / 3);
+    glDrawArrays(GL_POINTS, 0, front.vertices_count);
   }
+  end_draw_timing_(drawn_edges_);
 
   glDisableVertexAttribArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1215,6 +2206,182 @@ void GLWidget::paintGL() {
 
 void GLWidget::resizeGL(int w, int h) { glViewport(0, 0, w, h); }
 
+/**
+ * @brief То же, что RenderToImage(), но с заданной матрицей MVP (например, для
+ * одной плитки большого скриншота). Матрица уже должна учитывать соотношение
+ * сторон кадра. Текущая матрица после отрисовки восстанавливается.
+ */
+QImage GLWidget::RenderToImage(int frame_width, int frame_height,
+                               const S21MatrixWrapper &mvp) {
+  S21MatrixWrapper current_mvp = mvp_matrix_;
+  mvp_matrix_ = mvp;
+  is_silhouette_dirty_ = true;
+  QImage image = render_offscreen_(frame_width, frame_height);
+  mvp_matrix_ = current_mvp;
+  is_silhouette_dirty_ = true;
+  return image;
+}
+
+/**
+ * @brief Отрисовка текущего состояния сцены во внеэкранный буфер заданного
+ * размера без вывода на экран. Проекция текущей MVP перестраивается под
+ * соотношение сторон кадра, поэтому изображение не растягивается.
+ * @return кадр, пустой QImage, если контекст OpenGL еще не создан
+ */
+QImage GLWidget::RenderToImage(int frame_width, int frame_height) {
+  AffineTransDecorator projection(std::make_unique<S21MatrixWrapper>(4, 4));
+  return RenderToImage(
+      frame_width, frame_height,
+      projection.CreateProjMatrixAspect(
+          mvp_matrix_.GetMatrix(), kProjectionAspect,
+          static_cast<double>(frame_width) / frame_height));
+}
+
+/**
+ * @brief Отрисовка во внеэкранный буфер с текущей mvp_matrix_. Буфер
+ * переиспользуется между вызовами, пока не поменяется размер.
+ */
+QImage GLWidget::render_offscreen_(int frame_width, int frame_height) {
+  QImage image;
+  if (context()) {
+    makeCurrent();
+    if (!offscreen_fbo_ ||
+        offscreen_fbo_->size() != QSize(frame_width, frame_height)) {
+      offscreen_fbo_ = std::make_unique<QOpenGLFramebufferObject>(
+          frame_width, frame_height, QOpenGLFramebufferObject::Depth);
+    }
+    offscreen_fbo_->bind();
+    glViewport(0, 0, frame_width, frame_height);
+    is_full_detail_forced_ = true;
+    paintGL();
+    is_full_detail_forced_ = false;
+    image = offscreen_fbo_->toImage();
+    offscreen_fbo_->release();
+    qreal ratio = devicePixelRatio();
+    glViewport(0, 0, static_cast<int>(width() * ratio),
+               static_cast<int>(height() * ratio));
+    doneCurrent();
+  }
+  return image;
+}
+
+/**
+ * @brief Асинхронный захват текущего изображения виджета. Копирование
+ * кадра ставится в очередь в свободный PBO, а кадр, захваченный capture_lag_
+ * вызовов назад, отображается в память и возвращается через ready_frame.
+ * Работает и на программной реализации OpenGL (Mesa llvmpipe).
+ * @return true - в ready_frame записан готовый кадр
+ */
+bool GLWidget::CaptureFrameAsync(QImage &ready_frame) {
+  bool has_frame = false;
+  if (context()) {
+    makeCurrent();
+    qreal ratio = devicePixelRatio();
+    int frame_width = static_cast<int>(width() * ratio);
+    int frame_height = static_cast<int>(height() * ratio);
+    if (capture_pbos_.empty() || frame_width != capture_width_ ||
+        frame_height != capture_height_) {
+      // кадры старого размера теряются, если окно изменили во время записи
+      setup_capture_pbos_(frame_width, frame_height);
+    }
+    // makeCurrent() привязывает framebuffer виджета, читаем из него
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture_pbos_[capture_next_]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, capture_width_, capture_height_, GL_BGRA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture_next_ = (capture_next_ + 1) % capture_pbos_.size();
+    ++capture_pending_;
+    if (capture_pending_ > capture_lag_) {
+      has_frame = map_oldest_capture_(ready_frame);
+    }
+    doneCurrent();
+  }
+  return has_frame;
+}
+
+/**
+ * @brief Забирает все еще не прочитанные кадры (в порядке захвата) и
+ * освобождает PBO
+ */
+std::vector<QImage> GLWidget::FlushCaptures() {
+  std::vector<QImage> frames;
+  if (context() && !capture_pbos_.empty()) {
+    makeCurrent();
+    while (capture_pending_ > 0) {
+      QImage frame;
+      if (map_oldest_capture_(frame)) {
+        frames.push_back(std::move(frame));
+      }
+    }
+    release_capture_pbos_();
+    doneCurrent();
+  }
+  return frames;
+}
+
+/**
+ * @brief Перевод пикселей из glReadPixels (строки снизу вверх, порядок B, G,
+ * R, A) в QImage::Format_RGB32 (строки сверху вниз)
+ */
+QImage GLWidget::ImageFromReadback(const unsigned char *pixels, int width,
+                                   int height) {
+  QImage image(width, height, QImage::Format_RGB32);
+  const size_t row_bytes = static_cast<size_t>(width) * 4;
+  for (int y = 0; y < height; ++y) {
+    std::memcpy(image.scanLine(y), pixels + (height - 1 - y) * row_bytes,
+                row_bytes);
+  }
+  return image;
+}
+
+void GLWidget::setup_capture_pbos_(int frame_width, int frame_height) {
+  release_capture_pbos_();
+  capture_width_ = frame_width;
+  capture_height_ = frame_height;
+  capture_pbos_.assign(capture_lag_ + 1, 0);
+  glGenBuffers(static_cast<GLsizei>(capture_pbos_.size()),
+               capture_pbos_.data());
+  const GLsizeiptr frame_bytes =
+      static_cast<GLsizeiptr>(frame_width) * frame_height * 4;
+  for (GLuint pbo : capture_pbos_) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, frame_bytes, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void GLWidget::release_capture_pbos_() {
+  if (!capture_pbos_.empty()) {
+    glDeleteBuffers(static_cast<GLsizei>(capture_pbos_.size()),
+                    capture_pbos_.data());
+    capture_pbos_.clear();
+  }
+  capture_next_ = 0;
+  capture_pending_ = 0;
+}
+
+bool GLWidget::map_oldest_capture_(QImage &frame) {
+  size_t oldest = (capture_next_ + capture_pbos_.size() - capture_pending_) %
+                  capture_pbos_.size();
+  --capture_pending_;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, capture_pbos_[oldest]);
+  const GLsizeiptr frame_bytes =
+      static_cast<GLsizeiptr>(capture_width_) * capture_height_ * 4;
+  const auto *pixels = static_cast<const unsigned char *>(glMapBufferRange(
+      GL_PIXEL_PACK_BUFFER, 0, frame_bytes, GL_MAP_READ_BIT));
+  bool result = pixels != nullptr;
+  if (result) {
+    frame = ImageFromReadback(pixels, capture_width_, capture_height_);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  } else {
+    qDebug() << "GLWidget::map_oldest_capture_(): failed to map PBO, frame "
+                "skipped";
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return result;
+}
+
 void GLWidget::setup_shaders_() {
   const char *vertex_shader_src = R"(
     #version 130
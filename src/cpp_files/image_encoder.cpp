@@ -0,0 +1,122 @@
+#include "../include/image_encoder.h"
+
+namespace s21 {
+
+ImageEncodingService::ImageEncodingService(size_t max_queue_size,
+                                           size_t workers_count)
+    : max_queue_size_(max_queue_size) {
+  if (max_queue_size_ == 0 || workers_count == 0) {
+    throw std::invalid_argument(
+        "ImageEncodingService::ImageEncodingService(): queue size and workers "
+        "count cannot be 0!");
+  }
+  workers_.reserve(workers_count);
+  for (size_t i = 0; i < workers_count; ++i) {
+    workers_.emplace_back(&ImageEncodingService::worker_loop_, this);
+  }
+}
+
+ImageEncodingService::~ImageEncodingService() { Stop(); }
+
+/**
+ * @brief Постановка изображения в очередь на запись
+ * @return false - очередь заполнена или сервис остановлен, кадр отброшен
+ */
+bool ImageEncodingService::Submit(QImage image, const QString &path,
+                                  const std::string &format, int quality) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool result = false;
+  if (stopped_ || queue_.size() >= max_queue_size_) {
+    ++dropped_;
+  } else {
+    queue_.push_back({std::move(image), path, format, quality});
+    max_queue_depth_ = std::max(max_queue_depth_, queue_.size());
+    result = true;
+    not_empty_.notify_one();
+  }
+  return result;
+}
+
+/**
+ * @brief Ожидание, пока все поставленные в очередь изображения не будут
+ * записаны (например, перед чтением кадров gif с диска)
+ */
+void ImageEncodingService::WaitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return queue_.empty() && in_progress_ == 0; });
+}
+
+/**
+ * @brief Остановка рабочих потоков. Задания, уже стоящие в очереди,
+ * дописываются, новые отбрасываются.
+ */
+void ImageEncodingService::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    not_empty_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+size_t ImageEncodingService::GetQueueDepth() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+size_t ImageEncodingService::GetMaxQueueDepth() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_queue_depth_;
+}
+
+size_t ImageEncodingService::GetEncodedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return encoded_;
+}
+
+size_t ImageEncodingService::GetDroppedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+size_t ImageEncodingService::GetFailedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return failed_;
+}
+
+void ImageEncodingService::worker_loop_() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    not_empty_.wait(lock, [this] { return !queue_.empty() || stopped_; });
+    if (queue_.empty()) {
+      break;  // сервис остановлен и очередь разобрана
+    }
+    EncodeJob job = std::move(queue_.front());
+    queue_.pop_front();
+    ++in_progress_;
+    lock.unlock();
+
+    // QImage (в отличие от QPixmap) можно сохранять из любого потока
+    bool saved = job.image.save(job.path, job.format.c_str(), job.quality);
+    if (!saved) {
+      qDebug() << "ImageEncodingService: failed to save" << job.path;
+    }
+
+    lock.lock();
+    --in_progress_;
+    if (saved) {
+      ++encoded_;
+    } else {
+      ++failed_;
+    }
+    if (queue_.empty() && in_progress_ == 0) {
+      idle_.notify_all();
+    }
+  }
+}
+
+}  // namespace s21
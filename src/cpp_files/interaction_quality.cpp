@@ -0,0 +1,99 @@
+#include "../include/interaction_quality.h"
+
+namespace s21 {
+
+InteractionQuality::InteractionQuality(double frame_budget_ms)
+    : frame_budget_ms_(frame_budget_ms) {}
+
+void InteractionQuality::SetFrameBudget(double frame_budget_ms) {
+  frame_budget_ms_ = frame_budget_ms;
+}
+
+double InteractionQuality::GetFrameBudget() const { return frame_budget_ms_; }
+
+/**
+ * @brief Замер времени отрисовки edges_count ребер на видеокарте
+ * (GL_TIME_ELAPSED). После первого такого замера скорость по интервалам между
+ * кадрами больше не учитывается.
+ */
+void InteractionQuality::AddDrawSample(size_t edges_count, double draw_ms) {
+  if (edges_count > 0) {
+    draw_ms = std::max(draw_ms, 1e-3);
+    add_rate_(edges_count / draw_ms);
+    has_draw_samples_ = true;
+    last_draw_ms_ = draw_ms;
+  }
+}
+
+/**
+ * @brief Интервал между соседними кадрами анимации, в последнем из которых
+ * нарисовано edges_count ребер
+ */
+void InteractionQuality::AddFrameSample(size_t edges_count, double frame_ms) {
+  if (!has_draw_samples_ && edges_count > 0) {
+    add_rate_(edges_count / std::max(frame_ms, 1e-3));
+  }
+  if (frame_ms > frame_budget_ms_ * 1.1) {
+    scale_ = std::max(kMinScale,
+                      scale_ * std::max(0.5, frame_budget_ms_ / frame_ms));
+  } else if (last_draw_ms_ >= 0 && last_draw_ms_ < frame_budget_ms_ * 0.5) {
+    scale_ = std::min(1.0, scale_ * 1.1);
+  }
+}
+
+/**
+ * @brief Новая анимация начинается с полной поправки: накладные расходы
+ * прошлой анимации могли быть другими
+ */
+void InteractionQuality::RestartScale() { scale_ = 1.0; }
+
+/**
+ * @return сколько ребер рисовать в кадре, SIZE_MAX - скорость еще не измерена
+ */
+size_t InteractionQuality::GetEdgesBudget() const {
+  return edges_per_ms_ > 0
+             ? static_cast<size_t>(edges_per_ms_ * frame_budget_ms_ * scale_)
+             : std::numeric_limits<size_t>::max();
+}
+
+double InteractionQuality::GetEdgesPerMs() const { return edges_per_ms_; }
+
+double InteractionQuality::GetScale() const { return scale_; }
+
+/**
+ * @brief Перестановка ребер (пар индексов), после которой любое начало
+ * массива - равномерная выборка: сначала идет каждое p-е ребро (p - наибольшая
+ * степень двойки, не больше количества ребер), затем ребра между ними с шагом
+ * p/2 и так далее до шага 1. Упрощенный каркас рисуется одним
+ * glDrawElements по началу буфера.
+ */
+std::vector<unsigned int> InteractionQuality::StrideOrder(
+    const std::vector<unsigned int> &edges) {
+  const size_t count = edges.size() / 2;
+  std::vector<unsigned int> result;
+  result.reserve(count * 2);
+  size_t stride = 1;
+  while (stride * 2 <= count) {
+    stride *= 2;
+  }
+  if (count > 0) {
+    result.push_back(edges[0]);
+    result.push_back(edges[1]);
+  }
+  // на шаге stride берутся ребра с номерами, кратными stride, но не 2*stride
+  for (; count > 0 && stride >= 1; stride /= 2) {
+    for (size_t i = stride; i < count; i += stride * 2) {
+      result.push_back(edges[i * 2]);
+      result.push_back(edges[i * 2 + 1]);
+    }
+  }
+  return result;
+}
+
+void InteractionQuality::add_rate_(double rate) {
+  edges_per_ms_ = edges_per_ms_ > 0
+                      ? (1.0 - kSmoothing) * edges_per_ms_ + kSmoothing * rate
+                      : rate;
+}
+
+}  // namespace s21
@@ -0,0 +1,166 @@
+#include "../include/job_system.h"
+
+namespace s21 {
+
+CancellationToken::CancellationToken()
+    : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+void CancellationToken::Cancel() { cancelled_->store(true); }
+
+bool CancellationToken::IsCancelled() const { return cancelled_->load(); }
+
+////////////////////////////////////////////////////////////////////////////////
+// реализация JobSystem
+
+/**
+ * @brief Сначала более высокий приоритет, при равном - раньше поставленная
+ */
+bool JobSystem::QueuedJobLess::operator()(const QueuedJob &first,
+                                          const QueuedJob &second) const {
+  bool result = first.priority < second.priority;
+  if (first.priority == second.priority) {
+    result = first.sequence > second.sequence;
+  }
+  return result;
+}
+
+JobSystem::JobSystem(size_t workers_count)
+    : dispatcher_(std::make_unique<QObject>()) {
+  if (workers_count == 0) {
+    throw std::invalid_argument(
+        "JobSystem::JobSystem(): workers count cannot be 0!");
+  }
+  running_tokens_.resize(workers_count);
+  workers_.reserve(workers_count);
+  for (size_t i = 0; i < workers_count; ++i) {
+    workers_.emplace_back(&JobSystem::worker_loop_, this, i);
+  }
+}
+
+JobSystem::~JobSystem() { Shutdown(); }
+
+/**
+ * @brief Постановка задачи в очередь
+ * @return токен для отмены задачи
+ */
+CancellationToken JobSystem::Submit(Job job, JobPriority priority,
+                                    QObject *receiver, Completion on_done) {
+  CancellationToken token;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopped_) {
+    token.Cancel();
+  } else {
+    queue_.push({std::move(job), std::move(on_done), QPointer<QObject>(receiver),
+                 receiver != nullptr, token, priority, next_sequence_++});
+    not_empty_.notify_one();
+  }
+  return token;
+}
+
+/**
+ * @brief Ожидание, пока очередь не опустеет и все запущенные задачи не
+ * завершатся
+ */
+void JobSystem::WaitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return queue_.empty() && running_ == 0; });
+}
+
+/**
+ * @brief Остановка пула: задачи из очереди отменяются без вызова
+ * обработчиков, запущенным задачам выставляется флаг отмены, и пул дожидается
+ * их завершения
+ */
+void JobSystem::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    while (!queue_.empty()) {
+      CancellationToken token = queue_.top().token;
+      token.Cancel();
+      queue_.pop();
+    }
+    for (auto &token : running_tokens_) {
+      token.Cancel();
+    }
+    not_empty_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+size_t JobSystem::GetWorkersCount() const { return workers_.size(); }
+
+size_t JobSystem::GetPendingCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+/**
+ * @brief Половина аппаратных потоков, но не меньше двух: долгая задача
+ * (построение LOD или сборка gif) не должна задерживать загрузку модели
+ */
+size_t JobSystem::DefaultWorkersCount() {
+  return std::max<size_t>(2, std::thread::hardware_concurrency() / 2);
+}
+
+void JobSystem::worker_loop_(size_t worker_index) {
+  Tracer::Instance().SetThreadName("worker " + std::to_string(worker_index));
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    not_empty_.wait(lock, [this] { return !queue_.empty() || stopped_; });
+    if (stopped_) {
+      break;
+    }
+    QueuedJob queued = queue_.top();
+    queue_.pop();
+    running_tokens_[worker_index] = queued.token;
+    ++running_;
+    lock.unlock();
+
+    if (!queued.token.IsCancelled()) {
+      TraceScope trace("JobSystem::job", "jobs");
+      try {
+        queued.job(queued.token);
+      } catch (std::exception &error) {
+        qDebug() << "JobSystem: job failed with exception:" << error.what();
+      }
+    }
+    finish_job_(queued);
+
+    lock.lock();
+    --running_;
+    if (queue_.empty() && running_ == 0) {
+      idle_.notify_all();
+    }
+  }
+}
+
+/**
+ * @brief Вызов обработчика завершения. Получатель может быть удален в потоке
+ * gui в любой момент, поэтому рабочий поток его не трогает: обработчик
+ * ставится в очередь dispatcher_, а QPointer проверяется уже в потоке gui.
+ */
+void JobSystem::finish_job_(QueuedJob &queued) {
+  if (queued.on_done) {
+    bool cancelled = queued.token.IsCancelled();
+    if (!queued.has_receiver) {
+      queued.on_done(cancelled);
+    } else {
+      QMetaObject::invokeMethod(
+          dispatcher_.get(),
+          [receiver = queued.receiver, on_done = std::move(queued.on_done),
+           cancelled]() {
+            if (receiver) {
+              on_done(cancelled);
+            }
+          },
+          Qt::QueuedConnection);
+    }
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,261 @@
+#include "../include/memory_stats.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace s21 {
+
+void MemoryStats::Set(MemoryCategory category, size_t bytes) {
+  bytes_.at(static_cast<size_t>(category)) = bytes;
+}
+
+size_t MemoryStats::Get(MemoryCategory category) const {
+  return bytes_.at(static_cast<size_t>(category));
+}
+
+void MemoryStats::SetPeakRss(size_t bytes) { peak_rss_ = bytes; }
+
+size_t MemoryStats::GetPeakRss() const { return peak_rss_; }
+
+void MemoryStats::SetCounter(const std::string &name, size_t value) {
+  auto same_name = [&name](const std::pair<std::string, size_t> &counter) {
+    return counter.first == name;
+  };
+  auto it = std::find_if(counters_.begin(), counters_.end(), same_name);
+  if (it == counters_.end()) {
+    counters_.emplace_back(name, value);
+  } else {
+    it->second = value;
+  }
+}
+
+/**
+ * @return значение счетчика, 0 - если счетчик не задан
+ */
+size_t MemoryStats::GetCounter(const std::string &name) const {
+  size_t result = 0;
+  for (const auto &[counter_name, value] : counters_) {
+    if (counter_name == name) {
+      result = value;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Память процесса под модель (все, кроме буферов видеокарты)
+ */
+size_t MemoryStats::GetCpuBytes() const {
+  return Get(MemoryCategory::kVertices) + Get(MemoryCategory::kFaces) +
+         Get(MemoryCategory::kEdges) + Get(MemoryCategory::kEdgesHashOverhead) +
+         Get(MemoryCategory::kGlShadowCopies) +
+         Get(MemoryCategory::kModelCache) + Get(MemoryCategory::kLodLevels) +
+         Get(MemoryCategory::kEdgeClusters) +
+         Get(MemoryCategory::kFeatureEdges) +
+         Get(MemoryCategory::kMeshAdjacency);
+}
+
+size_t MemoryStats::GetGpuBytes() const {
+  return Get(MemoryCategory::kGlVertexBuffer) +
+         Get(MemoryCategory::kGlIndexBuffer) +
+         Get(MemoryCategory::kGlLodBuffers);
+}
+
+/**
+ * @brief Одна строка для панели информации о модели
+ */
+QString MemoryStats::Summary() const {
+  return QString("Memory: CPU %1, GPU %2, peak RSS %3")
+      .arg(FormatBytes(GetCpuBytes()), FormatBytes(GetGpuBytes()),
+           FormatBytes(peak_rss_));
+}
+
+/**
+ * @brief Подробная разбивка по категориям (по строке на категорию)
+ */
+QString MemoryStats::Details() const {
+  QString details;
+  for (size_t i = 0; i < bytes_.size(); ++i) {
+    auto category = static_cast<MemoryCategory>(i);
+    details += QString("%1: %2\n").arg(CategoryName(category),
+                                       FormatBytes(bytes_[i]));
+  }
+  details += "peak RSS: " + FormatBytes(peak_rss_);
+  for (const auto &[name, value] : counters_) {
+    details += QString("\n%1: %2").arg(QString::fromStdString(name),
+                                       QString::number(value));
+  }
+  return details;
+}
+
+QJsonObject MemoryStats::ToJson() const {
+  QJsonObject json;
+  for (size_t i = 0; i < bytes_.size(); ++i) {
+    json[CategoryName(static_cast<MemoryCategory>(i))] =
+        static_cast<qint64>(bytes_[i]);
+  }
+  json["cpu_total"] = static_cast<qint64>(GetCpuBytes());
+  json["gpu_total"] = static_cast<qint64>(GetGpuBytes());
+  json["peak_rss"] = static_cast<qint64>(peak_rss_);
+  for (const auto &[name, value] : counters_) {
+    json[QString::fromStdString(name)] = static_cast<qint64>(value);
+  }
+  return json;
+}
+
+const char *MemoryStats::CategoryName(MemoryCategory category) {
+  const char *name = "unknown";
+  switch (category) {
+    case MemoryCategory::kVertices:
+      name = "vertices";
+      break;
+    case MemoryCategory::kFaces:
+      name = "faces";
+      break;
+    case MemoryCategory::kEdges:
+      name = "edges";
+      break;
+    case MemoryCategory::kEdgesHashOverhead:
+      name = "edges_hash_overhead";
+      break;
+    case MemoryCategory::kGlShadowCopies:
+      name = "gl_shadow_copies";
+      break;
+    case MemoryCategory::kGlVertexBuffer:
+      name = "gl_vertex_buffer";
+      break;
+    case MemoryCategory::kGlIndexBuffer:
+      name = "gl_index_buffer";
+      break;
+    case MemoryCategory::kModelCache:
+      name = "model_cache";
+      break;
+    case MemoryCategory::kLodLevels:
+      name = "lod_levels";
+      break;
+    case MemoryCategory::kGlLodBuffers:
+      name = "gl_lod_buffers";
+      break;
+    case MemoryCategory::kEdgeClusters:
+      name = "edge_clusters";
+      break;
+    case MemoryCategory::kFeatureEdges:
+      name = "feature_edges";
+      break;
+    case MemoryCategory::kMeshAdjacency:
+      name = "mesh_adjacency";
+      break;
+    case MemoryCategory::kCount:
+      break;
+  }
+  return name;
+}
+
+QString MemoryStats::FormatBytes(size_t bytes) {
+  QString result = QString("%1 B").arg(bytes);
+  if (bytes >= 1024ull * 1024 * 1024) {
+    result = QString::number(bytes / (1024.0 * 1024 * 1024), 'f', 2) + " GB";
+  } else if (bytes >= 1024 * 1024) {
+    result = QString::number(bytes / (1024.0 * 1024), 'f', 1) + " MB";
+  } else if (bytes >= 1024) {
+    result = QString::number(bytes / 1024.0, 'f', 1) + " KB";
+  }
+  return result;
+}
+
+/**
+ * @brief Сколько на самом деле занимает блок malloc с payload байтами данных:
+ * 8 байт заголовка, выравнивание на 16, не меньше 32 байт
+ */
+size_t MemoryStats::HeapBlockBytes(size_t payload) {
+  size_t result = 0;
+  if (payload > 0) {
+    result = std::max<size_t>(32, (payload + 8 + 15) & ~size_t{15});
+  }
+  return result;
+}
+
+/**
+ * @brief Накладные расходы std::unordered_set сверх самих элементов: узел на
+ * каждый элемент (указатель на следующий, значение, сохраненный хэш) и массив
+ * корзин
+ */
+size_t MemoryStats::HashSetOverheadBytes(size_t elements, size_t buckets,
+                                         size_t value_size) {
+  size_t node_size = sizeof(void *) + value_size + sizeof(size_t);
+  return elements * (HeapBlockBytes(node_size) - value_size) +
+         HeapBlockBytes(buckets * sizeof(void *));
+}
+
+/**
+ * @brief Пиковый RSS процесса (на Linux ru_maxrss в килобайтах)
+ */
+size_t MemoryStats::PeakRssBytes() {
+  struct rusage usage;
+  size_t result = 0;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    result = static_cast<size_t>(usage.ru_maxrss) * 1024;
+  }
+  return result;
+}
+
+/**
+ * @brief Доступная память (MemAvailable из /proc/meminfo, без него -
+ * свободные физические страницы)
+ * @return 0, если узнать не удалось
+ */
+size_t MemoryStats::AvailableRamBytes() {
+  size_t result = 0;
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  size_t value = 0;
+  std::string unit;
+  while (result == 0 && meminfo >> key >> value >> unit) {
+    if (key == "MemAvailable:") {
+      result = value * 1024;
+    }
+  }
+  if (result == 0) {
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0) {
+      result = static_cast<size_t>(pages) * static_cast<size_t>(page_size);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Оценка пикового потребления памяти при загрузке .obj файла.
+ * @details Грань вместе со своей долей вершин занимает в файле около 40 байт,
+ * а в памяти около 300: индексы в загрузчике и в Model3D, полторы пары ребер
+ * в двух unordered_set, буферы для OpenGL и их копии. Отсюда примерно
+ * kLoadBytesPerFileByte байт на байт файла.
+ */
+size_t MemoryStats::PredictLoadBytes(qint64 file_size) {
+  return static_cast<size_t>(std::max<qint64>(file_size, 0)) *
+         kLoadBytesPerFileByte;
+}
+
+/**
+ * @brief Оценка памяти одной копии разобранной модели (вершины, грани и
+ * множество ребер, без буферов OpenGL): около 130 байт на грань
+ */
+size_t MemoryStats::PredictMeshBytes(qint64 file_size) {
+  return static_cast<size_t>(std::max<qint64>(file_size, 0)) *
+         kMeshBytesPerFileByte;
+}
+
+/**
+ * @brief Проверка перед загрузкой: поместится ли модель в доступную память
+ * @return true - по оценке памяти не хватит (если доступную память узнать не
+ * удалось, false)
+ */
+bool MemoryStats::IsLoadTooLarge(qint64 file_size, size_t &predicted,
+                                 size_t &available) {
+  predicted = PredictLoadBytes(file_size);
+  available = AvailableRamBytes();
+  return available > 0 && predicted > available;
+}
+
+}  // namespace s21
@@ -0,0 +1,196 @@
+#include "../include/mesh_adjacency.h"
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Сторона грани: ребро (меньший, больший индекс) в одном числе,
+ * грань и сквозной номер стороны
+ */
+struct SideRecord {
+  std::uint64_t key;
+  unsigned int face;
+  unsigned int side;
+};
+
+}  // namespace
+
+/**
+ * @brief Построение смежности граней faces модели из vertices_count вершин
+ * @param token при отмене построение прерывается и возвращается пустая
+ * смежность (ни граней, ни ребер, ни вершин), а не частично заполненная
+ */
+MeshAdjacency MeshAdjacency::Build(
+    size_t vertices_count, const std::vector<std::vector<unsigned int>> &faces,
+    const CancellationToken &token) {
+  TraceScope trace("MeshAdjacency::Build", "model");
+  MeshAdjacency result;
+  const long long faces_count = static_cast<long long>(faces.size());
+
+  // у многоугольника сторон столько же, сколько вершин, у отрезка - одна;
+  // смещения попадают в result только вместе с остальными массивами
+  std::vector<unsigned int> face_edge_offsets(faces.size() + 1, 0);
+  size_t sides = 0;
+  for (size_t i = 0; i < faces.size(); ++i) {
+    size_t size = faces[i].size();
+    sides += size >= 3 ? size : size == 2 ? 1 : 0;
+    if (sides >= kNone) {
+      throw std::length_error("MeshAdjacency::Build(): too many face sides");
+    }
+    face_edge_offsets[i + 1] = static_cast<unsigned int>(sides);
+  }
+
+  std::vector<SideRecord> records(sides);
+#pragma omp parallel for
+  for (long long i = 0; i < faces_count; ++i) {
+    const std::vector<unsigned int> &face = faces[i];
+    unsigned int first = face_edge_offsets[i];
+    unsigned int count = face_edge_offsets[i + 1] - first;
+    for (unsigned int j = 0; j < count; ++j) {
+      std::uint64_t a = face[j];
+      std::uint64_t b = face[(j + 1) % face.size()];
+      records[first + j] = {(std::min(a, b) << 32) | std::max(a, b),
+                            static_cast<unsigned int>(i), first + j};
+    }
+  }
+  if (!token.IsCancelled()) {
+    std::sort(records.begin(), records.end(),
+              [](const SideRecord &left, const SideRecord &right) {
+                return left.key < right.key ||
+                       (left.key == right.key && left.side < right.side);
+              });
+
+    // номер ребра стороны: начало каждой серии одинаковых ключей - новое ребро
+    const long long records_count = static_cast<long long>(records.size());
+    std::vector<unsigned int> record_edges(records.size());
+#pragma omp parallel for
+    for (long long i = 0; i < records_count; ++i) {
+      record_edges[i] = i == 0 || records[i].key != records[i - 1].key;
+    }
+    unsigned int edges_count = 0;
+    for (unsigned int &edge : record_edges) {
+      edges_count += edge;
+      edge = edges_count - 1;
+    }
+
+    result.edges_.resize(static_cast<size_t>(edges_count) * 2);
+    result.edge_face_offsets_.resize(static_cast<size_t>(edges_count) + 1);
+    result.edge_faces_.resize(records.size());
+    result.face_edges_.resize(records.size());
+#pragma omp parallel for
+    for (long long i = 0; i < records_count; ++i) {
+      unsigned int edge = record_edges[i];
+      if (i == 0 || edge != record_edges[i - 1]) {
+        result.edges_[edge * 2] =
+            static_cast<unsigned int>(records[i].key >> 32);
+        result.edges_[edge * 2 + 1] =
+            static_cast<unsigned int>(records[i].key & 0xFFFFFFFFu);
+        result.edge_face_offsets_[edge] = static_cast<unsigned int>(i);
+      }
+      result.edge_faces_[i] = records[i].face;
+      result.face_edges_[records[i].side] = edge;
+    }
+    result.edge_face_offsets_[edges_count] =
+        static_cast<unsigned int>(records.size());
+
+    // ребра вершин подсчетом (линейный проход по ребрам дешевле сортировки);
+    // индексы вне модели пропускаются
+    result.vertex_edge_offsets_.assign(vertices_count + 1, 0);
+    for (unsigned int vertex : result.edges_) {
+      if (vertex < vertices_count) {
+        ++result.vertex_edge_offsets_[vertex + 1];
+      }
+    }
+    for (size_t i = 0; i < vertices_count; ++i) {
+      result.vertex_edge_offsets_[i + 1] += result.vertex_edge_offsets_[i];
+    }
+    result.vertex_edges_.resize(result.vertex_edge_offsets_.back());
+    std::vector<unsigned int> cursors(result.vertex_edge_offsets_.begin(),
+                                      result.vertex_edge_offsets_.end() - 1);
+    for (size_t i = 0; i < result.edges_.size(); ++i) {
+      unsigned int vertex = result.edges_[i];
+      if (vertex < vertices_count) {
+        result.vertex_edges_[cursors[vertex]++] =
+            static_cast<unsigned int>(i / 2);
+      }
+    }
+    result.face_edge_offsets_ = std::move(face_edge_offsets);
+  }
+  return result;
+}
+
+size_t MeshAdjacency::GetVerticesCount() const {
+  return vertex_edge_offsets_.empty() ? 0 : vertex_edge_offsets_.size() - 1;
+}
+
+size_t MeshAdjacency::GetEdgesCount() const { return edges_.size() / 2; }
+
+size_t MeshAdjacency::GetFacesCount() const {
+  return face_edge_offsets_.empty() ? 0 : face_edge_offsets_.size() - 1;
+}
+
+/**
+ * @return индексы вершин ребра, меньший первым
+ */
+std::pair<unsigned int, unsigned int> MeshAdjacency::GetEdge(
+    size_t edge) const {
+  return {edges_[edge * 2], edges_[edge * 2 + 1]};
+}
+
+/**
+ * @return грани, в которые входит ребро, по возрастанию номера
+ */
+std::span<const unsigned int> MeshAdjacency::GetEdgeFaces(size_t edge) const {
+  return {edge_faces_.data() + edge_face_offsets_[edge],
+          edge_face_offsets_[edge + 1] - edge_face_offsets_[edge]};
+}
+
+/**
+ * @return ребра сторон грани в порядке обхода
+ */
+std::span<const unsigned int> MeshAdjacency::GetFaceEdges(size_t face) const {
+  return {face_edges_.data() + face_edge_offsets_[face],
+          face_edge_offsets_[face + 1] - face_edge_offsets_[face]};
+}
+
+/**
+ * @return ребра, которые сходятся в вершине, по возрастанию номера
+ */
+std::span<const unsigned int> MeshAdjacency::GetVertexEdges(
+    size_t vertex) const {
+  return {vertex_edges_.data() + vertex_edge_offsets_[vertex],
+          vertex_edge_offsets_[vertex + 1] - vertex_edge_offsets_[vertex]};
+}
+
+/**
+ * @return вторая грань ребра с ровно двумя гранями, иначе kNone
+ */
+unsigned int MeshAdjacency::GetOppositeFace(size_t edge, size_t face) const {
+  std::span<const unsigned int> faces = GetEdgeFaces(edge);
+  unsigned int result = kNone;
+  if (faces.size() == 2) {
+    result = faces[0] == face ? faces[1] : faces[0];
+  }
+  return result;
+}
+
+/**
+ * @brief Ребро многообразия: одна грань (граница) или две
+ */
+bool MeshAdjacency::IsManifoldEdge(size_t edge) const {
+  return edge_face_offsets_[edge + 1] - edge_face_offsets_[edge] <= 2;
+}
+
+size_t MeshAdjacency::GetBytes() const {
+  size_t result = 0;
+  for (const std::vector<unsigned int> *array :
+       {&edges_, &edge_face_offsets_, &edge_faces_, &face_edge_offsets_,
+        &face_edges_, &vertex_edge_offsets_, &vertex_edges_}) {
+    result += MemoryStats::HeapBlockBytes(array->capacity() *
+                                          sizeof(unsigned int));
+  }
+  return result;
+}
+
+}  // namespace s21
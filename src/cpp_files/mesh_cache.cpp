@@ -0,0 +1,193 @@
+#include "../include/mesh_cache.h"
+
+namespace s21 {
+
+/**
+ * @brief Общий каталог кэшей для просмотрщика и obj_converter
+ */
+QString MeshCache::DefaultCacheDir() {
+  return QStandardPaths::writableLocation(
+             QStandardPaths::GenericCacheLocation) +
+         "/3DViewer/meshes";
+}
+
+/**
+ * @brief Имя файлов, производных от модели (кэш, миниатюра), без расширения:
+ * имя модели и хэш полного пути, чтобы одинаково названные модели из разных
+ * каталогов не перезаписывали друг друга
+ */
+QString MeshCache::CacheNameFor(const QString &source_path) {
+  QFileInfo source(source_path);
+  size_t path_hash =
+      std::hash<std::string>{}(source.absoluteFilePath().toStdString());
+  return QString("%1_%2").arg(
+      source.completeBaseName(),
+      QString::number(static_cast<qulonglong>(path_hash), 16));
+}
+
+QString MeshCache::CachePathFor(const QString &cache_dir,
+                                const QString &source_path) {
+  return QString("%1/%2.s21mesh").arg(cache_dir, CacheNameFor(source_path));
+}
+
+/**
+ * @brief Атомарная запись кэша (через QSaveFile)
+ * @throw std::runtime_error - не удалось записать файл
+ */
+void MeshCache::Write(
+    const QString &cache_path, const QString &source_path,
+    const std::vector<Vector3D> &vertices,
+    const std::vector<std::vector<unsigned int>> &faces,
+    const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
+        &edges) {
+  TraceScope trace("MeshCache::Write", "cache");
+  QSaveFile file(cache_path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    throw std::runtime_error("MeshCache::Write(): unable to open " +
+                             cache_path.toStdString());
+  }
+  QDataStream out(&file);
+  setup_stream_(out);
+  write_header_(out, QFileInfo(source_path));
+
+  out << static_cast<quint64>(vertices.size());
+  for (const auto &vertex : vertices) {
+    out << vertex.x << vertex.y << vertex.z;
+  }
+  out << static_cast<quint64>(faces.size());
+  for (const auto &face : faces) {
+    out << static_cast<quint32>(face.size());
+    for (unsigned int index : face) {
+      out << static_cast<quint32>(index);
+    }
+  }
+  out << static_cast<quint64>(edges.size());
+  for (const auto &edge : edges) {
+    out << static_cast<quint32>(edge.first)
+        << static_cast<quint32>(edge.second);
+  }
+
+  if (out.status() != QDataStream::Ok || !file.commit()) {
+    throw std::runtime_error("MeshCache::Write(): unable to write " +
+                             cache_path.toStdString());
+  }
+}
+
+/**
+ * @brief Чтение кэша. Актуальность кэша здесь не проверяется (см. IsValid).
+ * @throw std::invalid_argument - файл не является кэшем, другая версия
+ * формата или данные повреждены (в том числе номер вершины грани или ребра
+ * вне списка вершин)
+ */
+MeshData MeshCache::Read(const QString &cache_path) {
+  TraceScope trace("MeshCache::Read", "cache");
+  QFile file(cache_path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    throw std::invalid_argument("MeshCache::Read(): unable to open " +
+                                cache_path.toStdString());
+  }
+  QDataStream in(&file);
+  setup_stream_(in);
+  qint64 source_size = 0, source_modified = 0;
+  if (!read_header_(in, source_size, source_modified)) {
+    throw std::invalid_argument("MeshCache::Read(): " +
+                                cache_path.toStdString() +
+                                " is not a mesh cache!");
+  }
+
+  // количество элементов ограничивается размером файла, чтобы поврежденный
+  // счетчик не приводил к огромному выделению памяти
+  const quint64 max_elements = static_cast<quint64>(file.size()) / 4;
+  auto read_count = [&in, max_elements]() {
+    quint64 count = 0;
+    in >> count;
+    if (count > max_elements) {
+      in.setStatus(QDataStream::ReadCorruptData);
+      count = 0;
+    }
+    return count;
+  };
+
+  MeshData mesh;
+  mesh.vertices.resize(read_count());
+  for (auto &vertex : mesh.vertices) {
+    in >> vertex.x >> vertex.y >> vertex.z;
+  }
+  mesh.faces.resize(read_count());
+  for (auto &face : mesh.faces) {
+    quint32 size = 0;
+    in >> size;
+    face.resize(std::min<quint64>(size, max_elements));
+    for (auto &index : face) {
+      quint32 value = 0;
+      in >> value;
+      if (value >= mesh.vertices.size()) {
+        in.setStatus(QDataStream::ReadCorruptData);
+      }
+      index = value;
+    }
+  }
+  quint64 edges_count = read_count();
+  mesh.edges.reserve(edges_count);
+  for (quint64 i = 0; i < edges_count && in.status() == QDataStream::Ok; ++i) {
+    quint32 first = 0, second = 0;
+    in >> first >> second;
+    if (first >= mesh.vertices.size() || second >= mesh.vertices.size()) {
+      in.setStatus(QDataStream::ReadCorruptData);
+    } else {
+      mesh.edges.insert({first, second});
+    }
+  }
+
+  if (in.status() != QDataStream::Ok) {
+    throw std::invalid_argument("MeshCache::Read(): " +
+                                cache_path.toStdString() + " is corrupted!");
+  }
+  return mesh;
+}
+
+/**
+ * @brief Кэш действителен, если он существует, его формат совпадает с текущим
+ * и исходный файл с момента записи кэша не менялся
+ */
+bool MeshCache::IsValid(const QString &cache_path,
+                        const QString &source_path) {
+  bool result = false;
+  QFileInfo source(source_path);
+  QFile file(cache_path);
+  if (source.exists() && file.open(QIODevice::ReadOnly)) {
+    QDataStream in(&file);
+    setup_stream_(in);
+    qint64 source_size = 0, source_modified = 0;
+    result = read_header_(in, source_size, source_modified) &&
+             source_size == source.size() &&
+             source_modified == source.lastModified().toMSecsSinceEpoch();
+  }
+  return result;
+}
+
+/**
+ * @brief Общие настройки потока для записи и чтения: порядок байт
+ * little-endian совпадает с порядком x86 и ARM, поэтому числа не
+ * переставляются при каждом чтении
+ */
+void MeshCache::setup_stream_(QDataStream &stream) {
+  stream.setVersion(QDataStream::Qt_6_0);
+  stream.setByteOrder(QDataStream::LittleEndian);
+}
+
+void MeshCache::write_header_(QDataStream &out, const QFileInfo &source) {
+  out << kMagic << kVersion << static_cast<qint64>(source.size())
+      << static_cast<qint64>(source.lastModified().toMSecsSinceEpoch());
+}
+
+bool MeshCache::read_header_(QDataStream &in, qint64 &source_size,
+                             qint64 &source_modified) {
+  quint32 magic = 0;
+  quint16 version = 0;
+  in >> magic >> version >> source_size >> source_modified;
+  return in.status() == QDataStream::Ok && magic == kMagic &&
+         version == kVersion;
+}
+
+}  // namespace s21
@@ -0,0 +1,238 @@
+#include "../include/mesh_lod.h"
+
+namespace s21 {
+
+size_t LodLevel::GetEdgesCount() const { return edges.size() / 2; }
+
+/**
+ * @brief Уровни детализации строятся только для моделей, которые заметно
+ * тормозят при вращении
+ */
+bool MeshLod::IsNeeded(size_t edges_count) {
+  return edges_count >= kMinSourceEdges;
+}
+
+/**
+ * @brief Построение иерархии из данных модели в формате OpenGL (вершины по
+ * три координаты, ребра парами индексов)
+ * @param token при отмене построение прерывается между уровнями, результат
+ * неполный
+ */
+MeshLod MeshLod::Build(const std::vector<float> &vertices,
+                       const std::vector<unsigned int> &edges,
+                       const CancellationToken &token) {
+  TraceScope trace("MeshLod::Build", "lod");
+  MeshLod lod;
+  lod.box_ = BoxOf(vertices);
+  lod.source_edges_ = edges.size() / 2;
+  // указатели на исходные данные уровня не должны меняться при push_back
+  lod.levels_.reserve(static_cast<size_t>(
+      std::log2(kMaxResolution / kMinResolution) + 1));
+
+  const std::vector<float> *source_vertices = &vertices;
+  const std::vector<unsigned int> *source_edges = &edges;
+  size_t previous_edges = lod.source_edges_;
+  bool is_coarse_enough = false;
+  for (int resolution = kMaxResolution; resolution >= kMinResolution &&
+                                        !is_coarse_enough &&
+                                        !token.IsCancelled();
+       resolution /= 2) {
+    LodLevel level = Cluster(*source_vertices, *source_edges, lod.box_,
+                             resolution);
+    is_coarse_enough = level.GetEdgesCount() <= kMinLevelEdges;
+    if (level.GetEdgesCount() * 2 <= previous_edges || is_coarse_enough) {
+      previous_edges = level.GetEdgesCount();
+      lod.levels_.push_back(std::move(level));
+      source_vertices = &lod.levels_.back().vertices;
+      source_edges = &lod.levels_.back().edges;
+    }
+  }
+  return lod;
+}
+
+/**
+ * @brief Один уровень: кластеризация вершин по сетке с ячейками размером
+ * (наибольшая сторона рамки) / resolution
+ */
+LodLevel MeshLod::Cluster(const std::vector<float> &vertices,
+                          const std::vector<unsigned int> &edges,
+                          const BoundingBox &box, int resolution) {
+  TraceScope trace("MeshLod::Cluster", "lod");
+  LodLevel level;
+  level.resolution = resolution;
+  const long long vertices_count = static_cast<long long>(vertices.size() / 3);
+  double extent = std::max({box.max.x - box.min.x, box.max.y - box.min.y,
+                            box.max.z - box.min.z});
+  const double cell = extent > 0 ? extent / resolution : 1.0;
+  const double min[3] = {box.min.x, box.min.y, box.min.z};
+  const std::uint64_t side = static_cast<std::uint64_t>(resolution);
+
+  // номер ячейки каждой вершины
+  std::vector<std::uint64_t> keys(static_cast<size_t>(vertices_count));
+#pragma omp parallel for
+  for (long long i = 0; i < vertices_count; ++i) {
+    std::uint64_t key = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+      double position = (vertices[i * 3 + axis] - min[axis]) / cell;
+      std::uint64_t index = static_cast<std::uint64_t>(
+          std::clamp(position, 0.0, static_cast<double>(resolution - 1)));
+      key = key * side + index;
+    }
+    keys[i] = key;
+  }
+
+  // непустые ячейки становятся вершинами уровня
+  std::vector<std::uint64_t> cells(keys);
+  std::sort(cells.begin(), cells.end());
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+  std::vector<unsigned int> cluster(static_cast<size_t>(vertices_count));
+#pragma omp parallel for
+  for (long long i = 0; i < vertices_count; ++i) {
+    cluster[i] = static_cast<unsigned int>(
+        std::lower_bound(cells.begin(), cells.end(), keys[i]) - cells.begin());
+  }
+
+  std::vector<double> sums(cells.size() * 3, 0.0);
+  std::vector<unsigned int> counts(cells.size(), 0);
+  for (long long i = 0; i < vertices_count; ++i) {
+    for (int axis = 0; axis < 3; ++axis) {
+      sums[cluster[i] * 3 + axis] += vertices[i * 3 + axis];
+    }
+    ++counts[cluster[i]];
+  }
+  level.vertices.resize(sums.size());
+  for (size_t i = 0; i < sums.size(); ++i) {
+    level.vertices[i] = static_cast<float>(sums[i] / counts[i / 3]);
+  }
+
+  // ребра между ячейками: пара (меньший, больший) в одном числе, ребра
+  // внутри ячейки помечаются kNoEdge
+  const std::uint64_t kNoEdge = std::numeric_limits<std::uint64_t>::max();
+  const long long edges_count = static_cast<long long>(edges.size() / 2);
+  std::vector<std::uint64_t> edge_keys(static_cast<size_t>(edges_count));
+#pragma omp parallel for
+  for (long long i = 0; i < edges_count; ++i) {
+    std::uint64_t first = cluster[edges[i * 2]];
+    std::uint64_t second = cluster[edges[i * 2 + 1]];
+    edge_keys[i] = first == second ? kNoEdge
+                                   : (std::min(first, second) << 32) |
+                                         std::max(first, second);
+  }
+  std::sort(edge_keys.begin(), edge_keys.end());
+  edge_keys.erase(std::unique(edge_keys.begin(), edge_keys.end()),
+                  edge_keys.end());
+  level.edges.reserve(edge_keys.size() * 2);
+  for (std::uint64_t key : edge_keys) {
+    if (key != kNoEdge) {
+      level.edges.push_back(static_cast<unsigned int>(key >> 32));
+      level.edges.push_back(static_cast<unsigned int>(key & 0xFFFFFFFFu));
+    }
+  }
+  return level;
+}
+
+BoundingBox MeshLod::BoxOf(const std::vector<float> &vertices) {
+  BoundingBox box;
+  if (vertices.size() >= 3) {
+    box.min = box.max = Vector3D(vertices[0], vertices[1], vertices[2]);
+  }
+  for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+    box.min.x = std::min<double>(box.min.x, vertices[i]);
+    box.min.y = std::min<double>(box.min.y, vertices[i + 1]);
+    box.min.z = std::min<double>(box.min.z, vertices[i + 2]);
+    box.max.x = std::max<double>(box.max.x, vertices[i]);
+    box.max.y = std::max<double>(box.max.y, vertices[i + 1]);
+    box.max.z = std::max<double>(box.max.z, vertices[i + 2]);
+  }
+  return box;
+}
+
+/**
+ * @brief Размер рамки модели на экране в пикселях (наибольшая сторона
+ * описанного прямоугольника проекций углов рамки)
+ * @return бесконечность, если часть рамки за камерой: точной оценки нет, и
+ * модель рисуется полностью
+ */
+double MeshLod::ScreenExtent(const IMatrix &mvp, const BoundingBox &box,
+                             int width, int height) {
+  double min_x = std::numeric_limits<double>::max(), max_x = -min_x;
+  double min_y = min_x, max_y = -min_x;
+  bool is_behind_camera = false;
+  for (int corner = 0; corner < 8; ++corner) {
+    double point[4] = {corner & 1 ? box.max.x : box.min.x,
+                       corner & 2 ? box.max.y : box.min.y,
+                       corner & 4 ? box.max.z : box.min.z, 1.0};
+    double clip[4] = {0, 0, 0, 0};
+    for (int row = 0; row < 4; ++row) {
+      for (int col = 0; col < 4; ++col) {
+        clip[row] += mvp(row, col) * point[col];
+      }
+    }
+    is_behind_camera = is_behind_camera || clip[3] <= 0;
+    if (clip[3] > 0) {
+      double x = (clip[0] / clip[3] + 1.0) * 0.5 * width;
+      double y = (clip[1] / clip[3] + 1.0) * 0.5 * height;
+      min_x = std::min(min_x, x);
+      max_x = std::max(max_x, x);
+      min_y = std::min(min_y, y);
+      max_y = std::max(max_y, y);
+    }
+  }
+  return is_behind_camera ? std::numeric_limits<double>::infinity()
+                          : std::max(max_x - min_x, max_y - min_y);
+}
+
+/**
+ * @brief Самый грубый уровень, ячейки которого на экране не больше
+ * max_cell_pixels: на таком уровне упрощение не видно
+ * @return индекс уровня, -1 - нужна полная модель
+ */
+int MeshLod::SelectByScreenSize(double extent_pixels,
+                                double max_cell_pixels) const {
+  int result = -1;
+  for (size_t i = 0; i < levels_.size(); ++i) {
+    if (extent_pixels / levels_[i].resolution <= max_cell_pixels) {
+      result = static_cast<int>(i);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Самый подробный уровень, у которого не больше edges_budget ребер.
+ * Если в бюджет не помещается ни один, выбирается самый грубый.
+ * @return индекс уровня, -1 - полная модель помещается в бюджет
+ */
+int MeshLod::SelectByBudget(size_t edges_budget) const {
+  int result = -1;
+  if (source_edges_ > edges_budget && !levels_.empty()) {
+    result = static_cast<int>(levels_.size()) - 1;
+    bool found = false;
+    for (size_t i = 0; i < levels_.size() && !found; ++i) {
+      found = levels_[i].GetEdgesCount() <= edges_budget;
+      if (found) {
+        result = static_cast<int>(i);
+      }
+    }
+  }
+  return result;
+}
+
+const std::vector<LodLevel> &MeshLod::GetLevels() const { return levels_; }
+
+const BoundingBox &MeshLod::GetBox() const { return box_; }
+
+size_t MeshLod::GetSourceEdgesCount() const { return source_edges_; }
+
+size_t MeshLod::GetBytes() const {
+  size_t bytes = 0;
+  for (const auto &level : levels_) {
+    bytes += MemoryStats::HeapBlockBytes(level.vertices.capacity() *
+                                         sizeof(float)) +
+             MemoryStats::HeapBlockBytes(level.edges.capacity() *
+                                         sizeof(unsigned int));
+  }
+  return bytes;
+}
+
+}  // namespace s21
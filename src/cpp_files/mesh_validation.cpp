@@ -0,0 +1,379 @@
+#include "../include/mesh_validation.h"
+
+#include "../include/feature_edges.h"
+
+namespace s21 {
+
+/**
+ * @brief Проверка модели
+ * @param adjacency смежность граней faces (MeshAdjacency::Build или
+ * Model3D::GetAdjacency)
+ * @param max_coordinate координаты по модулю больше этого значения считаются
+ * ошибкой экспорта
+ * @param token при отмене оставшиеся проверки пропускаются
+ */
+MeshValidation MeshValidation::Run(
+    const std::vector<Vector3D> &vertices,
+    const std::vector<std::vector<unsigned int>> &faces,
+    const MeshAdjacency &adjacency, double max_coordinate,
+    const CancellationToken &token) {
+  TraceScope trace("MeshValidation::Run", "analysis");
+  QElapsedTimer timer;
+  timer.start();
+  MeshValidation result;
+  const long long vertices_count = static_cast<long long>(vertices.size());
+  const long long faces_count = static_cast<long long>(faces.size());
+
+  // координаты; размер модели считается только по правильным вершинам
+  std::vector<unsigned char> flags(vertices.size());
+  size_t count = 0;
+  const double inf = std::numeric_limits<double>::infinity();
+  double min_x = inf, min_y = inf, min_z = inf;
+  double max_x = -inf, max_y = -inf, max_z = -inf;
+#pragma omp parallel for reduction(+ : count)                     \
+    reduction(min : min_x, min_y, min_z) reduction(max : max_x, max_y, max_z)
+  for (long long i = 0; i < vertices_count; ++i) {
+    const Vector3D &vertex = vertices[i];
+    // сравнение с NaN ложно, поэтому NaN тоже не проходит
+    bool is_valid = std::fabs(vertex.x) <= max_coordinate &&
+                    std::fabs(vertex.y) <= max_coordinate &&
+                    std::fabs(vertex.z) <= max_coordinate;
+    flags[i] = !is_valid;
+    count += !is_valid;
+    if (is_valid) {
+      min_x = std::min(min_x, vertex.x);
+      min_y = std::min(min_y, vertex.y);
+      min_z = std::min(min_z, vertex.z);
+      max_x = std::max(max_x, vertex.x);
+      max_y = std::max(max_y, vertex.y);
+      max_z = std::max(max_z, vertex.z);
+    }
+  }
+  result.add_issue_(MeshIssue::kOutOfRangeCoordinate, flags, count);
+  const double diagonal_squared =
+      max_x >= min_x ? (max_x - min_x) * (max_x - min_x) +
+                           (max_y - min_y) * (max_y - min_y) +
+                           (max_z - min_z) * (max_z - min_z)
+                     : 0.0;
+
+  if (!token.IsCancelled()) {
+    flags.assign(faces.size(), 0);
+    count = 0;
+    const double min_double_area = kAreaEpsilon * diagonal_squared;
+#pragma omp parallel for reduction(+ : count)
+    for (long long i = 0; i < faces_count; ++i) {
+      flags[i] = is_degenerate_face_(vertices, faces[i], min_double_area);
+      count += flags[i];
+    }
+    result.add_issue_(MeshIssue::kDegenerateFace, flags, count);
+  }
+
+  if (!token.IsCancelled()) {
+    // грани с одинаковым хешем идут подряд, в каждой серии первая грань
+    // каждого набора вершин - исходная, остальные - ее повторы
+    std::vector<std::pair<std::uint64_t, unsigned int>> hashes(faces.size());
+#pragma omp parallel for
+    for (long long i = 0; i < faces_count; ++i) {
+      hashes[i] = {face_hash_(faces[i]), static_cast<unsigned int>(i)};
+    }
+    std::sort(hashes.begin(), hashes.end());
+    std::vector<unsigned int> originals(faces.size(), MeshAdjacency::kNone);
+    std::vector<unsigned int> representatives;
+    flags.assign(faces.size(), 0);
+    count = 0;
+    for (size_t first = 0; first < hashes.size();) {
+      const std::uint64_t hash = hashes[first].first;
+      size_t last = first + 1;
+      while (last < hashes.size() && hashes[last].first == hash) {
+        ++last;
+      }
+      representatives.clear();
+      for (size_t i = first; i < last && last - first > 1; ++i) {
+        unsigned int face = hashes[i].second;
+        for (size_t j = 0; j < representatives.size() &&
+                           originals[face] == MeshAdjacency::kNone;
+             ++j) {
+          if (is_same_face_(faces[representatives[j]], faces[face])) {
+            originals[face] = representatives[j];
+          }
+        }
+        if (originals[face] == MeshAdjacency::kNone) {
+          representatives.push_back(face);
+        } else {
+          flags[face] = 1;
+          ++count;
+        }
+      }
+      first = last;
+    }
+    result.add_issue_(MeshIssue::kDuplicateFace, flags, count, originals);
+  }
+
+  if (!token.IsCancelled()) {
+    const long long adjacency_vertices =
+        static_cast<long long>(adjacency.GetVerticesCount());
+    flags.assign(adjacency.GetVerticesCount(), 0);
+    count = 0;
+#pragma omp parallel for reduction(+ : count)
+    for (long long i = 0; i < adjacency_vertices; ++i) {
+      flags[i] = adjacency.GetVertexEdges(i).empty();
+      count += flags[i];
+    }
+    result.add_issue_(MeshIssue::kUnreferencedVertex, flags, count);
+
+    const long long edges_count =
+        static_cast<long long>(adjacency.GetEdgesCount());
+    flags.assign(adjacency.GetEdgesCount(), 0);
+    count = 0;
+#pragma omp parallel for reduction(+ : count)
+    for (long long i = 0; i < edges_count; ++i) {
+      flags[i] = !adjacency.IsManifoldEdge(i);
+      count += flags[i];
+    }
+    result.add_issue_(MeshIssue::kNonManifoldEdge, flags, count);
+    // в отчете ребро задается вершинами, а не номером в MeshAdjacency
+    for (MeshIssueSample &sample :
+         result.samples_[static_cast<size_t>(MeshIssue::kNonManifoldEdge)]) {
+      auto [a, b] = adjacency.GetEdge(sample.index);
+      sample = {a, b};
+    }
+  }
+  result.elapsed_ms_ = timer.elapsed();
+  return result;
+}
+
+/**
+ * @brief Проверка модели. Смежность берется у модели, если она уже
+ * построена (например, для характерных ребер), иначе строится только на время
+ * проверки: у модели она не остается и не занимает память после проверки.
+ * Время проверки включает построение смежности.
+ */
+MeshValidation MeshValidation::Run(const Model3D &model,
+                                   const CancellationToken &token) {
+  QElapsedTimer timer;
+  timer.start();
+  std::shared_ptr<const MeshAdjacency> adjacency;
+  if (model.HasAdjacency()) {
+    adjacency = model.GetAdjacency();
+  } else {
+    adjacency = std::make_shared<const MeshAdjacency>(MeshAdjacency::Build(
+        model.GetVertices().size(), model.GetFaces(), token));
+  }
+  MeshValidation result =
+      Run(model.GetVertices(), model.GetFaces(), *adjacency,
+          kDefaultMaxCoordinate, token);
+  result.elapsed_ms_ = timer.elapsed();
+  return result;
+}
+
+size_t MeshValidation::GetCount(MeshIssue issue) const {
+  return counts_[static_cast<size_t>(issue)];
+}
+
+const std::vector<MeshIssueSample> &MeshValidation::GetSamples(
+    MeshIssue issue) const {
+  return samples_[static_cast<size_t>(issue)];
+}
+
+size_t MeshValidation::GetIssuesCount() const {
+  size_t result = 0;
+  for (size_t count : counts_) {
+    result += count;
+  }
+  return result;
+}
+
+bool MeshValidation::IsValid() const { return GetIssuesCount() == 0; }
+
+qint64 MeshValidation::GetElapsedMs() const { return elapsed_ms_; }
+
+/**
+ * @brief Одна строка для панели информации о модели
+ */
+QString MeshValidation::Summary() const {
+  QString summary;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] > 0) {
+      summary += QString("%1%2 %3")
+                     .arg(summary.isEmpty() ? "" : ", ")
+                     .arg(counts_[i])
+                     .arg(QString(IssueName(static_cast<MeshIssue>(i)))
+                              .replace('_', ' '));
+    }
+  }
+  return "Validation: " + (summary.isEmpty() ? QString("no issues") : summary);
+}
+
+/**
+ * @brief Количество и примеры мест по каждой проблеме (по строке на
+ * проблему), номера вершин и граней с единицы, как в .obj файле
+ */
+QString MeshValidation::Details() const {
+  QString details;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    auto issue = static_cast<MeshIssue>(i);
+    QStringList places;
+    for (const MeshIssueSample &sample : samples_[i]) {
+      if (issue == MeshIssue::kNonManifoldEdge) {
+        places << QString("v %1-%2").arg(sample.index + 1).arg(
+                      sample.other + 1);
+      } else if (issue == MeshIssue::kDuplicateFace) {
+        places << QString("f %1 = f %2")
+                      .arg(sample.index + 1)
+                      .arg(sample.other + 1);
+      } else if (issue == MeshIssue::kDegenerateFace) {
+        places << QString("f %1").arg(sample.index + 1);
+      } else {
+        places << QString("v %1").arg(sample.index + 1);
+      }
+    }
+    details += QString("%1: %2").arg(IssueName(issue)).arg(counts_[i]);
+    if (!places.isEmpty()) {
+      details += " (" + places.join(", ") + ")";
+    }
+    details += "\n";
+  }
+  details += QString("elapsed: %1 ms").arg(elapsed_ms_);
+  return details;
+}
+
+/**
+ * @brief Отчет для консольного режима: по каждой проблеме количество и
+ * примеры (номера с единицы, у ребер и повторных граней - пары номеров)
+ */
+QJsonObject MeshValidation::ToJson() const {
+  QJsonObject issues;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    auto issue = static_cast<MeshIssue>(i);
+    bool is_pair = issue == MeshIssue::kNonManifoldEdge ||
+                   issue == MeshIssue::kDuplicateFace;
+    QJsonArray samples;
+    for (const MeshIssueSample &sample : samples_[i]) {
+      if (is_pair) {
+        samples.append(QJsonArray{static_cast<qint64>(sample.index + 1),
+                                  static_cast<qint64>(sample.other + 1)});
+      } else {
+        samples.append(static_cast<qint64>(sample.index + 1));
+      }
+    }
+    QJsonObject entry;
+    entry["count"] = static_cast<qint64>(counts_[i]);
+    entry["samples"] = samples;
+    issues[IssueName(issue)] = entry;
+  }
+  QJsonObject json;
+  json["valid"] = IsValid();
+  json["issues"] = issues;
+  json["elapsed_ms"] = elapsed_ms_;
+  return json;
+}
+
+const char *MeshValidation::IssueName(MeshIssue issue) {
+  const char *name = "unknown";
+  switch (issue) {
+    case MeshIssue::kDegenerateFace:
+      name = "degenerate_faces";
+      break;
+    case MeshIssue::kDuplicateFace:
+      name = "duplicate_faces";
+      break;
+    case MeshIssue::kUnreferencedVertex:
+      name = "unreferenced_vertices";
+      break;
+    case MeshIssue::kNonManifoldEdge:
+      name = "non_manifold_edges";
+      break;
+    case MeshIssue::kOutOfRangeCoordinate:
+      name = "out_of_range_coordinates";
+      break;
+    case MeshIssue::kCount:
+      break;
+  }
+  return name;
+}
+
+/**
+ * @brief Запись проблемы: count отмеченных в flags элементов, примеры -
+ * первые отмеченные (просмотр останавливается, как только их набрано
+ * kMaxSamples)
+ * @param others второй номер примера (например, исходная грань повтора)
+ */
+void MeshValidation::add_issue_(MeshIssue issue,
+                                const std::vector<unsigned char> &flags,
+                                size_t count,
+                                const std::vector<unsigned int> &others) {
+  counts_[static_cast<size_t>(issue)] = count;
+  std::vector<MeshIssueSample> &samples = samples_[static_cast<size_t>(issue)];
+  const size_t samples_count = std::min(count, kMaxSamples);
+  for (size_t i = 0; i < flags.size() && samples.size() < samples_count; ++i) {
+    if (flags[i]) {
+      samples.push_back({i, others.empty() ? 0 : others[i]});
+    }
+  }
+}
+
+/**
+ * @brief Грань вырождена, если у нее меньше двух вершин, есть индекс вне
+ * модели или повтор вершины, либо (у многоугольника) ее площадь почти
+ * нулевая. Грань из двух вершин - отрезок, площади у нее нет.
+ */
+bool MeshValidation::is_degenerate_face_(
+    const std::vector<Vector3D> &vertices,
+    const std::vector<unsigned int> &face, double min_double_area) {
+  bool result = face.size() < 2;
+  for (size_t i = 0; i < face.size() && !result; ++i) {
+    result = face[i] >= vertices.size();
+  }
+  if (!result && face.size() <= 16) {
+    for (size_t i = 0; i < face.size() && !result; ++i) {
+      for (size_t j = i + 1; j < face.size() && !result; ++j) {
+        result = face[i] == face[j];
+      }
+    }
+  } else if (!result) {
+    std::vector<unsigned int> sorted = face;
+    std::sort(sorted.begin(), sorted.end());
+    result = std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end();
+  }
+  if (!result && face.size() >= 3) {
+    // длина нормали Ньюэлла - удвоенная площадь плоской грани
+    result = FeatureEdges::FaceNormal(vertices, face).length() <=
+             min_double_area;
+  }
+  return result;
+}
+
+/**
+ * @brief Хеш набора вершин грани, не зависящий от их порядка: сумма и
+ * исключающее или перемешанных (splitmix64) индексов
+ */
+std::uint64_t MeshValidation::face_hash_(
+    const std::vector<unsigned int> &face) {
+  std::uint64_t sum = 0, bits = 0;
+  for (unsigned int index : face) {
+    std::uint64_t x = index + 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    sum += x;
+    bits ^= x;
+  }
+  return sum ^ (bits * 0x9E3779B97F4A7C15ull) ^ face.size();
+}
+
+/**
+ * @brief Одинаковы ли наборы вершин граней (порядок обхода не важен)
+ */
+bool MeshValidation::is_same_face_(const std::vector<unsigned int> &first,
+                                   const std::vector<unsigned int> &second) {
+  bool result = first.size() == second.size();
+  if (result) {
+    std::vector<unsigned int> left = first, right = second;
+    std::sort(left.begin(), left.end());
+    std::sort(right.begin(), right.end());
+    result = left == right;
+  }
+  return result;
+}
+
+}  // namespace s21
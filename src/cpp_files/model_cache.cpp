@@ -0,0 +1,144 @@
+#include "../include/model_cache.h"
+
+namespace s21 {
+
+FileStamp FileStamp::Of(const std::string &file_path) {
+  FileStamp result;
+  QFileInfo file(QString::fromStdString(file_path));
+  if (file.exists()) {
+    result.size = file.size();
+    result.modified = file.lastModified().toMSecsSinceEpoch();
+  }
+  return result;
+}
+
+ModelCache::ModelCache(size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+/**
+ * @brief Поиск модели. Найденная запись становится самой недавней.
+ * @return nullptr - модели нет в кэше или файл с тех пор изменился
+ */
+std::shared_ptr<const MeshData> ModelCache::Find(
+    const std::string &file_path) {
+  std::shared_ptr<const MeshData> result;
+  std::string key = key_for_(file_path);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end() && !is_fresh_(*it->second)) {
+    erase_(it->second);
+    it = index_.end();
+  }
+  if (it == index_.end()) {
+    ++misses_;
+  } else {
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    result = it->second->mesh;
+  }
+  return result;
+}
+
+/**
+ * @brief Проверка без изменения порядка вытеснения и счетчиков
+ */
+bool ModelCache::Contains(const std::string &file_path) const {
+  std::string key = key_for_(file_path);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  return it != index_.end() && is_fresh_(*it->second);
+}
+
+/**
+ * @brief Добавление (или замена) модели. Модель больше всего бюджета не
+ * кэшируется, остальные при нехватке места вытесняют самые давние.
+ * @param stamp файл на момент перед разбором (FileStamp::Of)
+ */
+void ModelCache::Insert(const std::string &file_path, const FileStamp &stamp,
+                        std::shared_ptr<const MeshData> mesh) {
+  std::string key = key_for_(file_path);
+  size_t bytes = mesh ? mesh->GetBytes() : 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    erase_(it->second);
+  }
+  if (mesh && bytes <= budget_bytes_) {
+    entries_.push_front({key, stamp, std::move(mesh), bytes});
+    index_[key] = entries_.begin();
+    used_bytes_ += bytes;
+    evict_to_budget_();
+  }
+}
+
+void ModelCache::SetBudget(size_t budget_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  budget_bytes_ = budget_bytes;
+  evict_to_budget_();
+}
+
+void ModelCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  used_bytes_ = 0;
+}
+
+size_t ModelCache::GetBudget() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return budget_bytes_;
+}
+
+size_t ModelCache::GetUsedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return used_bytes_;
+}
+
+size_t ModelCache::GetEntriesCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+/**
+ * @brief Объем кэша и счетчики попаданий, промахов и вытеснений
+ */
+void ModelCache::AccountMemory(MemoryStats &stats) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats.Set(MemoryCategory::kModelCache, used_bytes_);
+  stats.SetCounter("model_cache_entries", entries_.size());
+  stats.SetCounter("model_cache_hits", hits_);
+  stats.SetCounter("model_cache_misses", misses_);
+  stats.SetCounter("model_cache_evictions", evictions_);
+}
+
+/**
+ * @brief Четверть доступной памяти, но не больше 1 ГБ
+ */
+size_t ModelCache::DefaultBudget() {
+  const size_t max_budget = 1024ull * 1024 * 1024;
+  return std::min(max_budget, MemoryStats::AvailableRamBytes() / 4);
+}
+
+std::string ModelCache::key_for_(const std::string &file_path) {
+  return QFileInfo(QString::fromStdString(file_path))
+      .absoluteFilePath()
+      .toStdString();
+}
+
+bool ModelCache::is_fresh_(const Entry &entry) const {
+  return entry.stamp.size >= 0 && FileStamp::Of(entry.key) == entry.stamp;
+}
+
+void ModelCache::erase_(std::list<Entry>::iterator entry) {
+  used_bytes_ -= entry->bytes;
+  index_.erase(entry->key);
+  entries_.erase(entry);
+}
+
+void ModelCache::evict_to_budget_() {
+  while (used_bytes_ > budget_bytes_ && !entries_.empty()) {
+    erase_(std::prev(entries_.end()));
+    ++evictions_;
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,286 @@
+#include "../include/model_prefetcher.h"
+
+#include "../include/mesh_cache.h"
+
+namespace s21 {
+
+/**
+ * @brief Вызывается задачей упреждающей загрузки перед разбором файла
+ * @return false - задачу уже забрала загрузка пользователя, разбирать не нужно
+ */
+bool PrefetchJob::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool result = phase_ == Phase::kQueued;
+  if (result) {
+    phase_ = Phase::kRunning;
+  }
+  return result;
+}
+
+void PrefetchJob::Finish(std::shared_ptr<const MeshData> mesh) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mesh_ = std::move(mesh);
+    phase_ = Phase::kDone;
+  }
+  done_.notify_all();
+}
+
+/**
+ * @brief Присоединение загрузки пользователя (в рабочем потоке). Если разбор
+ * еще не начался, задача забирается сразу: ждать задачу с низким приоритетом
+ * в очереди дольше, чем разобрать файл самому. Если идет - ожидание его
+ * окончания, пока не отменен token.
+ * @return модель или nullptr, если файл нужно разобрать самому (разбор не
+ * начинался, не удался или отменен)
+ */
+std::shared_ptr<const MeshData> PrefetchJob::Join(
+    const CancellationToken &token) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (phase_ == Phase::kQueued) {
+    phase_ = Phase::kDone;
+  }
+  while (phase_ != Phase::kDone && !token.IsCancelled()) {
+    done_.wait_for(lock, std::chrono::milliseconds(20));
+  }
+  return phase_ == Phase::kDone ? mesh_ : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// реализация ModelPrefetcher
+
+ModelPrefetcher::ModelPrefetcher(ModelCache &cache) : cache_(cache) {}
+
+ModelPrefetcher::~ModelPrefetcher() { Cancel(); }
+
+void ModelPrefetcher::SetEnabled(bool enabled) {
+  enabled_ = enabled;
+  if (!enabled_) {
+    Cancel();
+  }
+}
+
+bool ModelPrefetcher::IsEnabled() const { return enabled_; }
+
+void ModelPrefetcher::SetDepth(size_t depth) { depth_ = depth; }
+
+/**
+ * @brief Постановка в очередь соседей current_file (вызывается в потоке gui
+ * после открытия модели)
+ */
+void ModelPrefetcher::Prefetch(JobSystem &jobs,
+                               const std::string &current_file) {
+  std::vector<std::string> candidates;
+  if (enabled_) {
+    candidates = Candidates(siblings_for_(current_file), current_file, depth_);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    if (std::find(candidates.begin(), candidates.end(), it->first) ==
+        candidates.end()) {
+      it->second.token.Cancel();
+      it = pending_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (const std::string &file : candidates) {
+    if (pending_.count(file) == 0 && !cache_.Contains(file)) {
+      auto job = std::make_shared<PrefetchJob>();
+      // запись удаляется, когда задача завершена или отменена, если ее еще
+      // не заменила новая задача для того же файла
+      CancellationToken token = jobs.Submit(
+          [this, file, job](const CancellationToken &job_token) {
+            if (job->Start()) {
+              job->Finish(prefetch_file_(file, job_token));
+            }
+          },
+          JobPriority::kLow, nullptr,
+          [this, file, job](bool) {
+            std::lock_guard<std::mutex> done_lock(mutex_);
+            auto it = pending_.find(file);
+            if (it != pending_.end() && it->second.job == job) {
+              pending_.erase(it);
+            }
+          });
+      pending_[file] = {token, job};
+    }
+  }
+}
+
+/**
+ * @brief Передача упреждающей загрузки file загрузке пользователя (в потоке
+ * gui). Задача больше не отменяется при смене кандидатов.
+ * @return nullptr, если для file упреждающей загрузки нет
+ */
+std::shared_ptr<PrefetchJob> ModelPrefetcher::Claim(const std::string &file) {
+  std::shared_ptr<PrefetchJob> result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pending_.find(file);
+  if (it != pending_.end()) {
+    result = it->second.job;
+    pending_.erase(it);
+  }
+  return result;
+}
+
+void ModelPrefetcher::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &[file, pending] : pending_) {
+    pending.token.Cancel();
+  }
+  pending_.clear();
+}
+
+size_t ModelPrefetcher::GetPendingCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+void ModelPrefetcher::AccountMemory(MemoryStats &stats) const {
+  stats.SetCounter("prefetch_completed", completed_.load());
+  stats.SetCounter("prefetch_skipped", skipped_.load());
+}
+
+/**
+ * @brief .obj файлы каталога, в котором лежит file, отсортированные по имени
+ */
+std::vector<std::string> ModelPrefetcher::SiblingFiles(
+    const std::string &file) {
+  QDir dir = QFileInfo(QString::fromStdString(file)).absoluteDir();
+  dir.setNameFilters({"*.obj"});
+  std::vector<std::string> result;
+  for (const QString &name : dir.entryList(QDir::Files, QDir::Name)) {
+    result.push_back(dir.absoluteFilePath(name).toStdString());
+  }
+  return result;
+}
+
+/**
+ * @brief Соседний по имени файл по списку каталога, прочитанному при
+ * предыдущем вызове, если каталог с тех пор не менялся
+ */
+std::string ModelPrefetcher::GetNeighbour(const std::string &file,
+                                          int offset) {
+  return Neighbour(siblings_for_(file), file, offset);
+}
+
+/**
+ * @brief Соседний по имени файл
+ * @param offset 1 - следующий, -1 - предыдущий
+ * @return пустая строка, если такого файла нет
+ */
+std::string ModelPrefetcher::Neighbour(const std::string &file, int offset) {
+  return Neighbour(SiblingFiles(file), file, offset);
+}
+
+/**
+ * @brief Соседний по имени файл в уже прочитанном списке siblings
+ */
+std::string ModelPrefetcher::Neighbour(const std::vector<std::string> &siblings,
+                                       const std::string &file, int offset) {
+  std::string result;
+  std::string absolute =
+      QFileInfo(QString::fromStdString(file)).absoluteFilePath().toStdString();
+  auto it = std::find(siblings.begin(), siblings.end(), absolute);
+  if (it != siblings.end()) {
+    auto index = static_cast<long long>(it - siblings.begin()) + offset;
+    if (index >= 0 && index < static_cast<long long>(siblings.size())) {
+      result = siblings[static_cast<size_t>(index)];
+    }
+  }
+  return result;
+}
+
+std::vector<std::string> ModelPrefetcher::Candidates(const std::string &file,
+                                                     size_t depth) {
+  return Candidates(SiblingFiles(file), file, depth);
+}
+
+/**
+ * @brief Кандидаты в порядке убывания вероятности: depth следующих файлов,
+ * затем предыдущий. Каталог читается один раз, в siblings.
+ */
+std::vector<std::string> ModelPrefetcher::Candidates(
+    const std::vector<std::string> &siblings, const std::string &file,
+    size_t depth) {
+  std::vector<std::string> result;
+  for (size_t i = 1; i <= depth; ++i) {
+    std::string next = Neighbour(siblings, file, static_cast<int>(i));
+    if (!next.empty()) {
+      result.push_back(next);
+    }
+  }
+  std::string previous = Neighbour(siblings, file, -1);
+  if (depth > 0 && !previous.empty()) {
+    result.push_back(previous);
+  }
+  return result;
+}
+
+/**
+ * @brief Хватит ли памяти на упреждающую загрузку: модель должна помещаться в
+ * бюджет кэша, а доступной памяти должно остаться вдвое больше, чем нужно на
+ * загрузку, чтобы не вытеснять рабочие данные
+ */
+bool ModelPrefetcher::HasMemoryFor(const std::string &file,
+                                   size_t cache_budget) {
+  qint64 file_size = QFileInfo(QString::fromStdString(file)).size();
+  size_t predicted = MemoryStats::PredictLoadBytes(file_size);
+  size_t available = MemoryStats::AvailableRamBytes();
+  return MemoryStats::PredictMeshBytes(file_size) <= cache_budget &&
+         (available == 0 || predicted * 2 <= available);
+}
+
+/**
+ * @brief Отсортированные .obj файлы каталога file. Каталог читается заново,
+ * только если это другой каталог или время его изменения (добавление,
+ * удаление, переименование файлов) стало другим.
+ */
+const std::vector<std::string> &ModelPrefetcher::siblings_for_(
+    const std::string &file) {
+  QFileInfo dir_info(QFileInfo(QString::fromStdString(file)).absolutePath());
+  QString dir = dir_info.absoluteFilePath();
+  qint64 modified = dir_info.lastModified().toMSecsSinceEpoch();
+  if (dir != siblings_dir_ || modified != siblings_modified_) {
+    siblings_ = SiblingFiles(file);
+    siblings_dir_ = dir;
+    siblings_modified_ = modified;
+  }
+  return siblings_;
+}
+
+/**
+ * @brief Загрузка одного файла в рабочем потоке. В кэш попадают только
+ * модели без ошибок (как и при обычной загрузке).
+ * @return загруженная модель, nullptr - файл пропущен или не загружен
+ */
+std::shared_ptr<const MeshData> ModelPrefetcher::prefetch_file_(
+    const std::string &file, const CancellationToken &token) {
+  TraceScope trace("ModelPrefetcher::prefetch_file_", "prefetch");
+  std::shared_ptr<const MeshData> mesh;
+  if (cache_.Contains(file)) {
+    // уже открыт пользователем
+  } else if (!HasMemoryFor(file, cache_.GetBudget())) {
+    ++skipped_;
+  } else {
+    FileStamp stamp = FileStamp::Of(file);
+    ObjLoader loader(file);
+    loader.SetCacheDir(MeshCache::DefaultCacheDir());
+    loader.SetCancellationToken(token);
+    try {
+      loader.Load();
+    } catch (std::exception &error) {
+      qDebug() << "ModelPrefetcher:" << error.what();
+    }
+    if (loader.IsLoaded() && loader.GetErrors().empty() &&
+        !token.IsCancelled()) {
+      mesh = std::make_shared<const MeshData>(loader.TakeData());
+      cache_.Insert(file, stamp, mesh);
+      ++completed_;
+    }
+  }
+  return mesh;
+}
+
+}  // namespace s21
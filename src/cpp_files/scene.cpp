@@ -5,8 +5,8 @@ namespace s21 {
 /**
  * @brief Базовый конструктор, заполнение данных начальными занчениями
  */
-Scene::Scene() {
-  model_ = std::make_unique<Model3D>();
+Scene::Scene() : jobs_(std::make_unique<JobSystem>()) {
+  model_ = std::make_shared<Model3D>();
   camera_ = std::make_unique<Camera>();
   projection_ = std::make_unique<Projection>();
 
@@ -16,51 +16,339 @@ Scene::Scene() {
   InitialMVPMatrix();
 }
 
+/**
+ * @brief Сборка заднего слота из разобранной модели. Вызывается в рабочем
+ * потоке: копирование данных, габариты и преобразование в формат OpenGL не
+ * задерживают поток gui.
+ */
+std::shared_ptr<ModelSlot> ModelSlot::Build(const MeshData &mesh) {
+  TraceScope trace("ModelSlot::Build", "scene");
+  auto slot = std::make_shared<ModelSlot>();
+  slot->model = std::make_shared<Model3D>();
+  slot->model->SetData(mesh.vertices, mesh.faces, mesh.edges);
+  slot->model->CalculateBoundingBox();
+  std::vector<float> vertices = slot->model->GetVerticesToGlFormat();
+  std::vector<unsigned int> edges = slot->model->GetEdgesToGlFormat();
+  auto clusters = std::make_shared<const EdgeClusters>(
+      EdgeClusters::Build(vertices, edges));
+  auto gl_data =
+      std::make_shared<Model3DDataGl>(std::move(vertices), std::move(edges));
+  gl_data->clusters = std::move(clusters);
+  slot->gl_data = std::move(gl_data);
+  return slot;
+}
+
 //________________________________________________________________________
 // чисто для проверки вывода содержимого распаршеного obj файла
 
 void Scene::LoadModelNoThread(const std::string &obj_file_name) {
   ObjLoader loader(obj_file_name);
   loader.Load();
-  is_model_displayed_ = true;
-  ModelLoaded(loader.GetVertices(), loader.GetFaces(), loader.GetEdges());
+  std::shared_ptr<ModelSlot> slot = ModelSlot::Build(loader.TakeData());
+  swap_model_slot_(*slot, obj_file_name, false);
 }
 
-void Scene::LoadModelMemento() {
-  ObjLoader loader(current_file_path_);
-  loader.Load();
+// ________________________________________________________________________
+
+/**
+ * @brief Восстановление модели из сохраненной сессии. Файл читается в пуле
+ * потоков так же, как при обычной загрузке, окно при этом уже отвечает.
+ * Преобразования и проекция из SceneMemento к этому моменту уже записаны в
+ * сцену и применяются, когда модель загрузится (см. LoadedMemento).
+ */
+void Scene::LoadModelMemento() { start_load_job_(current_file_path_, true); }
+
+void Scene::LoadModelThread(const std::string &obj_file_name) {
+  start_load_job_(obj_file_name, false);
+}
+
+/**
+ * @brief Загрузка модели в пуле потоков. Парсинг и сборка заднего слота
+ * (ModelSlot) идут в рабочем потоке, в потоке gui слот только меняется местами
+ * с показанной моделью. Если за время загрузки была запущена новая или
+ * загрузку отменили (CancelLoad), парсинг прерывается, а результат
+ * отбрасывается. Модель из кэша недавно открытых (ModelCache) не разбирается,
+ * в рабочем потоке из нее собирается только слот. Если файл сейчас
+ * загружается упреждающе, загрузка присоединяется к этой задаче, а не
+ * разбирает файл второй раз.
+ * @param restore true - восстановление сессии: сохраненные преобразования не
+ * сбрасываются, испускается LoadedMemento вместо Loaded
+ */
+void Scene::start_load_job_(const std::string &obj_file_name, bool restore) {
+  load_token_.Cancel();
+  size_t generation = ++load_generation_;
+  auto slot = std::make_shared<std::shared_ptr<ModelSlot>>();
+
+  std::shared_ptr<const MeshData> cached = model_cache_.Find(obj_file_name);
+  if (cached) {
+    auto error = std::make_shared<std::string>();
+    load_token_ = jobs_->Submit(
+        [cached, slot, error](const CancellationToken &) {
+          TraceScope trace("Scene::model_cache_hit", "scene");
+          try {
+            *slot = ModelSlot::Build(*cached);
+          } catch (std::exception &build_error) {
+            *error = build_error.what();
+          }
+        },
+        JobPriority::kHigh, this,
+        [this, slot, error, generation, obj_file_name,
+         restore](bool cancelled) {
+          if (!cancelled && generation == load_generation_) {
+            if (*slot) {
+              swap_model_slot_(**slot, obj_file_name, restore);
+            } else {
+              LoadError(*error);
+            }
+            emit LoadFinished();
+          }
+        });
+  } else {
+    auto loader = std::make_shared<ObjLoader>(obj_file_name);
+    loader->SetMode(load_mode_);
+    loader->SetCacheDir(MeshCache::DefaultCacheDir());
+    // прогресс приходит в поток gui через очередь, прогресс старых загрузок
+    // игнорируется
+    connect(loader.get(), &ObjLoader::Progress, this,
+            [this, generation](qint64 bytes_read, qint64 total_bytes) {
+              if (generation == load_generation_) {
+                emit LoadProgress(bytes_read, total_bytes);
+              }
+            });
+    // ошибки (см ObjLoader, там есть куча исключений, которые обрабатываются
+    // через emit) собираются в рабочем потоке и передаются в gui вместе с
+    // результатом
+    auto errors = std::make_shared<std::vector<std::string>>();
+    auto mesh = std::make_shared<std::shared_ptr<const MeshData>>();
+    // файл до разбора; модель, разобранную упреждающей загрузкой, та уже
+    // положила в кэш со своим FileStamp
+    auto stamp = std::make_shared<std::optional<FileStamp>>();
+    std::shared_ptr<PrefetchJob> prefetched =
+        prefetcher_.Claim(obj_file_name);
+
+    load_token_ = jobs_->Submit(
+        [loader, errors, mesh, stamp, slot, prefetched,
+         obj_file_name](const CancellationToken &token) {
+          if (prefetched) {
+            *mesh = prefetched->Join(token);
+          }
+          if (!*mesh) {
+            *stamp = FileStamp::Of(obj_file_name);
+            loader->SetCancellationToken(token);
+            QObject::connect(loader.get(), &ObjLoader::LoadError,
+                             [errors](const std::string &error_message) {
+                               errors->push_back(error_message);
+                             });
+            try {
+              loader->Load();
+            } catch (std::exception &error) {
+              errors->push_back(error.what());
+            }
+            if (loader->IsLoaded() && !token.IsCancelled()) {
+              *mesh = std::make_shared<const MeshData>(loader->TakeData());
+            }
+          }
+          // исключение сборки (например, нехватка памяти) сообщается так
+          // же, как ошибки разбора, а не теряется в пуле
+          if (*mesh && !token.IsCancelled()) {
+            try {
+              *slot = ModelSlot::Build(**mesh);
+            } catch (std::exception &error) {
+              errors->push_back(error.what());
+            }
+          }
+        },
+        JobPriority::kHigh, this,
+        [this, errors, mesh, stamp, slot, generation, obj_file_name,
+         restore](bool cancelled) {
+          if (!cancelled && generation == load_generation_) {
+            for (const auto &error : *errors) {
+              LoadError(error);
+            }
+            if (*slot) {
+              swap_model_slot_(**slot, obj_file_name, restore);
+              // модели с пропущенными строками не кэшируются, чтобы при
+              // повторном открытии ошибки снова были показаны
+              if (errors->empty() && stamp->has_value()) {
+                model_cache_.Insert(obj_file_name, **stamp, *mesh);
+              }
+            }
+            emit LoadFinished();
+          }
+        });
+  }
+}
+
+/**
+ * @brief Замена показанной модели собранным задним слотом (в потоке gui).
+ * Модель меняется заменой указателя, после чего данные для OpenGL уходят в
+ * GLWidget сигналом Loaded/LoadedMemento, а прежняя модель освобождается в
+ * пуле потоков. Для больших моделей в фоне строятся уровни детализации.
+ */
+void Scene::swap_model_slot_(ModelSlot &slot, const std::string &obj_file_name,
+                             bool restore) {
+  TraceScope trace("Scene::swap_model_slot_", "scene");
+  std::swap(model_, slot.model);
+  current_file_path_ = obj_file_name;
+  need_to_calculate_far_ = true;
   is_model_displayed_ = true;
-  ModelLoadedMemento(loader.GetVertices(), loader.GetFaces(),
-                     loader.GetEdges());
+  if (restore) {
+    emit LoadedMemento(*slot.gl_data);
+  } else {
+    emit Loaded(*slot.gl_data);
+  }
+  ++model_generation_;
+  start_lod_job_(slot.gl_data);
+  start_feature_job_();
+  start_validation_job_();
+  release_model_slot_(slot);
+  prefetcher_.Prefetch(*jobs_, obj_file_name);
 }
 
-// ________________________________________________________________________
+/**
+ * @brief Построение уровней детализации (MeshLod) с низким приоритетом.
+ * Построение для прежней модели отменяется, результат для уже замененной
+ * модели отбрасывается.
+ */
+void Scene::start_lod_job_(std::shared_ptr<const Model3DDataGl> gl_data) {
+  lod_token_.Cancel();
+  if (MeshLod::IsNeeded(gl_data->edges.size() / 2)) {
+    size_t generation = model_generation_;
+    auto lod = std::make_shared<std::shared_ptr<const MeshLod>>();
+    lod_token_ = jobs_->Submit(
+        [gl_data, lod](const CancellationToken &token) mutable {
+          *lod = std::make_shared<const MeshLod>(
+              MeshLod::Build(gl_data->vertices, gl_data->edges, token));
+          // данные модели освобождаются здесь, а не в потоке gui
+          gl_data.reset();
+        },
+        JobPriority::kLow, this,
+        [this, lod, generation](bool cancelled) {
+          if (!cancelled && generation == model_generation_) {
+            emit LodReady(*lod);
+          }
+        });
+  }
+}
 
-void Scene::LoadModelThread(const std::string &obj_file_name) {
-  QThread *thread = new QThread();
-  ObjLoader *loader = new ObjLoader(obj_file_name);
+/**
+ * @brief Построение характерных ребер (FeatureEdges) показанной модели с
+ * низким приоритетом. Задача держит модель, поэтому замена модели во время
+ * построения безопасна, а результат для замененной модели отбрасывается.
+ */
+void Scene::start_feature_job_() {
+  feature_token_.Cancel();
+  if (is_feature_edges_enabled_ && is_model_displayed_ &&
+      features_generation_ != model_generation_) {
+    size_t generation = model_generation_;
+    std::shared_ptr<const Model3D> model = model_;
+    auto features = std::make_shared<std::shared_ptr<const FeatureEdges>>();
+    feature_token_ = jobs_->Submit(
+        [model, features](const CancellationToken &token) mutable {
+          std::shared_ptr<const MeshAdjacency> adjacency =
+              model->GetAdjacency();
+          *features = std::make_shared<const FeatureEdges>(
+              FeatureEdges::Build(model->GetVertices(), model->GetFaces(),
+                                  *adjacency,
+                                  FeatureEdges::kDefaultCreaseDegrees, token));
+          model.reset();
+        },
+        JobPriority::kLow, this,
+        [this, features, generation](bool cancelled) {
+          if (!cancelled && generation == model_generation_) {
+            features_generation_ = generation;
+            emit FeatureEdgesReady(*features);
+          }
+        });
+  }
+}
 
-  loader->moveToThread(thread);
-  // подключение парсинга при запуске потока
-  connect(thread, &QThread::started, loader, &ObjLoader::Load);
+/**
+ * @brief Проверка показанной модели (MeshValidation) с низким приоритетом.
+ * Смежность, построенная для проверки, освобождается после нее; если режим
+ * характерных ребер уже построил смежность модели, используется она.
+ */
+void Scene::start_validation_job_() {
+  validation_token_.Cancel();
+  size_t generation = model_generation_;
+  std::shared_ptr<const Model3D> model = model_;
+  auto validation = std::make_shared<std::shared_ptr<const MeshValidation>>();
+  validation_token_ = jobs_->Submit(
+      [model, validation](const CancellationToken &token) mutable {
+        *validation = std::make_shared<const MeshValidation>(
+            MeshValidation::Run(*model, token));
+        model.reset();
+      },
+      JobPriority::kLow, this,
+      [this, validation, generation](bool cancelled) {
+        if (!cancelled && generation == model_generation_) {
+          emit ValidationReady(*validation);
+        }
+      });
+}
 
-  // обработка, если загрузка была успешной (без ошибок тд)
-  connect(loader, &ObjLoader::Loaded, this, &Scene::ModelLoaded);
+/**
+ * @brief Освобождение прежней модели и данных для OpenGL в рабочем потоке:
+ * удаление больших векторов и множества ребер тоже занимает заметное время
+ */
+void Scene::release_model_slot_(ModelSlot &slot) {
+  auto released = std::make_shared<ModelSlot>(std::move(slot));
+  jobs_->Submit(
+      [released](const CancellationToken &) mutable {
+        TraceScope trace("Scene::release_model_slot_", "scene");
+        released.reset();
+      },
+      JobPriority::kLow);
+}
 
-  // обработка, если произошла ошибка (см ObjLoader, там есть куча исключений,
-  // которые обрабатываются через emit)
-  connect(loader, &ObjLoader::LoadError, this, &Scene::LoadError);
+/**
+ * @brief Отмена текущей загрузки. Парсер останавливается при ближайшей
+ * проверке токена, уже показанная модель остается на месте.
+ */
+void Scene::CancelLoad() {
+  load_token_.Cancel();
+  ++load_generation_;
+  emit LoadFinished();
+}
 
-  // Завершаем поток после успешной загрузки или ошибки
-  connect(loader, &ObjLoader::Loaded, thread, &QThread::quit);
-  connect(loader, &ObjLoader::LoadError, thread, &QThread::quit);
-  // Удаляем loader и thread после завершения потока
-  connect(thread, &QThread::finished, loader, &QObject::deleteLater);
-  connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+void Scene::SetLenientLoading(bool lenient) {
+  load_mode_ = lenient ? ObjLoadMode::kLenient : ObjLoadMode::kStrict;
+}
 
-  need_to_calculate_far_ = true;
-  is_model_displayed_ = true;
-  thread->start();
+/**
+ * @brief Включение режима характерных ребер. Ребра показанной модели
+ * строятся сразу, если еще не построены; после выключения они остаются у
+ * GLWidget до смены модели.
+ */
+void Scene::SetFeatureEdgesEnabled(bool enabled) {
+  is_feature_edges_enabled_ = enabled;
+  if (enabled) {
+    start_feature_job_();
+  }
+}
+
+/**
+ * @brief Включение упреждающей загрузки соседних файлов. Если модель уже
+ * открыта, ее соседи загружаются сразу.
+ */
+void Scene::SetPrefetchEnabled(bool enabled) {
+  prefetcher_.SetEnabled(enabled);
+  if (enabled && is_model_displayed_ && !current_file_path_.empty()) {
+    prefetcher_.Prefetch(*jobs_, current_file_path_);
+  }
+}
+
+/**
+ * @brief Соседний по имени .obj файл в каталоге текущей модели
+ * @param offset 1 - следующий, -1 - предыдущий
+ * @return пустая строка, если модели нет или соседа нет
+ */
+std::string Scene::GetNeighbourFile(int offset) {
+  std::string result;
+  if (!current_file_path_.empty()) {
+    result = prefetcher_.GetNeighbour(current_file_path_, offset);
+  }
+  return result;
 }
 
 void Scene::UpdateCamera(const Vector3D &target, const Vector3D &eye,
@@ -86,7 +374,7 @@ void Scene::UpdateProjection() {
   if (!IsPerspective()) {
     UpdateProjectionOrth(-16, 16, -12, 12);
   } else {
-    UpdateProjectionPersp(90, 4.0 / 3.0);
+    UpdateProjectionPersp(90, kProjectionAspect);
   }
 }
 
@@ -120,6 +408,22 @@ S21Matrix Scene::CreateMVPMatrix() {
                                           transformation_->GetMatrix());
 }
 
+/**
+ * @brief MVP матрица для плитки column, row при рендеринге изображения,
+ * разбитого на columns x rows плиток. Текущая проекция сначала перестраивается
+ * под соотношение сторон aspect всего изображения, затем из нее вырезается
+ * смещенная пирамида видимости плитки.
+ */
+S21Matrix Scene::CreateTileMVPMatrix(int column, int row, int columns,
+                                     int rows, double aspect) {
+  S21Matrix full_proj = transformation_->CreateProjMatrixAspect(
+      get_proj_matrix_(), kProjectionAspect, aspect);
+  S21Matrix tile_proj = transformation_->CreateProjMatrixTile(
+      full_proj, column, row, columns, rows);
+  return transformation_->CreateMVPMatrix(
+      tile_proj, camera_->GetViewMatrix(), transformation_->GetMatrix());
+}
+
 Model3DDataGl Scene::GetModelAsGLData() {
   return Model3DDataGl(model_->GetVerticesToGlFormat(),
                        model_->GetEdgesToGlFormat());
@@ -142,6 +446,12 @@ size_t Scene::GetEdgesCount() { return model_->GetEdgesCount(); }
 
 size_t Scene::GetVerticesCount() { return model_->GetVerticesCount(); }
 
+void Scene::AccountMemory(MemoryStats &stats) const {
+  model_->AccountMemory(stats);
+  model_cache_.AccountMemory(stats);
+  prefetcher_.AccountMemory(stats);
+}
+
 void Scene::SetMemento(SceneMemento &memento) {
   current_file_path_ = memento.GetFilePath();
 
@@ -164,34 +474,11 @@ bool Scene::IsModelDisplayed() { return is_model_displayed_; }
 ////////////////////////////////////////////////////////////////////////////////
 // слоты для загрузки модели
 
-void Scene::ModelLoaded(
-    const std::vector<Vector3D> &vertices,
-    const std::vector<std::vector<unsigned int>> &faces,
-    const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
-        &edges) {
-  model_->SetData(vertices, faces, edges);
-  model_->CalculateBoundingBox();
-  emit Loaded(Model3DDataGl(model_->GetVerticesToGlFormat(),
-                            model_->GetEdgesToGlFormat()));
-}
-
-void Scene::ModelLoadedMemento(
-    const std::vector<Vector3D> &vertices,
-    const std::vector<std::vector<unsigned int>> &faces,
-    const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
-        &edges) {
-  model_->SetData(vertices, faces, edges);
-  model_->CalculateBoundingBox();
-  emit LoadedMemento(Model3DDataGl(model_->GetVerticesToGlFormat(),
-                                   model_->GetEdgesToGlFormat()));
-}
-
 void Scene::LoadError(const std::string &error_message) {
   emit ErrorLoad(error_message);
 }
 
 void Scene::ProcessObjLoad(std::string &file_path) {
-  current_file_path_ = file_path;
   LoadModelThread(file_path);
 }
 
@@ -337,7 +624,7 @@ S21Matrix Scene::update_proj_orth_temp_(double far) {
 S21Matrix Scene::update_proj_persp_temp_(double far) {
   AffineTransDecorator projection_matrix(
       std::make_unique<S21MatrixWrapper>(4, 4));
-  return projection_matrix.CreateProjMatrixPersp(90, 4.0 / 3.0,
+  return projection_matrix.CreateProjMatrixPersp(90, kProjectionAspect,
                                                  projection_->GetNear(), far);
 }
 
@@ -354,6 +641,10 @@ S21Matrix Scene::get_proj_matrix_temp_(double far) {
 
 ////////////////////////////////////////////////////////////////////////////////
 // слоты для обработки смены типа проекции от gui
+JobSystem &Scene::GetJobSystem() { return *jobs_; }
+
+ModelCache &Scene::GetModelCache() { return model_cache_; }
+
 void Scene::ProcessChangeProjection() {
   if (is_model_displayed_) {
     switch_projection_();
@@ -362,10 +653,54 @@ void Scene::ProcessChangeProjection() {
 }
 
 void Scene::CreatingGifFromJpegs(int target_frames, QString &gif_fr_path,
-                                 QString gif_target_path, double anim_delay) {
+                                 QString gif_target_path, double anim_delay,
+                                 qint64 record_started_ms) {
+  start_gif_job_([=]() mutable {
+    return std::make_unique<GifCreator>(target_frames, gif_fr_path,
+                                        gif_target_path, anim_delay,
+                                        record_started_ms);
+  });
+}
+
+/**
+ * @brief Запуск сборки gif из кольцевого буфера. Вызывается в момент начала
+ * записи: поток кодировщика забирает кадры по мере их захвата и завершается
+ * после закрытия буфера. Все время записи он ждет кадры, поэтому работает в
+ * отдельном потоке, а не занимает поток пула.
+ */
+void Scene::StartGifEncoding(std::shared_ptr<FrameRingBuffer> frames,
+                             QString gif_target_path, double anim_delay,
+                             qint64 record_started_ms) {
+  start_gif_thread_(new GifCreator(frames, gif_target_path, anim_delay,
+                                   record_started_ms));
+}
+
+/**
+ * @brief Сборка gif в пуле потоков с низким приоритетом. GifCreator создается
+ * прямо в рабочем потоке, ошибка передается в gui после завершения задачи.
+ */
+void Scene::start_gif_job_(
+    std::function<std::unique_ptr<GifCreator>()> creator) {
+  auto error = std::make_shared<std::string>();
+  jobs_->Submit(
+      [creator, error](const CancellationToken &) {
+        std::unique_ptr<GifCreator> gif_creator = creator();
+        QObject::connect(gif_creator.get(), &GifCreator::GifError,
+                         [error](const std::string &error_message) {
+                           *error = error_message;
+                         });
+        gif_creator->CreateGif();
+      },
+      JobPriority::kLow, this,
+      [this, error](bool) {
+        if (!error->empty()) {
+          LoadError(*error);
+        }
+      });
+}
+
+void Scene::start_gif_thread_(GifCreator *creator) {
   QThread *thread = new QThread();
-  GifCreator *creator =
-      new GifCreator(target_frames, gif_fr_path, gif_target_path, anim_delay);
 
   creator->moveToThread(thread);
 
@@ -373,8 +708,8 @@ void Scene::CreatingGifFromJpegs(int target_frames, QString &gif_fr_path,
 
   connect(creator, &GifCreator::GifError, this, &Scene::LoadError);
 
+  // Ok отправляется и после ошибки
   connect(creator, &GifCreator::Ok, thread, &QThread::quit);
-  connect(creator, &GifCreator::GifError, thread, &QThread::quit);
 
   connect(thread, &QThread::finished, creator, &QObject::deleteLater);
   connect(thread, &QThread::finished, thread, &QObject::deleteLater);
@@ -0,0 +1,81 @@
+#include "../include/session_store.h"
+
+namespace s21 {
+
+SessionStore::SessionStore(QString path) : path_(path) {}
+
+quint64 SessionStore::NextGeneration() { return ++next_generation_; }
+
+/**
+ * @brief Атомарная запись снимка. Снимок пропускается, если уже записан более
+ * новый.
+ * @return true - снимок записан
+ */
+bool SessionStore::Write(const QByteArray &data, quint64 generation) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  bool result = false;
+  if (generation > written_generation_) {
+    QSaveFile file(path_);
+    if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() &&
+        file.commit()) {
+      written_generation_ = generation;
+      result = true;
+    } else {
+      qDebug() << "SessionStore::Write(): failed to write session to" << path_;
+    }
+  }
+  return result;
+}
+
+QByteArray SessionStore::Read() const {
+  QByteArray data;
+  QFile file(path_);
+  if (file.open(QIODevice::ReadOnly)) {
+    data = file.readAll();
+    file.close();
+  }
+  return data;
+}
+
+bool SessionStore::Exists() const { return QFile::exists(path_); }
+
+QByteArray SessionStore::Serialize(SceneMemento &scene,
+                                   GLWidgetMemento &gl_widget) {
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_6_0);
+  out << kMagic << kVersion;
+  scene.WriteToStream(out);
+  gl_widget.WriteToStream(out);
+  return data;
+}
+
+/**
+ * @brief Чтение снимка сессии
+ * @throw std::invalid_argument - чужой файл, другая версия формата или
+ * поврежденные данные
+ */
+SessionSnapshot SessionStore::Deserialize(const QByteArray &data) {
+  QDataStream in(data);
+  in.setVersion(QDataStream::Qt_6_0);
+  quint32 magic = 0;
+  quint16 version = 0;
+  in >> magic >> version;
+  if (in.status() != QDataStream::Ok || magic != kMagic) {
+    throw std::invalid_argument(
+        "SessionStore::Deserialize(): data is not a session snapshot!");
+  }
+  if (version != kVersion) {
+    throw std::invalid_argument(
+        "SessionStore::Deserialize(): unsupported session format version!");
+  }
+  SceneMemento scene = SceneMemento::ReadFromStream(in);
+  GLWidgetMemento gl_widget = GLWidgetMemento::ReadFromStream(in);
+  if (in.status() != QDataStream::Ok) {
+    throw std::invalid_argument(
+        "SessionStore::Deserialize(): session data is corrupted!");
+  }
+  return SessionSnapshot{scene, gl_widget};
+}
+
+}  // namespace s21
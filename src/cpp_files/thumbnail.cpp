@@ -0,0 +1,71 @@
+#include "../include/thumbnail.h"
+
+namespace s21 {
+
+ThumbnailRenderer::ThumbnailRenderer(int width, int height)
+    : width_(width), height_(height) {
+  if (width <= 0 || height <= 0) {
+    throw std::invalid_argument(
+        "ThumbnailRenderer::ThumbnailRenderer(): incorrect thumbnail size!");
+  }
+}
+
+/**
+ * @brief Отрисовка ребер модели. Вершины поворачиваются вокруг центра рамки
+ * (сначала вокруг оси Y, затем вокруг оси X) и масштабируются так, чтобы
+ * повернутая модель целиком помещалась в изображение.
+ */
+QImage ThumbnailRenderer::Render(Model3D &model) const {
+  TraceScope trace("ThumbnailRenderer::Render", "batch");
+  QImage image(width_, height_, QImage::Format_RGB32);
+  image.fill(back_color_);
+
+  const std::vector<Vector3D> &vertices = model.GetVertices();
+  if (!vertices.empty()) {
+    BoundingBox box = model.GetBoundingBox();
+    Vector3D center((box.max.x + box.min.x) / 2, (box.max.y + box.min.y) / 2,
+                    (box.max.z + box.min.z) / 2);
+    const double yaw = yaw_deg_ * M_PI / 180.0;
+    const double pitch = pitch_deg_ * M_PI / 180.0;
+
+    std::vector<QPointF> projected(vertices.size());
+    double min_x = std::numeric_limits<double>::max(), max_x = -min_x;
+    double min_y = min_x, max_y = -min_x;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      Vector3D v = vertices[i] - center;
+      double x = v.x * std::cos(yaw) + v.z * std::sin(yaw);
+      double z = -v.x * std::sin(yaw) + v.z * std::cos(yaw);
+      double y = v.y * std::cos(pitch) - z * std::sin(pitch);
+      projected[i] = QPointF(x, y);
+      min_x = std::min(min_x, x);
+      max_x = std::max(max_x, x);
+      min_y = std::min(min_y, y);
+      max_y = std::max(max_y, y);
+    }
+
+    double extent = std::max(max_x - min_x, max_y - min_y);
+    double usable = std::min(width_, height_) * (1.0 - 2.0 * margin_);
+    double scale = extent > 0 ? usable / extent : 1.0;
+    double offset_x = width_ / 2.0 - (max_x + min_x) / 2.0 * scale;
+    double offset_y = height_ / 2.0 + (max_y + min_y) / 2.0 * scale;
+    for (auto &point : projected) {
+      // ось Y изображения направлена вниз
+      point = QPointF(offset_x + point.x() * scale,
+                      offset_y - point.y() * scale);
+    }
+
+    QVector<QLineF> lines;
+    lines.reserve(static_cast<qsizetype>(model.GetEdgesCount()));
+    for (const auto &edge : model.GetEdges()) {
+      lines.append(QLineF(projected[edge.first], projected[edge.second]));
+    }
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(line_color_, 1.0));
+    painter.drawLines(lines);
+    painter.end();
+  }
+  return image;
+}
+
+}  // namespace s21
@@ -0,0 +1,155 @@
+#include "../include/tiled_screenshot.h"
+
+namespace s21 {
+
+/**
+ * @brief Открытие файла и запись заголовка BMP
+ */
+void StripImageWriter::Open(const std::string &path, int width, int height) {
+  if (width <= 0 || height <= 0) {
+    throw std::invalid_argument(
+        "StripImageWriter::Open(): image size must be positive!");
+  }
+  width_ = width;
+  height_ = height;
+  rows_written_ = 0;
+  if (54 + row_stride_() * static_cast<size_t>(height_) > UINT32_MAX) {
+    throw std::length_error(
+        "StripImageWriter::Open(): image is too big for BMP format!");
+  }
+  out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!out_.is_open()) {
+    throw std::runtime_error("StripImageWriter::Open(): cannot open file " +
+                             path);
+  }
+  row_.assign(row_stride_(), 0);
+  write_header_();
+}
+
+/**
+ * @brief Запись очередной полосы (строки идут сверху вниз). Ширина полосы
+ * должна совпадать с шириной изображения.
+ */
+void StripImageWriter::WriteStrip(const QImage &strip) {
+  if (strip.width() != width_ || rows_written_ + strip.height() > height_) {
+    throw std::invalid_argument(
+        "StripImageWriter::WriteStrip(): strip does not fit the image!");
+  }
+  QImage frame = strip;
+  if (frame.format() != QImage::Format_RGB32 &&
+      frame.format() != QImage::Format_ARGB32 &&
+      frame.format() != QImage::Format_ARGB32_Premultiplied) {
+    frame = frame.convertToFormat(QImage::Format_RGB32);
+  }
+  for (int y = 0; y < frame.height(); ++y) {
+    const unsigned char *src = frame.constScanLine(y);
+    for (int x = 0; x < width_; ++x) {
+      row_[x * 3] = static_cast<char>(src[x * 4]);
+      row_[x * 3 + 1] = static_cast<char>(src[x * 4 + 1]);
+      row_[x * 3 + 2] = static_cast<char>(src[x * 4 + 2]);
+    }
+    out_.write(row_.data(), row_.size());
+  }
+  rows_written_ += frame.height();
+  if (!out_) {
+    throw std::runtime_error("StripImageWriter::WriteStrip(): write failed!");
+  }
+}
+
+void StripImageWriter::Close() {
+  if (out_.is_open()) {
+    out_.close();
+  }
+  if (rows_written_ != height_) {
+    throw std::runtime_error(
+        "StripImageWriter::Close(): image was not written completely!");
+  }
+}
+
+int StripImageWriter::GetRowsWritten() const { return rows_written_; }
+
+/**
+ * @brief Заголовки BITMAPFILEHEADER и BITMAPINFOHEADER. Высота записывается
+ * отрицательной - строки в файле идут сверху вниз, что позволяет писать
+ * полосы в порядке рендеринга. Разрешение - 300 dpi (для печати).
+ */
+void StripImageWriter::write_header_() {
+  const uint32_t image_size =
+      static_cast<uint32_t>(row_stride_() * static_cast<size_t>(height_));
+  const uint32_t pixels_per_meter = 11811;
+  out_.write("BM", 2);
+  write_u32_(54 + image_size);
+  write_u32_(0);
+  write_u32_(54);
+
+  write_u32_(40);
+  write_u32_(static_cast<uint32_t>(width_));
+  write_u32_(static_cast<uint32_t>(-height_));
+  write_u16_(1);
+  write_u16_(24);
+  write_u32_(0);
+  write_u32_(image_size);
+  write_u32_(pixels_per_meter);
+  write_u32_(pixels_per_meter);
+  write_u32_(0);
+  write_u32_(0);
+}
+
+void StripImageWriter::write_u16_(uint16_t value) {
+  char bytes[2] = {static_cast<char>(value & 0xFF),
+                   static_cast<char>((value >> 8) & 0xFF)};
+  out_.write(bytes, 2);
+}
+
+void StripImageWriter::write_u32_(uint32_t value) {
+  char bytes[4] = {static_cast<char>(value & 0xFF),
+                   static_cast<char>((value >> 8) & 0xFF),
+                   static_cast<char>((value >> 16) & 0xFF),
+                   static_cast<char>((value >> 24) & 0xFF)};
+  out_.write(bytes, 4);
+}
+
+size_t StripImageWriter::row_stride_() const {
+  return (static_cast<size_t>(width_) * 3 + 3) & ~static_cast<size_t>(3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// реализация TiledScreenshotSaver
+
+TiledScreenshotSaver::TiledScreenshotSaver(QString path, int width, int height)
+    : path_(path), width_(width), height_(height) {}
+
+void TiledScreenshotSaver::Start() {
+  try {
+    writer_.Open(path_.toStdString(), width_, height_);
+  } catch (std::exception &error) {
+    failed_ = true;
+    emit SaveError(error.what());
+  }
+}
+
+void TiledScreenshotSaver::WriteStrip(const QImage &strip) {
+  if (!failed_) {
+    try {
+      writer_.WriteStrip(strip);
+    } catch (std::exception &error) {
+      failed_ = true;
+      emit SaveError(error.what());
+    }
+  }
+  emit StripWritten();
+}
+
+void TiledScreenshotSaver::Finish() {
+  if (!failed_) {
+    try {
+      writer_.Close();
+      qDebug() << "Tiled screenshot saved to:" << path_;
+    } catch (std::exception &error) {
+      emit SaveError(error.what());
+    }
+  }
+  emit Finished(path_);
+}
+
+}  // namespace s21
@@ -0,0 +1,165 @@
+#include "../include/tracer.h"
+
+namespace s21 {
+
+Tracer &Tracer::Instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+/**
+ * @brief Включение трассировки по параметру --trace=файл или переменной
+ * окружения S21_TRACE=файл (параметр важнее)
+ * @return true - трассировка включена
+ */
+bool Tracer::StartFromEnvironment(int argc, char *argv[]) {
+  QString path = qEnvironmentVariable("S21_TRACE");
+  const std::string flag = "--trace=";
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], flag.c_str(), flag.size()) == 0) {
+      path = QString::fromLocal8Bit(argv[i] + flag.size());
+    }
+  }
+  if (!path.isEmpty()) {
+    Instance().Start(path);
+  }
+  return IsEnabled();
+}
+
+/**
+ * @brief Монотонное время от первого обращения к трассировке
+ */
+qint64 Tracer::NowNs() {
+  static const auto origin = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - origin)
+      .count();
+}
+
+/**
+ * @brief Короткий номер потока для поля tid (std::thread::id не число)
+ */
+int Tracer::CurrentThreadId() {
+  static std::atomic<int> next_id{1};
+  thread_local int id = next_id.fetch_add(1);
+  return id;
+}
+
+/**
+ * @brief Начало записи. Ранее собранные события удаляются.
+ * @param path файл для Stop(), пусто - события только накапливаются (ToJson)
+ */
+void Tracer::Start(const QString &path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  dropped_events_ = 0;
+  path_ = path;
+  NowNs();
+  enabled_.store(true);
+}
+
+/**
+ * @brief Окончание записи и сохранение файла (если он задан в Start)
+ * @return false - файл записать не удалось
+ */
+bool Tracer::Stop() {
+  enabled_.store(false);
+  bool result = true;
+  QString path;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path = path_;
+  }
+  if (!path.isEmpty()) {
+    QSaveFile file(path);
+    result = file.open(QIODevice::WriteOnly) &&
+             file.write(QJsonDocument(ToJson()).toJson(
+                 QJsonDocument::Compact)) >= 0 &&
+             file.commit();
+    if (!result) {
+      qDebug() << "Tracer: unable to write" << path;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Добавление завершенного интервала. После max_events_ событий новые
+ * отбрасываются, чтобы долгая сессия не съела память.
+ */
+void Tracer::AddEvent(const char *name, const char *category, qint64 start_ns,
+                      qint64 duration_ns) {
+  int thread_id = CurrentThreadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (events_.size() < max_events_) {
+    events_.push_back({name, category, start_ns, duration_ns, thread_id});
+  } else {
+    ++dropped_events_;
+  }
+}
+
+/**
+ * @brief Имя текущего потока в просмотрщике трассировки
+ */
+void Tracer::SetThreadName(const std::string &name) {
+  int thread_id = CurrentThreadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto same_thread = [thread_id](const std::pair<int, std::string> &item) {
+    return item.first == thread_id;
+  };
+  auto it =
+      std::find_if(thread_names_.begin(), thread_names_.end(), same_thread);
+  if (it == thread_names_.end()) {
+    thread_names_.emplace_back(thread_id, name);
+  } else {
+    it->second = name;
+  }
+}
+
+size_t Tracer::GetEventsCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_.size();
+}
+
+/**
+ * @brief События в формате Chrome trace event: интервалы (ph = "X") и имена
+ * потоков (ph = "M"), время в микросекундах
+ */
+QJsonObject Tracer::ToJson() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const qint64 pid = QCoreApplication::applicationPid();
+  QJsonArray trace_events;
+  for (const auto &[thread_id, name] : thread_names_) {
+    QJsonObject args;
+    args["name"] = QString::fromStdString(name);
+    QJsonObject metadata;
+    metadata["name"] = "thread_name";
+    metadata["ph"] = "M";
+    metadata["pid"] = pid;
+    metadata["tid"] = thread_id;
+    metadata["args"] = args;
+    trace_events.append(metadata);
+  }
+  for (const Event &event : events_) {
+    QJsonObject interval;
+    interval["name"] = event.name;
+    interval["cat"] = event.category;
+    interval["ph"] = "X";
+    interval["ts"] = event.start_ns / 1000.0;
+    interval["dur"] = event.duration_ns / 1000.0;
+    interval["pid"] = pid;
+    interval["tid"] = event.thread_id;
+    trace_events.append(interval);
+  }
+  QJsonObject trace;
+  trace["traceEvents"] = trace_events;
+  trace["displayTimeUnit"] = "ms";
+  if (dropped_events_ > 0) {
+    QJsonObject other_data;
+    other_data["dropped_events"] = static_cast<qint64>(dropped_events_);
+    trace["otherData"] = other_data;
+  }
+  return trace;
+}
+
+}  // namespace s21
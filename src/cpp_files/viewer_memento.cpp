@@ -98,6 +98,31 @@ GLWidgetMemento GLWidgetMemento::ReadFromJson(const QJsonObject &json) {
                          point_vertex_color);
 }
 
+/**
+ * @brief Двоичная сериализация для автосохранения сессии (см. SessionStore)
+ */
+void GLWidgetMemento::WriteToStream(QDataStream &out) {
+  out << line_color_ << back_color_ << line_width_ << is_line_solid_
+      << stipple_pattern_ << stipple_factor_ << point_vertex_size_
+      << show_point_vertex_ << is_point_vertex_round_ << point_vertex_color_;
+}
+
+GLWidgetMemento GLWidgetMemento::ReadFromStream(QDataStream &in) {
+  QVector4D line_color, back_color, point_vertex_color;
+  GLfloat line_width = 0, point_vertex_size = 0;
+  bool is_line_solid = true, show_point_vertex = false,
+       is_point_vertex_round = false;
+  GLushort stipple_pattern = 0;
+  GLint stipple_factor = 0;
+  in >> line_color >> back_color >> line_width >> is_line_solid >>
+      stipple_pattern >> stipple_factor >> point_vertex_size >>
+      show_point_vertex >> is_point_vertex_round >> point_vertex_color;
+  return GLWidgetMemento(line_color, back_color, line_width, is_line_solid,
+                         stipple_pattern, stipple_factor, point_vertex_size,
+                         show_point_vertex, is_point_vertex_round,
+                         point_vertex_color);
+}
+
 //______________________________________________________________________________
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -125,6 +150,48 @@ SceneMemento SceneMemento::ReadFromJson(const QJsonObject &json) {
   return SceneMemento(file_path, transformation, proj);
 }
 
+/**
+ * @brief Двоичная сериализация. В отличие от json матрицы проецирования не
+ * пишутся: они полностью задаются типом проекции, near и far и строятся
+ * заново при чтении.
+ */
+void SceneMemento::WriteToStream(QDataStream &out) {
+  out << QString::fromStdString(file_path_);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      out << transformation_(i, j);
+    }
+  }
+  out << projection_.IsPerspectiveProjection() << projection_.GetNear()
+      << projection_.GetFar();
+}
+
+SceneMemento SceneMemento::ReadFromStream(QDataStream &in) {
+  QString file_path;
+  in >> file_path;
+  S21Matrix transformation(4, 4);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      in >> transformation(i, j);
+    }
+  }
+  bool is_perspective = false;
+  double near = 0, far = 0;
+  in >> is_perspective >> near >> far;
+  if (in.status() != QDataStream::Ok) {
+    throw std::invalid_argument(
+        "SceneMemento::ReadFromStream(): session data is corrupted!");
+  }
+
+  Projection proj;
+  proj.SetNear(near);
+  proj.SetFar(far);
+  if (is_perspective) proj.SetPerspective();
+
+  std::string path = file_path.toStdString();
+  return SceneMemento(path, transformation, proj);
+}
+
 std::string SceneMemento::GetFilePath() { return file_path_; }
 
 S21Matrix SceneMemento::GetTransformationMatrix() { return transformation_; }
@@ -3,6 +3,9 @@
 
 #include "affine.h"
 #include "include_common.h"
+#include "job_system.h"
+#include "memory_stats.h"
+#include "tracer.h"
 
 namespace s21 {
 
@@ -16,9 +19,14 @@ struct PairHash {
   }
 };
 
+class EdgeClusters;
+class MeshAdjacency;
+
 struct Model3DDataGl {
   std::vector<float> vertices;
   std::vector<unsigned int> edges;
+  // участки ребер для отсечения (edge_clusters.h), нет - ребра рисуются все
+  std::shared_ptr<const EdgeClusters> clusters;
 
   Model3DDataGl(std::vector<float> verts, std::vector<unsigned int> edgs);
 };
@@ -28,6 +36,18 @@ struct BoundingBox {
   Vector3D min;
 };
 
+/**
+ * @brief Данные модели в том виде, в котором их отдает ObjLoader
+ */
+struct MeshData {
+  std::vector<Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash> edges;
+
+  void AccountMemory(MemoryStats &stats) const;
+  size_t GetBytes() const;
+};
+
 }  // namespace s21
 
 // без использования псевдонима ниже не получается зарегистрировать в Qt сложный
@@ -41,8 +61,20 @@ Q_DECLARE_METATYPE(unordered_set_pair_hash);
 
 namespace s21 {
 
+/**
+ * @brief Режим обработки ошибок при чтении .obj файла.
+ * kStrict - загрузка прерывается на первой ошибке, Loaded не испускается;
+ * kLenient - строки с ошибками пропускаются, ошибки (с номерами строк)
+ * собираются и в конце сообщаются одним LoadError, модель загружается.
+ */
+enum class ObjLoadMode { kStrict, kLenient };
+
 /**
  * @brief Класс для загрузки .obj файла не в основном потоке.
+ * @details Загрузку можно отменить через CancellationToken (проверяется раз в
+ * несколько тысяч строк), о ходе чтения сообщает сигнал Progress (смещение в
+ * байтах, не чаще, чем раз на 1% файла). Если задан каталог кэша и в нем есть
+ * действительный кэш файла (см. MeshCache), текст не разбирается вовсе.
  */
 class ObjLoader : public QObject {
   Q_OBJECT
@@ -52,6 +84,17 @@ class ObjLoader : public QObject {
   std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash> edges_;
   std::string obj_file_;
 
+  ObjLoadMode mode_ = ObjLoadMode::kStrict;
+  CancellationToken cancel_token_;
+  std::vector<std::string> errors_;
+  bool is_loaded_ = false;
+  bool is_cancelled_ = false;
+  QString cache_dir_;  // каталог двоичных кэшей (MeshCache), пусто - без кэша
+  bool is_from_cache_ = false;
+
+  const size_t cancel_check_lines_ = 4096;
+  const size_t max_reported_errors_ = 10;
+
  public:
   ObjLoader();
   ObjLoader(const std::string &file, QObject *parent = nullptr);
@@ -61,6 +104,15 @@ class ObjLoader : public QObject {
   const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash> &
   GetEdges();
 
+  void SetMode(ObjLoadMode mode);
+  void SetCancellationToken(const CancellationToken &token);
+  void SetCacheDir(const QString &cache_dir);
+  const std::vector<std::string> &GetErrors() const;
+  bool IsLoaded() const;
+  bool IsCancelled() const;
+  bool IsFromCache() const;
+  MeshData TakeData();
+
  public slots:
   void Load();
 
@@ -70,8 +122,14 @@ class ObjLoader : public QObject {
               const std::unordered_set<std::pair<unsigned int, unsigned int>,
                                        PairHash> &edges);
   void LoadError(const std::string &error_message);
+  void Progress(qint64 bytes_read, qint64 total_bytes);
 
  private:
+  bool load_from_cache_();
+  bool parse_stream_(std::istream &in, qint64 total_bytes);
+  void parse_line_(const std::string &line);
+  void report_load_errors_();
+  void throw_format_error_(const std::string &message) const;
   bool is_vertex_(const std::string &line) const;
   bool is_face_(const std::string &line) const;
   void add_vertex_(const std::string &line);
@@ -98,6 +156,12 @@ class Model3D {
   std::vector<std::vector<unsigned int>> faces_;
   std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash> edges_;
   BoundingBox box_;
+  // смежность строится при первом запросе (GetAdjacency) и может
+  // запрашиваться из рабочих потоков, поэтому защищена мьютексами: первый
+  // держится на время построения, второй - только при обращении к указателю
+  mutable std::mutex adjacency_build_mutex_;
+  mutable std::mutex adjacency_mutex_;
+  mutable std::shared_ptr<const MeshAdjacency> adjacency_;
 
  public:
   Model3D() = default;
@@ -111,13 +175,23 @@ class Model3D {
   std::vector<float> GetVerticesToGlFormat();
   std::vector<unsigned int> GetEdgesToGlFormat();
 
-  const std::vector<Vector3D> &GetVertices();
-  const std::vector<std::vector<unsigned int>> &GetFaces();
+  const std::vector<Vector3D> &GetVertices() const;
+  const std::vector<std::vector<unsigned int>> &GetFaces() const;
   const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash> &
   GetEdges();
   const BoundingBox GetBoundingBox();
   size_t GetEdgesCount();
   size_t GetVerticesCount();
+  std::shared_ptr<const MeshAdjacency> GetAdjacency() const;
+  bool HasAdjacency() const;
+
+  void AccountMemory(MemoryStats &stats) const;
+  static void AccountMeshMemory(
+      const std::vector<Vector3D> &vertices,
+      const std::vector<std::vector<unsigned int>> &faces,
+      const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
+          &edges,
+      MemoryStats &stats);
 };
 
 }  // namespace s21
@@ -144,6 +144,10 @@ class AffineTransDecorator : public MatrixDecorator {
                                  double top, double near, double far);
   S21Matrix CreateMVPMatrix(const S21Matrix &projection, const S21Matrix &view,
                             const S21Matrix &model);
+  S21Matrix CreateProjMatrixTile(const S21Matrix &projection, int column,
+                                 int row, int columns, int rows);
+  S21Matrix CreateProjMatrixAspect(const S21Matrix &projection, double aspect,
+                                   double target_aspect);
 
  private:
   void create_rotation_mat_(S21Matrix &rot_matrix, double t, double cosine,
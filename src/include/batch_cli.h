@@ -0,0 +1,102 @@
+#ifndef BATCH_CLI_H
+#define BATCH_CLI_H
+
+#include "3dmodel.h"
+#include "include_common.h"
+#include "job_system.h"
+#include "mesh_cache.h"
+#include "mesh_validation.h"
+#include "thumbnail.h"
+
+namespace s21 {
+
+/**
+ * @brief Параметры пакетной обработки моделей
+ */
+struct BatchOptions {
+  std::vector<QString> files;
+  QString cache_dir;      // пусто - двоичный кэш не пишется
+  QString thumbnail_dir;  // пусто - миниатюры не рисуются
+  int thumbnail_size = 256;
+  size_t threads = JobSystem::DefaultWorkersCount();
+  ObjLoadMode mode = ObjLoadMode::kStrict;
+  bool skip_valid_cache = false;  // не разбирать файлы с актуальным кэшем
+  bool validate = false;          // проверять модели (MeshValidation)
+};
+
+/**
+ * @brief Результат обработки одного файла
+ */
+struct BatchResult {
+  QString file;
+  bool loaded = false;
+  bool skipped = false;  // кэш и миниатюра актуальны, файл не разбирался
+  std::vector<std::string> errors;
+  size_t vertices = 0;
+  size_t edges = 0;
+  size_t faces = 0;
+  BoundingBox box;
+  qint64 bytes = 0;
+  qint64 elapsed_ms = 0;
+  QString cache_path;
+  QString thumbnail_path;
+  MemoryStats memory;  // память модели после загрузки
+  bool validated = false;
+  MeshValidation validation;
+};
+
+/**
+ * @brief Параллельная загрузка .obj файлов без gui. Каждый файл разбирается
+ * своим ObjLoader в пуле потоков (JobSystem), результаты складываются в том же
+ * порядке, в котором файлы были переданы. Кэш пишется только для файлов,
+ * прочитанных без ошибок.
+ */
+class BatchProcessor {
+ private:
+  BatchOptions options_;
+
+ public:
+  explicit BatchProcessor(BatchOptions options);
+
+  std::vector<BatchResult> Run();
+  static BatchResult ProcessFile(const QString &file,
+                                 const BatchOptions &options,
+                                 const CancellationToken &token);
+
+  static std::vector<QString> CollectObjFiles(const QString &path);
+  static QJsonObject ResultToJson(const BatchResult &result);
+  static QJsonObject ReportToJson(const std::vector<BatchResult> &results,
+                                  const BatchOptions &options,
+                                  qint64 elapsed_ms);
+
+ private:
+  static void load_file_(const BatchOptions &options,
+                         const CancellationToken &token, BatchResult &result);
+};
+
+/**
+ * @brief Консольные режимы: 3d_viewer --batch [параметры] файлы и каталоги, а
+ * также отдельная программа obj_converter (прогрев кэша для каталогов с
+ * моделями). Окно не создается и дисплей не нужен, отчет выводится в stdout в
+ * формате json.
+ */
+class BatchCli {
+ public:
+  static bool IsBatchMode(int argc, char *argv[]);
+  static BatchOptions ParseArguments(const QStringList &arguments,
+                                     BatchOptions options = BatchOptions());
+  static int Run(const QStringList &arguments);
+  static int RunConverter(const QStringList &arguments);
+  static QString Usage();
+  static QString ConverterUsage();
+  static bool IsLoadTooLarge(const BatchOptions &options, size_t &predicted,
+                             size_t &available);
+
+ private:
+  static int run_(const QStringList &arguments, const BatchOptions &defaults,
+                  const QString &usage);
+};
+
+}  // namespace s21
+
+#endif
@@ -5,6 +5,7 @@
 #include "include_common.h"
 #include "include_gui_common.h"
 #include "scene.h"
+#include "session_store.h"
 
 namespace s21 {
 
@@ -14,7 +15,16 @@ class Controller : public QObject {
   std::unique_ptr<Scene> model_;
   std::unique_ptr<MainWindow> view_;
   std::string json_dir_ = "logs";
-  std::string json_path_ = "logs/state.json";
+  std::string json_path_ = "logs/state.json";  // формат прошлых версий
+  std::string state_path_ = "logs/state.bin";
+
+  /*
+    автосохранение: после каждого изменения сцены таймер перезапускается,
+    снимок пишется в фоне, когда изменения затихли на autosave_delay_ms_
+  */
+  std::shared_ptr<SessionStore> session_store_;
+  QTimer *autosave_timer_;
+  const int autosave_delay_ms_ = 1000;
 
  public:
   Controller(std::unique_ptr<Scene> model, std::unique_ptr<MainWindow> view);
@@ -27,19 +37,37 @@ class Controller : public QObject {
 
  private slots:
   void save_state_();
+  void schedule_autosave_();
+  void autosave_();
+  void export_state_(QString file_path);
+  void import_state_(QString file_path);
+  void handle_obj_load_(std::string &file_path);
+  void handle_step_model_(int offset);
   void handle_model_loaded_(const Model3DDataGl &gl_data);
   void handle_model_loaded_memento_(const Model3DDataGl &gl_data);
   void handle_load_error_(const std::string &error_message);
+  void handle_load_progress_(qint64 bytes_read, qint64 total_bytes);
+  void handle_load_finished_();
+  void handle_lod_ready_(std::shared_ptr<const MeshLod> lod);
+  void handle_feature_edges_ready_(
+      std::shared_ptr<const FeatureEdges> features);
+  void handle_validation_ready_(
+      std::shared_ptr<const MeshValidation> validation);
 
   void handle_update_mvp_();
   void handle_update_temp_mvp_(S21MatrixWrapper &mvp);
+  void handle_tiled_screenshot_(QString file_path, int tiles, double aspect);
 
  private:
   void connect_transl_sig_slots_();
   void connect_rotation_sig_slots_();
   void connect_scale_sig_slots_();
+  void update_memory_info_();
 
   void check_json_dir_();
+  QByteArray create_snapshot_();
+  bool load_json_state_(const QString &file_path);
+  void apply_state_(SceneMemento &sc_memento, GLWidgetMemento &gl_memento);
 };
 
 }  // namespace s21
@@ -0,0 +1,64 @@
+#ifndef EDGE_CLUSTERS_H
+#define EDGE_CLUSTERS_H
+
+#include "3dmodel.h"
+#include "affine.h"
+#include "include_common.h"
+#include "interaction_quality.h"
+
+namespace s21 {
+
+/**
+ * @brief Участок буфера ребер и рамка вершин его ребер
+ */
+struct EdgeCluster {
+  size_t first_edge = 0;  // номер первого ребра (пары индексов) в буфере
+  size_t edges_count = 0;
+  BoundingBox box;
+};
+
+/**
+ * @brief Разбиение буфера ребер на пространственно связные участки для
+ * отсечения по пирамиде видимости. Ребра сортируются по коду Мортона
+ * (Z-кривая) своей середины и режутся на участки по kClusterEdges ребер:
+ * соседние по Z-кривой ребра лежат рядом в пространстве, поэтому рамки
+ * участков небольшие. Внутри участка ребра переставлены
+ * InteractionQuality::StrideOrder, и начало каждого участка - равномерная
+ * выборка из него.
+ * @details Коды и рамки считаются параллельно (OpenMP), разбиение строится в
+ * рабочем потоке вместе с задним слотом сцены. При отрисовке участки
+ * проверяются против шести плоскостей пирамиды, взятых из матрицы MVP, и
+ * видимые рисуются одним glMultiDrawElements.
+ */
+class EdgeClusters {
+ public:
+  static constexpr size_t kClusterEdges = 8192;
+  static constexpr int kMortonBits = 10;  // бит на ось, сетка 1024^3
+
+ private:
+  std::vector<EdgeCluster> clusters_;
+  size_t edges_count_ = 0;
+
+ public:
+  EdgeClusters() = default;
+
+  static EdgeClusters Build(const std::vector<float> &vertices,
+                            std::vector<unsigned int> &edges);
+  static std::array<std::array<double, 4>, 6> FrustumPlanes(
+      const IMatrix &mvp);
+  static bool IsBoxVisible(const std::array<std::array<double, 4>, 6> &planes,
+                           const BoundingBox &box);
+
+  void Cull(const IMatrix &mvp, std::vector<size_t> &visible) const;
+
+  const std::vector<EdgeCluster> &GetClusters() const;
+  size_t GetEdgesCount() const;
+  size_t GetBytes() const;
+
+ private:
+  static std::uint32_t spread_bits_(std::uint32_t value);
+};
+
+}  // namespace s21
+
+#endif
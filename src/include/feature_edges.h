@@ -0,0 +1,66 @@
+#ifndef FEATURE_EDGES_H
+#define FEATURE_EDGES_H
+
+#include "3dmodel.h"
+#include "affine.h"
+#include "include_common.h"
+#include "job_system.h"
+#include "mesh_adjacency.h"
+
+namespace s21 {
+
+/**
+ * @brief Тип ребра по смежным граням
+ */
+enum class EdgeKind : unsigned char {
+  kSmooth,       // две грани, угол между нормалями не больше порога
+  kCrease,       // две грани, угол между нормалями больше порога
+  kBoundary,     // одна грань
+  kNonManifold,  // больше двух граней
+};
+
+/**
+ * @brief Характерные ребра модели: границы, изломы и неманифолдные ребра не
+ * зависят от вида и считаются один раз, контур (ребра между лицевой и
+ * нелицевой гранями) пересчитывается при каждой смене вида. Вместе они
+ * намного реже полного каркаса и передают форму модели.
+ * @details Смежность ребер и граней берется из MeshAdjacency, нормали
+ * граней, типы ребер и контур считаются параллельно (OpenMP).
+ * Лицевая грань определяется по однородной точке камеры, взятой из матрицы
+ * MVP, и плоскости грани, поэтому одинаково работает в центральной и
+ * параллельной проекции.
+ */
+class FeatureEdges {
+ public:
+  static constexpr double kDefaultCreaseDegrees = 30.0;
+
+ private:
+  std::vector<unsigned int> feature_edges_;  // пары индексов вершин
+  std::vector<unsigned int> smooth_edges_;   // кандидаты в контур
+  std::vector<unsigned int> smooth_faces_;   // по две грани на ребро
+  std::vector<std::array<float, 4>> face_planes_;  // нормаль и смещение
+  std::array<size_t, 4> kind_counts_ = {0, 0, 0, 0};  // по EdgeKind
+
+ public:
+  FeatureEdges() = default;
+
+  static FeatureEdges Build(
+      const std::vector<Vector3D> &vertices,
+      const std::vector<std::vector<unsigned int>> &faces,
+      const MeshAdjacency &adjacency,
+      double crease_degrees = kDefaultCreaseDegrees,
+      const CancellationToken &token = CancellationToken());
+  static Vector3D FaceNormal(const std::vector<Vector3D> &vertices,
+                             const std::vector<unsigned int> &face);
+  static std::array<double, 4> CameraPoint(const IMatrix &mvp);
+
+  void Silhouette(const IMatrix &mvp, std::vector<unsigned int> &edges) const;
+
+  const std::vector<unsigned int> &GetFeatureEdges() const;
+  size_t GetCount(EdgeKind kind) const;
+  size_t GetBytes() const;
+};
+
+}  // namespace s21
+
+#endif
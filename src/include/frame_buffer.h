@@ -0,0 +1,69 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Сырой кадр без сжатия. Пиксели хранятся построчно сверху вниз по 4
+ * байта в порядке B, G, R, A (так лежат в памяти QImage::Format_RGB32 и
+ * QImage::Format_ARGB32 на little-endian), строки без выравнивания.
+ */
+struct RawFrame {
+  int width = 0;
+  int height = 0;
+  std::vector<unsigned char> pixels;
+
+  RawFrame() = default;
+  RawFrame(int w, int h);
+
+  void Resize(int w, int h);
+  void CopyFrom(const QImage &image);
+  QImage ToImage() const;
+  size_t GetBytes() const;
+};
+
+/**
+ * @brief Кольцевой буфер кадров для записи gif без обращения к диску. Слоты
+ * выделяются в конструкторе. Pop отдает получателю буфер пикселей слота, а
+ * слоту - новый буфер того же размера, выделенный в потоке кодировщика,
+ * поэтому Push в потоке gui память не выделяет (если размер кадра не
+ * меняется).
+ * @details Push вызывается из потока gui и никогда не блокирует: если
+ * кодировщик не успевает и буфер заполнен, кадр отбрасывается и учитывается в
+ * счетчике. Pop вызывается из потока кодировщика и ждет, пока не появится кадр
+ * или буфер не будет закрыт через Close().
+ */
+class FrameRingBuffer {
+ private:
+  std::vector<RawFrame> slots_;
+  int width_;  // размер кадра, под который выделяются буферы слотов
+  int height_;
+  size_t head_ = 0;  // слот, из которого будет прочитан следующий кадр
+  size_t tail_ = 0;  // слот, в который будет записан следующий кадр
+  size_t count_ = 0;
+  size_t pushed_ = 0;
+  size_t dropped_ = 0;
+  bool closed_ = false;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+
+ public:
+  FrameRingBuffer(size_t capacity, int width, int height);
+
+  bool Push(const QImage &image);
+  bool Pop(RawFrame &frame);
+  void Close();
+
+  size_t GetCapacity() const;
+  size_t GetSize() const;
+  size_t GetPushedCount() const;
+  size_t GetDroppedCount() const;
+  size_t GetAllocatedBytes() const;
+};
+
+}  // namespace s21
+
+#endif
@@ -1,10 +1,19 @@
 #ifndef GIF_CREATOR_H
 #define GIF_CREATOR_H
 
+#include "frame_buffer.h"
+#include "gif_encoder.h"
 #include "include_common.h"
+#include "tracer.h"
 
 namespace s21 {
 
+/**
+ * @brief Класс для сборки gif в фоновом потоке. Кадры берутся либо напрямую из
+ * кольцевого буфера FrameRingBuffer (основной путь, кадры не сжимаются и не
+ * пишутся на диск), либо из временных файлов (путь со сбросом кадров на диск,
+ * включается пользователем).
+ */
 class GifCreator : public QObject {
   Q_OBJECT
  private:
@@ -12,10 +21,14 @@ class GifCreator : public QObject {
   QString gif_frames_path_;
   QString gif_target_path_;
   double animation_delay_;
+  std::shared_ptr<FrameRingBuffer> frames_;
+  qint64 record_started_ms_;
 
  public:
   GifCreator(int target_frames, QString &gif_fr_path, QString gif_target_path,
-             double anim_delay);
+             double anim_delay, qint64 record_started_ms);
+  GifCreator(std::shared_ptr<FrameRingBuffer> frames, QString gif_target_path,
+             double anim_delay, qint64 record_started_ms);
   void CreateGif();
 
  signals:
@@ -23,9 +36,13 @@ class GifCreator : public QObject {
   void Ok();
 
  private:
+  void read_frames_from_buffer_(std::vector<RawFrame> &frames);
+  void read_frames_from_disk_(std::vector<RawFrame> &frames);
+  void add_frame_(std::vector<RawFrame> &frames, const QImage &image);
+  void print_record_stats_(size_t frames_count);
   void clear_jpegs_for_gif_();
 };
 
 }  // namespace s21
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,59 @@
+#ifndef GIF_ENCODER_H
+#define GIF_ENCODER_H
+
+#include "frame_buffer.h"
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Прямоугольник кадра, в котором он отличается от предыдущего
+ */
+struct FrameRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+
+  bool IsEmpty() const;
+};
+
+/**
+ * @brief Стадия кодирования gif. Строит одну общую палитру сразу для всех
+ * кадров (гистограмма считается параллельно через OpenMP), переводит кадры в
+ * эту палитру и для каждого кадра, кроме первого, оставляет только
+ * прямоугольник, изменившийся относительно предыдущего кадра.
+ * @details Каркасные модели рисуются небольшим количеством цветов и от кадра к
+ * кадру меняются слабо, поэтому общая палитра не теряет цвета, а кадры-разности
+ * заметно уменьшают размер файла.
+ */
+class GifFrameEncoder {
+ private:
+  static constexpr int kBinBits = 5;  // бит на канал в гистограмме
+  static constexpr size_t kBins = 1 << (3 * kBinBits);
+
+  size_t max_colors_;
+  std::vector<unsigned int> palette_;         // цвета в виде 0x00RRGGBB
+  std::vector<unsigned short> bin_palette_;  // ячейка гистограммы -> цвет
+
+ public:
+  explicit GifFrameEncoder(size_t max_colors = 256);
+
+  void BuildPalette(const std::vector<RawFrame> &frames);
+  void ApplyPalette(std::vector<RawFrame> &frames) const;
+  static FrameRect FindChangedRect(const RawFrame &prev, const RawFrame &cur);
+  std::vector<Magick::Image> Encode(std::vector<RawFrame> &frames,
+                                    double anim_delay);
+
+  const std::vector<unsigned int> &GetPalette() const;
+
+ private:
+  static size_t color_bin_(const unsigned char *pixel);
+  void build_bin_palette_();
+  static Magick::Image crop_frame_(const RawFrame &frame,
+                                   const FrameRect &rect);
+};
+
+}  // namespace s21
+
+#endif
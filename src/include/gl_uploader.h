@@ -0,0 +1,73 @@
+#ifndef GL_UPLOADER_H
+#define GL_UPLOADER_H
+
+#include "include_common.h"
+#include "include_gui_common.h"
+#include "tracer.h"
+
+namespace s21 {
+
+/**
+ * @brief Фоновая загрузка буферов модели в видеопамять. У загрузчика свой
+ * поток и свой контекст OpenGL, разделяющий объекты с контекстом GLWidget.
+ * Данные копируются частями по kChunkBytes, после каждой части ставится fence,
+ * и в очереди драйвера не бывает больше двух частей. Когда все части
+ * загружены, испускается Uploaded, а виджет в потоке gui только меняет
+ * буферы местами.
+ * @details Новая загрузка отменяет начатую: перед каждой частью проверяется,
+ * что номер загрузки еще последний. Отмененная загрузка ничего не испускает.
+ */
+class GlUploader : public QObject {
+  Q_OBJECT
+ public:
+  /**
+   * @brief Задание на загрузку: буферы, созданные в контексте виджета, и
+   * данные для них (данные не меняются, пока загрузчик их читает)
+   */
+  struct Request {
+    size_t generation = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    std::shared_ptr<const std::vector<float>> vertices;
+    std::shared_ptr<const std::vector<unsigned int>> indices;
+  };
+
+  static constexpr size_t kChunkBytes = 8 * 1024 * 1024;
+
+ private:
+  static constexpr GLuint64 kFenceTimeoutNs = 100'000'000;
+
+  QThread thread_;
+  QObject *worker_;  // живет в thread_, через него в поток передаются задания
+  std::unique_ptr<QOffscreenSurface> surface_;
+  std::unique_ptr<QOpenGLContext> context_;
+  std::atomic<size_t> latest_generation_{0};
+  bool is_valid_ = false;
+
+ public:
+  explicit GlUploader(QOpenGLContext *share_context);
+  ~GlUploader() override;
+
+  GlUploader(const GlUploader &) = delete;
+  GlUploader &operator=(const GlUploader &) = delete;
+
+  bool IsValid() const;
+  void Upload(Request request);
+  void Cancel();
+
+ signals:
+  void Uploaded(size_t generation, GLint vertex_bytes, GLint index_bytes);
+  void UploadFailed(size_t generation);
+
+ private:
+  void upload_(const Request &request);
+  bool upload_buffer_(QOpenGLExtraFunctions *gl, GLuint buffer,
+                      const void *data, size_t bytes, size_t generation,
+                      GLint &uploaded_bytes);
+  bool wait_fence_(QOpenGLExtraFunctions *gl, GLsync fence);
+  bool is_latest_(size_t generation) const;
+};
+
+}  // namespace s21
+
+#endif
@@ -3,8 +3,19 @@
 
 #include "3dmodel.h"
 #include "affine.h"
+#include "edge_clusters.h"
+#include "feature_edges.h"
+#include "frame_buffer.h"
+#include "gl_uploader.h"
+#include "image_encoder.h"
 #include "include_common.h"
 #include "include_gui_common.h"
+#include "interaction_quality.h"
+#include "mesh_lod.h"
+#include "mesh_validation.h"
+#include "projection.h"
+#include "tiled_screenshot.h"
+#include "tracer.h"
 #include "viewer_memento.h"
 
 namespace s21 {
@@ -32,6 +43,14 @@ class MainWindow : public QMainWindow {
     кнопки для изменения состояний
   */
   QPushButton *load_model_button_;  // кнопка для загрузки модели
+  QProgressBar *load_progress_;     // прогресс чтения файла модели
+  QPushButton *cancel_load_button_;  // отмена загрузки модели
+  QCheckBox *lenient_load_check_;  // пропускать строки с ошибками в .obj
+  QPushButton *previous_model_button_;  // соседние .obj файлы каталога
+  QPushButton *next_model_button_;
+  QCheckBox *prefetch_check_;  // упреждающая загрузка соседних файлов
+  QPushButton *export_state_button_;  // сохранение состояния в json
+  QPushButton *import_state_button_;  // восстановление состояния из json
 
   QPushButton *apply_trans_button_;  // кнопка для принятия преобразований по
                                      // перемещениям в работу
@@ -82,6 +101,8 @@ class MainWindow : public QMainWindow {
   */
   QLabel *file_name_;
   QLabel *count_info_;
+  QLabel *memory_info_;
+  QLabel *validation_info_;  // итог проверки модели (MeshValidation)
 
   /*
     кнопки  для изменения цвета линий
@@ -114,6 +135,7 @@ class MainWindow : public QMainWindow {
   */
   QPushButton *solid_line_;
   QPushButton *stipple_line_;
+  QCheckBox *feature_edges_check_;  // только характерные ребра и контур
 
   /*
     изменение толщины отобажаемой вершины
@@ -144,7 +166,10 @@ class MainWindow : public QMainWindow {
   */
   QPushButton *take_screenshot_button_;
   QPushButton *record_gif_button_;
+  QCheckBox *spill_gif_frames_check_;  // сбрасывать кадры gif на диск
+  QCheckBox *offline_gif_check_;  // запись gif без привязки к реальному времени
   QTimer *gif_shot_timer_;
+  QTimer *offline_gif_timer_;
   QString gif_frames_path_ =
       QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) +
       "/3DViewer_gif_frames";
@@ -159,18 +184,73 @@ class MainWindow : public QMainWindow {
   double gif_progress_;  // обозначение прогресса по созданию gif (сбор кадров
                          // (50))
 
+  /*
+    кадры gif по умолчанию копятся в кольцевом буфере и сразу уходят в поток
+    кодировщика, на диск они пишутся только при включенном spill
+  */
+  std::shared_ptr<FrameRingBuffer> gif_frames_;
+  // сжатие и запись скриншотов и кадров gif (spill) вне потока gui
+  std::unique_ptr<ImageEncodingService> image_encoder_;
+  const size_t gif_ring_capacity_ = 16;
+  bool spill_gif_frames_ = false;
+  qint64 record_started_ms_ = 0;
+  int stored_gif_frames_ = 0;  // кадры, уже забранные с видеокарты
+
+  /*
+    данные для offline записи: на каждый кадр gif анимация делает фиксированное
+    количество шагов, а кадр рисуется во внеэкранный буфер размером с gif
+  */
+  const int anim_steps_per_gif_frame_ =
+      static_cast<int>(frame_gif_interval_ / frame_interval_);
+  const int gif_frame_width_ = 640;
+  const int gif_frame_height_ = 480;
+  // пауза перед новой попыткой, пока буфер кадров заполнен кодировщиком
+  const int gif_ring_wait_ms_ = 5;
+
+  /*
+    данные для скриншота из плиток: изображение tiles x tiles плиток рисуется
+    по одной полосе (строке плиток) за тик таймера, полосы пишутся на диск в
+    отдельном потоке, в памяти не больше max_pending_strips_ полос
+  */
+  QSpinBox *screenshot_tiles_;  // количество плиток по каждой стороне
+  QTimer *tile_strip_timer_;
+  std::vector<S21MatrixWrapper> tile_mvps_;
+  // от StartTiledScreenshot до завершения записи (tiled_screenshot_finished_)
+  bool is_tiled_screenshot_running_ = false;
+  QThread *tile_save_thread_ = nullptr;
+  QString tile_file_path_;
+  int tiles_per_side_ = 1;
+  int next_tile_row_ = 0;
+  int pending_strips_ = 0;
+  const int max_pending_strips_ = 2;
+  const int tile_width_ = 1024;
+  const int tile_height_ = 768;
+  const int max_tiles_per_side_ = 8;
+
  public:
   MainWindow(QWidget *parent = nullptr);
   ~MainWindow();
 
   void SetModelData(const Model3DDataGl &gl_data);
+  void SetLodLevels(std::shared_ptr<const MeshLod> lod);
+  void SetFeatureEdges(std::shared_ptr<const FeatureEdges> features);
   void SetMVPMatrix(const S21MatrixWrapper &mvp);
   void SetModelInfo(const std::string &file_name, size_t edges,
                     size_t vertices);
+  void SetMemoryInfo(const MemoryStats &stats);
+  void SetValidation(std::shared_ptr<const MeshValidation> validation);
+  void AccountMemory(MemoryStats &stats) const;
+  bool ConfirmLargeLoad(size_t predicted_bytes, size_t available_bytes);
 
   void SetMemento(GLWidgetMemento &memento);
   GLWidgetMemento CreateMemento();
 
+  void SetLoadProgress(qint64 bytes_read, qint64 total_bytes);
+  void HideLoadProgress();
+
+  void StartTiledScreenshot(QString file_path, int tiles,
+                            const std::vector<S21MatrixWrapper> &tile_mvps);
+
  signals:
   void ApplyTranslationClicked(QString tx_s, QString ty_s, QString tz_s);
   void ProcessTranslation_fps(double tx, double ty, double tz);
@@ -184,13 +264,30 @@ class MainWindow : public QMainWindow {
   void ProcessScaling_fps(double scale_value);
 
   void ProcessObjLoad(std::string &file_path);
+  void CancelLoadClicked();
+  void LenientLoadingChanged(bool lenient);
+  void StepModelClicked(int offset);
+  void PrefetchChanged(bool enabled);
+  void FeatureEdgesChanged(bool enabled);
 
   void ProcessChangeProjection();
 
   void AppAboutToQuit();
 
   void CreateGifFromJpegs(int target_frames, QString &gif_fr_path,
-                          QString gif_target_path, double anim_delay);
+                          QString gif_target_path, double anim_delay,
+                          qint64 record_started_ms);
+  void StartGifEncoding(std::shared_ptr<FrameRingBuffer> frames,
+                        QString gif_target_path, double anim_delay,
+                        qint64 record_started_ms);
+
+  void TiledScreenshotRequested(QString file_path, int tiles, double aspect);
+  void TileStripReady(const QImage &strip);
+  void TiledScreenshotRendered();
+
+  void ViewStateChanged();  // изменились настройки отображения
+  void ExportStateRequested(QString file_path);
+  void ImportStateRequested(QString file_path);
 
  public slots:
   void StartTranslModel_fps(double tx, double ty, double tz);
@@ -219,6 +316,7 @@ class MainWindow : public QMainWindow {
   void change_line_color_();
   void change_line_width_();
   void change_line_type_();
+  void change_feature_edges_mode_(bool enabled);
   void change_back_color_();
 
   void change_vertex_color_();
@@ -228,7 +326,15 @@ class MainWindow : public QMainWindow {
   void take_screenshot_();
   void record_gif_anim_();
   void take_picture_gif_();
+  void take_offline_gif_frame_();
   void obj_load_clicked_();
+  void export_state_clicked_();
+  void import_state_clicked_();
+
+  void render_tile_strip_();
+  void tile_strip_written_();
+  void tiled_screenshot_finished_();
+  void tiled_screenshot_error_(const std::string &error_message);
 
  private:
   void connect_all_();
@@ -266,6 +372,7 @@ class MainWindow : public QMainWindow {
   void set_input_validation_();
 
   void check_timers_();
+  void update_animating_();
   bool need_to_stop_();
 
   void stop_scale_animation_();
@@ -279,6 +386,15 @@ class MainWindow : public QMainWindow {
   void clear_jpegs_for_gif_();
 
   void stop_gif_creating_();
+  void start_offline_gif_recording_();
+  void step_animations_(int steps);
+  void block_animation_timers_(bool block);
+
+  void store_gif_frame_(QImage frame);
+
+  void take_tiled_screenshot_();
+  void start_tiled_save_thread_(const QString &file_path);
+  void stop_tiled_screenshot_();
 };
 
 /**
@@ -290,10 +406,80 @@ class MainWindow : public QMainWindow {
 class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_0 {
   Q_OBJECT
  private:
-  GLuint vbo_;  // буффер Vertex Buffer Object
-  GLuint ebo_;  // буффер Element Buffer Object для ребер
-  std::vector<float> vertices_;
-  std::vector<unsigned int> edges_;
+  /**
+   * @brief Буферы одной модели в видеопамяти
+   */
+  struct ModelBuffers {
+    GLuint vbo = 0;  // буффер Vertex Buffer Object
+    GLuint ebo = 0;  // буффер Element Buffer Object для ребер
+    GLsizei vertices_count = 0;
+    GLsizei indices_count = 0;
+    GLint vertex_bytes = 0;  // размеры в видеопамяти (GL_BUFFER_SIZE)
+    GLint index_bytes = 0;
+    // участки ребер для отсечения, нет - буфер ребер рисуется целиком
+    std::shared_ptr<const EdgeClusters> clusters;
+  };
+
+  /*
+    передний и задний наборы буферов: новая модель загружается в задний, пока
+    рисуется передний, затем они меняются местами
+  */
+  std::array<ModelBuffers, 2> buffers_;
+  size_t front_buffers_ = 0;
+  // данные последней модели, их же читает uploader_ в своем потоке
+  std::shared_ptr<const std::vector<float>> vertices_;
+  std::shared_ptr<const std::vector<unsigned int>> edges_;
+  std::shared_ptr<const EdgeClusters> clusters_;
+  // видимые участки и диапазоны glMultiDrawElements последнего кадра
+  std::vector<size_t> visible_clusters_;
+  std::vector<GLsizei> draw_counts_;
+  std::vector<const void *> draw_offsets_;
+
+  // фоновая загрузка буферов, нет - буферы загружаются в потоке gui
+  std::unique_ptr<GlUploader> uploader_;
+  size_t upload_generation_ = 0;
+  size_t front_generation_ = 0;  // модель, загруженная в передние буферы
+  bool is_uploading_ = false;
+
+  // уровни детализации модели (MeshLod) и их буферы в видеопамяти
+  std::shared_ptr<const MeshLod> lod_;
+  std::vector<ModelBuffers> lod_buffers_;
+  size_t lod_generation_ = 0;  // модель, для которой построены уровни
+  int drawn_level_ = -1;       // -1 - рисуется полная модель
+  size_t drawn_edges_ = 0;     // ребер в последнем кадре
+  bool is_full_detail_forced_ = false;  // для скриншотов и записи
+
+  /*
+    режим характерных ребер (FeatureEdges): границы и изломы не зависят от
+    вида и лежат в feature_ebo_, контур пересчитывается после смены матрицы
+    MVP и загружается в silhouette_ebo_
+  */
+  std::shared_ptr<const FeatureEdges> features_;
+  size_t features_generation_ = 0;  // модель, для которой они построены
+  bool is_feature_mode_ = false;
+  bool is_silhouette_dirty_ = true;
+  GLuint feature_ebo_ = 0;
+  GLuint silhouette_ebo_ = 0;
+  GLsizei feature_indices_count_ = 0;
+  std::vector<unsigned int> silhouette_edges_;
+
+  /*
+    во время вращения и анимации модель рисуется упрощенной так, чтобы кадр
+    укладывался в бюджет quality_ (50 кадров/с, как таймеры анимации):
+    скорость отрисовки измеряется запросами GL_TIME_ELAPSED (результат кадра
+    читается на следующем кадре) и интервалами между кадрами анимации
+  */
+  InteractionQuality quality_{20.0};
+  const int idle_delay_ms_ = 300;
+  const size_t min_proxy_edges_ = 20'000;  // меньше - каркас не узнать
+  bool is_interacting_ = false;
+  bool is_animating_ = false;  // идет анимация преобразований MainWindow
+  QTimer *idle_timer_;
+  QElapsedTimer frame_timer_;  // интервал между кадрами анимации
+  bool has_timer_query_ = false;
+  std::array<GLuint, 2> draw_queries_ = {0, 0};
+  std::array<size_t, 2> query_edges_ = {0, 0};
+  size_t query_index_ = 0;
 
   GLuint shader_program_;  // программа шейдера
   GLint mvp_location_;     // локация uniform-переменной MVP
@@ -321,10 +507,26 @@ class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_0 {
 
   QVector4D point_vertex_color_;
 
+  std::unique_ptr<QOpenGLFramebufferObject> offscreen_fbo_;
+
+  /*
+    кольцо pixel buffer objects для асинхронного захвата кадров: glReadPixels
+    только ставит копирование в очередь видеокарты, а буфер отображается в
+    память через capture_lag_ захватов, когда копирование уже закончилось
+  */
+  std::vector<GLuint> capture_pbos_;
+  size_t capture_next_ = 0;     // PBO для следующего glReadPixels
+  size_t capture_pending_ = 0;  // PBO с еще не забранными кадрами
+  int capture_width_ = 0;
+  int capture_height_ = 0;
+  const size_t capture_lag_ = 2;
+
  public:
   GLWidget(QWidget *parent);
+  ~GLWidget() override;
   void SetModelData(const std::vector<float> &vertices,
-                    const std::vector<unsigned int> &edges);
+                    const std::vector<unsigned int> &edges,
+                    std::shared_ptr<const EdgeClusters> clusters = nullptr);
   void SetMVPMatrix(const S21MatrixWrapper &mvp);
   void SetLineColor(QVector4D &line_color);
   void SetBackgroundColor(QVector4D &back_color);
@@ -340,6 +542,26 @@ class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_0 {
 
   void SetMemento(GLWidgetMemento &memento);
   GLWidgetMemento CreateMemento();
+  void AccountMemory(MemoryStats &stats) const;
+  bool IsUploading() const;
+  void SetLodLevels(std::shared_ptr<const MeshLod> lod);
+  int GetDrawnLevel() const;
+  size_t GetDrawnEdgesCount() const;
+  size_t GetVisibleClustersCount() const;
+  void SetFeatureEdges(std::shared_ptr<const FeatureEdges> features);
+  void SetFeatureEdgesMode(bool enabled);
+  bool IsFeatureEdgesShown() const;
+  void SetAnimating(bool is_animating);
+  bool IsAnimating() const;
+
+  QImage RenderToImage(int frame_width, int frame_height);
+  QImage RenderToImage(int frame_width, int frame_height,
+                       const S21MatrixWrapper &mvp);
+
+  bool CaptureFrameAsync(QImage &ready_frame);
+  std::vector<QImage> FlushCaptures();
+  static QImage ImageFromReadback(const unsigned char *pixels, int width,
+                                  int height);
 
  protected:
   void initializeGL() override;
@@ -349,6 +571,26 @@ class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_0 {
 
  private:
   void setup_shaders_();
+  void upload_model_buffers_();
+  void swap_model_buffers_();
+  void model_buffers_uploaded_(size_t generation, GLint vertex_bytes,
+                               GLint index_bytes);
+  void model_buffers_upload_failed_(size_t generation);
+  void upload_lod_buffers_();
+  void release_lod_buffers_();
+  void upload_feature_buffers_();
+  void release_feature_buffers_();
+  size_t draw_feature_edges_();
+  ModelBuffers select_buffers_();
+  size_t frame_edges_budget_() const;
+  size_t draw_edges_(const ModelBuffers &buffers, size_t edges_budget);
+  void begin_draw_timing_();
+  void end_draw_timing_(size_t edges_count);
+  void add_frame_sample_();
+  void setup_capture_pbos_(int frame_width, int frame_height);
+  void release_capture_pbos_();
+  bool map_oldest_capture_(QImage &frame);
+  QImage render_offscreen_(int frame_width, int frame_height);
 };
 
 }  // namespace s21
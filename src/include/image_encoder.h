@@ -0,0 +1,67 @@
+#ifndef IMAGE_ENCODER_H
+#define IMAGE_ENCODER_H
+
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Задание на сохранение одного изображения. QImage передается по
+ * значению и дальше только перемещается, поэтому данные кадра не копируются.
+ */
+struct EncodeJob {
+  QImage image;
+  QString path;
+  std::string format;  // "JPEG", "BMP", "PNG"
+  int quality = -1;    // -1 - качество по умолчанию для формата
+};
+
+/**
+ * @brief Сервис для сжатия и записи изображений (скриншоты, кадры gif) вне
+ * потока gui. Задания складываются в ограниченную очередь и разбираются
+ * несколькими рабочими потоками.
+ * @details Submit() никогда не блокирует: если очередь заполнена, задание
+ * отбрасывается и учитывается в счетчике dropped. Деструктор дожидается
+ * записи всех заданий, уже попавших в очередь.
+ */
+class ImageEncodingService {
+ private:
+  std::deque<EncodeJob> queue_;
+  size_t max_queue_size_;
+  size_t in_progress_ = 0;
+  size_t max_queue_depth_ = 0;
+  size_t encoded_ = 0;
+  size_t dropped_ = 0;
+  size_t failed_ = 0;
+  bool stopped_ = false;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable idle_;
+  std::vector<std::thread> workers_;
+
+ public:
+  ImageEncodingService(size_t max_queue_size = 8, size_t workers_count = 2);
+  ~ImageEncodingService();
+
+  ImageEncodingService(const ImageEncodingService &) = delete;
+  ImageEncodingService &operator=(const ImageEncodingService &) = delete;
+
+  bool Submit(QImage image, const QString &path, const std::string &format,
+              int quality = -1);
+  void WaitIdle();
+  void Stop();
+
+  size_t GetQueueDepth() const;
+  size_t GetMaxQueueDepth() const;
+  size_t GetEncodedCount() const;
+  size_t GetDroppedCount() const;
+  size_t GetFailedCount() const;
+
+ private:
+  void worker_loop_();
+};
+
+}  // namespace s21
+
+#endif
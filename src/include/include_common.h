@@ -4,29 +4,55 @@
 #include <Magick++.h>
 
 #include <QApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QImage>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMessageBox>
 #include <QMetaType>
 #include <QObject>
+#include <QPainter>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QString>
 #include <QThread>
 /////////////////////////
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cctype>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <limits>
+#include <list>
+#include <map>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
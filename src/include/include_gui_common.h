@@ -1,18 +1,25 @@
 #ifndef INCLUDE_GUI_COMMON_H
 #define INCLUDE_GUI_COMMON_H
 
+#include <QCheckBox>
 #include <QCloseEvent>
 #include <QDoubleValidator>
 #include <QFileDialog>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMainWindow>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
 #include <QOpenGLFunctions_3_0>
 #include <QOpenGLWidget>
 #include <QPalette>
 #include <QPixmap>
+#include <QProgressBar>
 #include <QPushButton>
 #include <QScreen>
+#include <QSpinBox>
 #include <QStandardPaths>
 #include <QTimeZone>
 #include <QTimer>
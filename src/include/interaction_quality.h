@@ -0,0 +1,51 @@
+#ifndef INTERACTION_QUALITY_H
+#define INTERACTION_QUALITY_H
+
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Бюджет ребер на кадр во время анимации и вращения модели. Скорость
+ * отрисовки (ребер в мс) измеряется по времени отрисовки на видеокарте, а без
+ * запросов времени - по интервалам между кадрами. Бюджет - это столько
+ * ребер, сколько успевает нарисоваться за время кадра, умноженное на
+ * поправку: если кадры все равно приходят позже бюджета (время уходит не
+ * только на ребра), поправка уменьшается, если отрисовка занимает меньше
+ * половины кадра - снова растет до 1.
+ */
+class InteractionQuality {
+ public:
+  static constexpr double kSmoothing = 0.2;  // вес нового замера скорости
+  static constexpr double kMinScale = 1.0 / 32.0;
+
+ private:
+  double frame_budget_ms_;
+  double edges_per_ms_ = 0;  // 0 - еще не измерено
+  bool has_draw_samples_ = false;  // скорость измерена на видеокарте
+  double last_draw_ms_ = -1;       // -1 - замеров отрисовки нет
+  double scale_ = 1.0;
+
+ public:
+  explicit InteractionQuality(double frame_budget_ms = 20.0);
+
+  void SetFrameBudget(double frame_budget_ms);
+  double GetFrameBudget() const;
+  void AddDrawSample(size_t edges_count, double draw_ms);
+  void AddFrameSample(size_t edges_count, double frame_ms);
+  void RestartScale();
+
+  size_t GetEdgesBudget() const;
+  double GetEdgesPerMs() const;
+  double GetScale() const;
+
+  static std::vector<unsigned int> StrideOrder(
+      const std::vector<unsigned int> &edges);
+
+ private:
+  void add_rate_(double rate);
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "include_common.h"
+#include "tracer.h"
+
+namespace s21 {
+
+enum class JobPriority { kLow = 0, kNormal = 1, kHigh = 2 };
+
+/**
+ * @brief Флаг отмены задачи. Копии токена разделяют один флаг: gui отменяет
+ * задачу через свою копию, а задача периодически проверяет IsCancelled().
+ */
+class CancellationToken {
+ private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+
+ public:
+  CancellationToken();
+
+  void Cancel();
+  bool IsCancelled() const;
+};
+
+/**
+ * @brief Пул из фиксированного количества рабочих потоков для фоновых задач
+ * (загрузка моделей, сборка gif, обработка мешей). Вместо отдельного QThread на
+ * каждую операцию задачи ставятся в очередь с приоритетом.
+ * @details Задачи с одинаковым приоритетом выполняются в порядке постановки.
+ * Обработчик завершения передается через очередь событий Qt в поток, который
+ * создал пул (gui), receiver должен жить в этом же потоке. Удален ли receiver,
+ * проверяется уже там, и тогда вызов отбрасывается. Без receiver обработчик
+ * вызывается в рабочем потоке.
+ * Отмененная до запуска задача не выполняется, обработчик получает
+ * cancelled = true.
+ */
+class JobSystem {
+ public:
+  using Job = std::function<void(const CancellationToken &token)>;
+  using Completion = std::function<void(bool cancelled)>;
+
+ private:
+  struct QueuedJob {
+    Job job;
+    Completion on_done;
+    QPointer<QObject> receiver;
+    bool has_receiver;
+    CancellationToken token;
+    JobPriority priority;
+    size_t sequence;
+  };
+
+  struct QueuedJobLess {
+    bool operator()(const QueuedJob &first, const QueuedJob &second) const;
+  };
+
+  std::priority_queue<QueuedJob, std::vector<QueuedJob>, QueuedJobLess> queue_;
+  size_t next_sequence_ = 0;
+  size_t running_ = 0;
+  bool stopped_ = false;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable idle_;
+  std::vector<std::thread> workers_;
+  std::vector<CancellationToken> running_tokens_;  // по одному на поток
+  std::unique_ptr<QObject> dispatcher_;  // живет в потоке, создавшем пул
+
+ public:
+  explicit JobSystem(size_t workers_count = DefaultWorkersCount());
+  ~JobSystem();
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  CancellationToken Submit(Job job, JobPriority priority = JobPriority::kNormal,
+                           QObject *receiver = nullptr,
+                           Completion on_done = nullptr);
+  void WaitIdle();
+  void Shutdown();
+
+  size_t GetWorkersCount() const;
+  size_t GetPendingCount() const;
+
+  static size_t DefaultWorkersCount();
+
+ private:
+  void worker_loop_(size_t worker_index);
+  void finish_job_(QueuedJob &queued);
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Категории памяти, которую занимает загруженная модель
+ */
+enum class MemoryCategory {
+  kVertices,           // Model3D: вершины
+  kFaces,              // Model3D: грани (вектор векторов индексов)
+  kEdges,              // Model3D: пары индексов ребер
+  kEdgesHashOverhead,  // узлы и корзины unordered_set сверх самих пар
+  kGlShadowCopies,     // копии буферов в GLWidget (нужны для SetModelData)
+  kGlVertexBuffer,     // VBO в видеопамяти
+  kGlIndexBuffer,      // EBO в видеопамяти
+  kModelCache,         // ранее открытые модели в ModelCache
+  kLodLevels,          // уровни детализации (MeshLod) в памяти процесса
+  kGlLodBuffers,       // буферы уровней детализации в видеопамяти
+  kEdgeClusters,       // участки ребер для отсечения (EdgeClusters)
+  kFeatureEdges,       // характерные ребра и контур (FeatureEdges)
+  kMeshAdjacency,      // Model3D: смежность ребер и граней (MeshAdjacency)
+  kCount
+};
+
+/**
+ * @brief Учет памяти модели по категориям. Каждый владелец данных (Model3D,
+ * GLWidget) сам записывает свои категории (AccountMemory), поэтому сводка
+ * собирается без копирования данных.
+ * @details Размеры в куче считаются по capacity контейнеров с учетом
+ * заголовка и выравнивания блоков malloc (glibc), это оценка, а не точное
+ * значение. Пиковый RSS берется у операционной системы.
+ */
+class MemoryStats {
+ private:
+  std::vector<size_t> bytes_ =
+      std::vector<size_t>(static_cast<size_t>(MemoryCategory::kCount), 0);
+  size_t peak_rss_ = 0;
+  // счетчики событий (попадания в кэш и т.п.) в порядке добавления
+  std::vector<std::pair<std::string, size_t>> counters_;
+
+ public:
+  void Set(MemoryCategory category, size_t bytes);
+  size_t Get(MemoryCategory category) const;
+  void SetPeakRss(size_t bytes);
+  size_t GetPeakRss() const;
+  void SetCounter(const std::string &name, size_t value);
+  size_t GetCounter(const std::string &name) const;
+
+  size_t GetCpuBytes() const;
+  size_t GetGpuBytes() const;
+
+  QString Summary() const;
+  QString Details() const;
+  QJsonObject ToJson() const;
+
+  static const char *CategoryName(MemoryCategory category);
+  static QString FormatBytes(size_t bytes);
+
+  static size_t HeapBlockBytes(size_t payload);
+  static size_t HashSetOverheadBytes(size_t elements, size_t buckets,
+                                     size_t value_size);
+
+  static size_t PeakRssBytes();
+  static size_t AvailableRamBytes();
+  static size_t PredictLoadBytes(qint64 file_size);
+  static size_t PredictMeshBytes(qint64 file_size);
+  static bool IsLoadTooLarge(qint64 file_size, size_t &predicted,
+                             size_t &available);
+
+ private:
+  static constexpr size_t kLoadBytesPerFileByte = 8;
+  static constexpr size_t kMeshBytesPerFileByte = 3;
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef MESH_ADJACENCY_H
+#define MESH_ADJACENCY_H
+
+#include "include_common.h"
+#include "job_system.h"
+#include "memory_stats.h"
+#include "tracer.h"
+
+namespace s21 {
+
+/**
+ * @brief Смежность вершин, ребер и граней модели в плоских массивах (формат
+ * CSR: массив смещений и общий массив значений). Ребра пронумерованы по
+ * возрастанию пары (меньший, больший индекс вершины), стороны грани - в
+ * порядке обхода: сторона j соединяет вершины j и j + 1.
+ * @details Запросы "грани ребра", "ребра грани", "ребра вершины" и "соседняя
+ * грань через ребро" выполняются за O(1) без поиска. Построение: пары
+ * (ребро, грань) заполняются параллельно (OpenMP) и сортируются, после чего
+ * номера ребер и массивы смежности тоже заполняются параллельно. Индексы и
+ * смещения 32-битные, как индексы вершин в буферах OpenGL; если сторон у
+ * граней больше, Build выбрасывает std::length_error.
+ */
+class MeshAdjacency {
+ public:
+  static constexpr unsigned int kNone =
+      std::numeric_limits<unsigned int>::max();
+
+ private:
+  std::vector<unsigned int> edges_;  // пары индексов вершин, меньший первым
+  std::vector<unsigned int> edge_face_offsets_;    // ребер + 1
+  std::vector<unsigned int> edge_faces_;           // грани по ребрам
+  std::vector<unsigned int> face_edge_offsets_;    // граней + 1
+  std::vector<unsigned int> face_edges_;           // ребра по сторонам граней
+  std::vector<unsigned int> vertex_edge_offsets_;  // вершин + 1
+  std::vector<unsigned int> vertex_edges_;         // ребра по вершинам
+
+ public:
+  MeshAdjacency() = default;
+
+  static MeshAdjacency Build(
+      size_t vertices_count,
+      const std::vector<std::vector<unsigned int>> &faces,
+      const CancellationToken &token = CancellationToken());
+
+  size_t GetVerticesCount() const;
+  size_t GetEdgesCount() const;
+  size_t GetFacesCount() const;
+
+  std::pair<unsigned int, unsigned int> GetEdge(size_t edge) const;
+  std::span<const unsigned int> GetEdgeFaces(size_t edge) const;
+  std::span<const unsigned int> GetFaceEdges(size_t face) const;
+  std::span<const unsigned int> GetVertexEdges(size_t vertex) const;
+  unsigned int GetOppositeFace(size_t edge, size_t face) const;
+  bool IsManifoldEdge(size_t edge) const;
+
+  size_t GetBytes() const;
+};
+
+}  // namespace s21
+
+#endif
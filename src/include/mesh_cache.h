@@ -0,0 +1,45 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "3dmodel.h"
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Двоичный кэш разобранного .obj файла. Чтение кэша не требует разбора
+ * текста и построения множества ребер, поэтому модель открывается в разы
+ * быстрее.
+ * @details Формат (QDataStream, little-endian): заголовок (магическое число,
+ * версия, размер и время изменения исходного файла), затем количество
+ * вершин/граней/ребер и сами данные. Кэш считается действительным, пока
+ * размер и время изменения исходного файла совпадают с записанными.
+ */
+class MeshCache {
+ public:
+  static constexpr quint32 kMagic = 0x5332314D;  // "S21M"
+  static constexpr quint16 kVersion = 2;  // 2 - little-endian
+
+  static QString DefaultCacheDir();
+  static QString CacheNameFor(const QString &source_path);
+  static QString CachePathFor(const QString &cache_dir,
+                              const QString &source_path);
+  static void Write(
+      const QString &cache_path, const QString &source_path,
+      const std::vector<Vector3D> &vertices,
+      const std::vector<std::vector<unsigned int>> &faces,
+      const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
+          &edges);
+  static MeshData Read(const QString &cache_path);
+  static bool IsValid(const QString &cache_path, const QString &source_path);
+
+ private:
+  static void setup_stream_(QDataStream &stream);
+  static void write_header_(QDataStream &out, const QFileInfo &source);
+  static bool read_header_(QDataStream &in, qint64 &source_size,
+                           qint64 &source_modified);
+};
+
+}  // namespace s21
+
+#endif
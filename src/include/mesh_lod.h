@@ -0,0 +1,70 @@
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include "3dmodel.h"
+#include "affine.h"
+#include "include_common.h"
+#include "job_system.h"
+
+namespace s21 {
+
+/**
+ * @brief Уровень детализации: упрощенный каркас в формате OpenGL
+ */
+struct LodLevel {
+  int resolution = 0;  // ячеек сетки по наибольшей стороне рамки модели
+  std::vector<float> vertices;
+  std::vector<unsigned int> edges;
+
+  size_t GetEdgesCount() const;
+};
+
+/**
+ * @brief Иерархия уровней детализации большой модели, построенная
+ * кластеризацией вершин: рамка модели делится на кубические ячейки, вершины
+ * одной ячейки сливаются в их среднюю точку, ребра внутри ячейки исчезают,
+ * повторяющиеся ребра между ячейками остаются в одном экземпляре.
+ * @details Уровни идут от подробного к грубому, каждый следующий строится из
+ * предыдущего с вдвое меньшим разрешением сетки. Уровень, который сокращает
+ * ребра меньше чем вдвое, не сохраняется. Вершины сетки считаются параллельно
+ * (OpenMP), построение идет в пуле потоков после загрузки модели.
+ */
+class MeshLod {
+ public:
+  static constexpr size_t kMinSourceEdges = 200'000;  // меньшие - целиком
+  static constexpr size_t kMinLevelEdges = 5'000;
+  static constexpr int kMaxResolution = 512;
+  static constexpr int kMinResolution = 8;
+
+ private:
+  std::vector<LodLevel> levels_;
+  BoundingBox box_;
+  size_t source_edges_ = 0;
+
+ public:
+  MeshLod() = default;
+
+  static bool IsNeeded(size_t edges_count);
+  static MeshLod Build(const std::vector<float> &vertices,
+                       const std::vector<unsigned int> &edges,
+                       const CancellationToken &token = CancellationToken());
+  static LodLevel Cluster(const std::vector<float> &vertices,
+                          const std::vector<unsigned int> &edges,
+                          const BoundingBox &box, int resolution);
+  static BoundingBox BoxOf(const std::vector<float> &vertices);
+  static double ScreenExtent(const IMatrix &mvp, const BoundingBox &box,
+                             int width, int height);
+
+  int SelectByScreenSize(double extent_pixels,
+                         double max_cell_pixels = 1.0) const;
+  int SelectByBudget(size_t edges_budget) const;
+
+  const std::vector<LodLevel> &GetLevels() const;
+  const BoundingBox &GetBox() const;
+  size_t GetSourceEdgesCount() const;
+  size_t GetBytes() const;
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef MESH_VALIDATION_H
+#define MESH_VALIDATION_H
+
+#include "3dmodel.h"
+#include "include_common.h"
+#include "job_system.h"
+#include "mesh_adjacency.h"
+
+namespace s21 {
+
+/**
+ * @brief Проблемы модели, которые находит MeshValidation
+ */
+enum class MeshIssue {
+  kDegenerateFace,        // меньше двух вершин, повтор вершины или нет площади
+  kDuplicateFace,         // те же вершины, что у одной из предыдущих граней
+  kUnreferencedVertex,    // вершина не входит ни в одно ребро граней
+  kNonManifoldEdge,       // ребро больше чем двух граней
+  kOutOfRangeCoordinate,  // NaN, бесконечность или |x| > max_coordinate
+  kCount
+};
+
+/**
+ * @brief Место проблемы: номер грани или вершины (с нуля). У ребра index и
+ * other - его вершины, у повторной грани other - грань, которую она повторяет.
+ */
+struct MeshIssueSample {
+  size_t index = 0;
+  size_t other = 0;
+};
+
+/**
+ * @brief Проверка загруженной модели: вырожденные и повторные грани,
+ * вершины без граней, неманифолдные ребра и координаты вне разумного
+ * диапазона. Для каждой проблемы - количество и первые kMaxSamples мест.
+ * @details Проверки идут по граням, вершинам и ребрам параллельно (OpenMP),
+ * смежность берется из MeshAdjacency, поэтому проверка занимает долю
+ * времени загрузки. Повторные грани ищутся сортировкой хешей, не зависящих
+ * от порядка вершин, и сравниваются точно только при совпадении хеша.
+ */
+class MeshValidation {
+ public:
+  static constexpr size_t kMaxSamples = 10;
+  static constexpr double kDefaultMaxCoordinate = 1e6;
+  // грань вырождена, если ее удвоенная площадь не больше этой доли квадрата
+  // диагонали модели
+  static constexpr double kAreaEpsilon = 1e-12;
+
+ private:
+  std::array<size_t, static_cast<size_t>(MeshIssue::kCount)> counts_ = {};
+  std::array<std::vector<MeshIssueSample>,
+             static_cast<size_t>(MeshIssue::kCount)>
+      samples_;
+  qint64 elapsed_ms_ = 0;
+
+ public:
+  MeshValidation() = default;
+
+  static MeshValidation Run(
+      const std::vector<Vector3D> &vertices,
+      const std::vector<std::vector<unsigned int>> &faces,
+      const MeshAdjacency &adjacency,
+      double max_coordinate = kDefaultMaxCoordinate,
+      const CancellationToken &token = CancellationToken());
+  static MeshValidation Run(
+      const Model3D &model,
+      const CancellationToken &token = CancellationToken());
+
+  size_t GetCount(MeshIssue issue) const;
+  const std::vector<MeshIssueSample> &GetSamples(MeshIssue issue) const;
+  size_t GetIssuesCount() const;
+  bool IsValid() const;
+  qint64 GetElapsedMs() const;
+
+  QString Summary() const;
+  QString Details() const;
+  QJsonObject ToJson() const;
+
+  static const char *IssueName(MeshIssue issue);
+
+ private:
+  void add_issue_(MeshIssue issue, const std::vector<unsigned char> &flags,
+                  size_t count,
+                  const std::vector<unsigned int> &others = {});
+  static bool is_degenerate_face_(const std::vector<Vector3D> &vertices,
+                                  const std::vector<unsigned int> &face,
+                                  double min_double_area);
+  static std::uint64_t face_hash_(const std::vector<unsigned int> &face);
+  static bool is_same_face_(const std::vector<unsigned int> &first,
+                            const std::vector<unsigned int> &second);
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include "3dmodel.h"
+#include "include_common.h"
+#include "memory_stats.h"
+
+namespace s21 {
+
+/**
+ * @brief Размер и время изменения файла. Снимаются до разбора файла: если
+ * файл меняется, пока его разбирают, запись в кэше сразу оказывается
+ * устаревшей.
+ */
+struct FileStamp {
+  qint64 size = -1;  // -1 - файла нет
+  qint64 modified = 0;
+
+  static FileStamp Of(const std::string &file_path);
+  bool operator==(const FileStamp &other) const = default;
+};
+
+/**
+ * @brief Кэш недавно открытых моделей в памяти (LRU с ограничением по
+ * объему). Повторное открытие модели из кэша не требует разбора файла.
+ * @details Ключ - абсолютный путь; вместе с моделью хранятся размер и время
+ * изменения файла на момент начала разбора (FileStamp), и если файл с тех
+ * пор поменялся, запись считается устаревшей и удаляется. Модели хранятся
+ * как shared_ptr на неизменяемые данные, поэтому вытеснение не мешает тем,
+ * кто модель уже получил. Методы потокобезопасны.
+ */
+class ModelCache {
+ private:
+  struct Entry {
+    std::string key;
+    FileStamp stamp;
+    std::shared_ptr<const MeshData> mesh;
+    size_t bytes;
+  };
+
+  std::list<Entry> entries_;  // в начале - самые недавно использованные
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t budget_bytes_;
+  size_t used_bytes_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+  size_t evictions_ = 0;
+  mutable std::mutex mutex_;
+
+ public:
+  explicit ModelCache(size_t budget_bytes = DefaultBudget());
+
+  std::shared_ptr<const MeshData> Find(const std::string &file_path);
+  bool Contains(const std::string &file_path) const;
+  void Insert(const std::string &file_path, const FileStamp &stamp,
+              std::shared_ptr<const MeshData> mesh);
+  void SetBudget(size_t budget_bytes);
+  void Clear();
+
+  size_t GetBudget() const;
+  size_t GetUsedBytes() const;
+  size_t GetEntriesCount() const;
+  void AccountMemory(MemoryStats &stats) const;
+
+  static size_t DefaultBudget();
+
+ private:
+  static std::string key_for_(const std::string &file_path);
+  bool is_fresh_(const Entry &entry) const;
+  void erase_(std::list<Entry>::iterator entry);
+  void evict_to_budget_();
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef MODEL_PREFETCHER_H
+#define MODEL_PREFETCHER_H
+
+#include "3dmodel.h"
+#include "include_common.h"
+#include "job_system.h"
+#include "memory_stats.h"
+#include "model_cache.h"
+
+namespace s21 {
+
+/**
+ * @brief Состояние одной упреждающей загрузки. Загрузка, запрошенная
+ * пользователем, присоединяется к ней через Join(), а не разбирает тот же
+ * файл второй раз.
+ */
+class PrefetchJob {
+ private:
+  enum class Phase { kQueued, kRunning, kDone };
+
+  std::mutex mutex_;
+  std::condition_variable done_;
+  Phase phase_ = Phase::kQueued;
+  std::shared_ptr<const MeshData> mesh_;
+
+ public:
+  bool Start();
+  void Finish(std::shared_ptr<const MeshData> mesh);
+  std::shared_ptr<const MeshData> Join(const CancellationToken &token);
+};
+
+/**
+ * @brief Упреждающая загрузка соседних .obj файлов того же каталога в
+ * ModelCache, пока пользователь рассматривает текущую модель. Переход к
+ * следующей модели тогда не требует разбора файла.
+ * @details Кандидаты - depth следующих по имени файлов и один предыдущий.
+ * Задачи ставятся в пул с низким приоритетом, поэтому не задерживают загрузку,
+ * запрошенную пользователем. Файл пропускается, если он уже в кэше, если
+ * модель по оценке не поместится в бюджет кэша или если после загрузки
+ * доступной памяти останется меньше, чем нужно на саму загрузку (нехватка
+ * памяти). Задачи для файлов, которые перестали быть кандидатами,
+ * отменяются. Список файлов каталога читается заново, только если каталог
+ * изменился.
+ */
+class ModelPrefetcher {
+ private:
+  ModelCache &cache_;
+  bool enabled_ = false;
+  size_t depth_ = 2;
+  struct Pending {
+    CancellationToken token;
+    std::shared_ptr<PrefetchJob> job;
+  };
+  // задачи удаляются по завершении в рабочем потоке, поэтому под mutex_
+  std::map<std::string, Pending> pending_;
+  mutable std::mutex mutex_;
+
+  // отсортированные файлы последнего каталога и время его изменения
+  QString siblings_dir_;
+  qint64 siblings_modified_ = 0;
+  std::vector<std::string> siblings_;
+
+  std::atomic<size_t> completed_{0};
+  std::atomic<size_t> skipped_{0};
+
+ public:
+  explicit ModelPrefetcher(ModelCache &cache);
+  ~ModelPrefetcher();
+
+  void SetEnabled(bool enabled);
+  bool IsEnabled() const;
+  void SetDepth(size_t depth);
+
+  void Prefetch(JobSystem &jobs, const std::string &current_file);
+  std::shared_ptr<PrefetchJob> Claim(const std::string &file);
+  void Cancel();
+  size_t GetPendingCount() const;
+  void AccountMemory(MemoryStats &stats) const;
+  std::string GetNeighbour(const std::string &file, int offset);
+
+  static std::vector<std::string> SiblingFiles(const std::string &file);
+  static std::string Neighbour(const std::string &file, int offset);
+  static std::string Neighbour(const std::vector<std::string> &siblings,
+                               const std::string &file, int offset);
+  static std::vector<std::string> Candidates(const std::string &file,
+                                             size_t depth);
+  static std::vector<std::string> Candidates(
+      const std::vector<std::string> &siblings, const std::string &file,
+      size_t depth);
+  static bool HasMemoryFor(const std::string &file, size_t cache_budget);
+
+ private:
+  const std::vector<std::string> &siblings_for_(const std::string &file);
+  std::shared_ptr<const MeshData> prefetch_file_(
+      const std::string &file, const CancellationToken &token);
+};
+
+}  // namespace s21
+
+#endif
@@ -6,9 +6,13 @@
 
 namespace s21 {
 
+// соотношение сторон, под которое строятся проекции сцены (32 x 24 у
+// параллельной)
+inline constexpr double kProjectionAspect = 4.0 / 3.0;
+
 struct ProjPerspectiveData {
   double fov_ = 90.0;
-  double aspect_ = 4.0 / 3.0;
+  double aspect_ = kProjectionAspect;
 };
 
 struct ProjOrthogonalData {
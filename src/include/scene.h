@@ -3,13 +3,35 @@
 
 #include "3dmodel.h"
 #include "camera.h"
+#include "edge_clusters.h"
+#include "feature_edges.h"
 #include "gif_creator.h"
 #include "include_common.h"
+#include "job_system.h"
+#include "mesh_cache.h"
+#include "mesh_lod.h"
+#include "mesh_validation.h"
+#include "model_cache.h"
+#include "model_prefetcher.h"
 #include "projection.h"
 #include "viewer_memento.h"
 
 namespace s21 {
 
+/**
+ * @brief Задний слот сцены: модель, полностью подготовленная в рабочем потоке
+ * (данные, габариты, данные для буферов OpenGL). В сцену слот попадает целиком,
+ * заменой указателя в потоке gui, поэтому до этого момента показывается и
+ * преобразуется прежняя модель, а смешанного состояния не бывает.
+ * Ребра в gl_data отсортированы по участкам для отсечения (EdgeClusters).
+ */
+struct ModelSlot {
+  std::shared_ptr<Model3D> model;
+  std::shared_ptr<const Model3DDataGl> gl_data;
+
+  static std::shared_ptr<ModelSlot> Build(const MeshData &mesh);
+};
+
 /**
  * @brief Это реализация паттерна фасад, т.к. класс Scene является объединяющим
  * классом для четырех других классов: Model3D (хранение данных о модели),
@@ -21,7 +43,8 @@ namespace s21 {
 class Scene : public QObject {
   Q_OBJECT
  private:
-  std::unique_ptr<Model3D> model_;
+  // передний слот, показанная модель (ее читают и фоновые задачи анализа)
+  std::shared_ptr<Model3D> model_;
   std::unique_ptr<AffineTransDecorator> transformation_;  // для ModelMatrix
   std::unique_ptr<Camera> camera_;
   std::unique_ptr<Projection> projection_;
@@ -30,6 +53,34 @@ class Scene : public QObject {
   std::string current_file_path_;
   bool is_model_displayed_ = false;
 
+  /*
+    загрузка в фоне: результат применяется только для последней запущенной
+    загрузки, предыдущая отменяется
+  */
+  size_t load_generation_ = 0;
+  CancellationToken load_token_;
+  ObjLoadMode load_mode_ = ObjLoadMode::kStrict;
+
+  // уровни детализации строятся в фоне для показанной модели
+  size_t model_generation_ = 0;
+  CancellationToken lod_token_;
+
+  // характерные ребра строятся в фоне, только когда включен их режим
+  bool is_feature_edges_enabled_ = false;
+  size_t features_generation_ = 0;  // модель, для которой они уже построены
+  CancellationToken feature_token_;
+
+  // проверка каждой показанной модели (MeshValidation) в фоне
+  CancellationToken validation_token_;
+
+  // недавно открытые модели: повторное открытие без разбора файла
+  ModelCache model_cache_;
+  // упреждающая загрузка соседних файлов в model_cache_
+  ModelPrefetcher prefetcher_{model_cache_};
+
+  // пул потоков для фоновых задач, удаляется первым (объявлен последним)
+  std::unique_ptr<JobSystem> jobs_;
+
  public:
   Scene();
   void LoadModelNoThread(const std::string &obj_file_name);
@@ -46,6 +97,8 @@ class Scene : public QObject {
   void ApplyRotation(double angle, Vector3D &axis);
   void ApplyScale(double scale_val);
   S21Matrix CreateMVPMatrix();
+  S21Matrix CreateTileMVPMatrix(int column, int row, int columns, int rows,
+                                double aspect);
   Model3DDataGl GetModelAsGLData();
 
   bool IsPerspective();
@@ -54,6 +107,7 @@ class Scene : public QObject {
   std::string GetFileName();
   size_t GetVerticesCount();
   size_t GetEdgesCount();
+  void AccountMemory(MemoryStats &stats) const;
 
   void print_figues_data();
 
@@ -61,12 +115,20 @@ class Scene : public QObject {
   SceneMemento CreateMemento();
 
   bool IsModelDisplayed();
+  JobSystem &GetJobSystem();
+  ModelCache &GetModelCache();
+  std::string GetNeighbourFile(int offset);
 
   // сигналы для контроллера
  signals:
   void Loaded(const Model3DDataGl &gl_data);
   void LoadedMemento(const Model3DDataGl &gl_data);
   void ErrorLoad(const std::string &error_message);
+  void LoadProgress(qint64 bytes_read, qint64 total_bytes);
+  void LoadFinished();
+  void LodReady(std::shared_ptr<const MeshLod> lod);
+  void FeatureEdgesReady(std::shared_ptr<const FeatureEdges> features);
+  void ValidationReady(std::shared_ptr<const MeshValidation> validation);
 
   void UpdateMVP();
   void UpdateTempMVP(S21MatrixWrapper &mvp);
@@ -77,6 +139,10 @@ class Scene : public QObject {
 
  public slots:
   void ProcessObjLoad(std::string &file_path);
+  void CancelLoad();
+  void SetLenientLoading(bool lenient);
+  void SetPrefetchEnabled(bool enabled);
+  void SetFeatureEdgesEnabled(bool enabled);
 
   void ProcessTranslation_nofps(const QString &tx_s, const QString &ty_s,
                                 const QString &tz_s);
@@ -95,19 +161,13 @@ class Scene : public QObject {
   void ProcessChangeProjection();
 
   void CreatingGifFromJpegs(int target_frames, QString &gif_fr_path,
-                            QString gif_target_path, double anim_delay);
+                            QString gif_target_path, double anim_delay,
+                            qint64 record_started_ms);
+  void StartGifEncoding(std::shared_ptr<FrameRingBuffer> frames,
+                        QString gif_target_path, double anim_delay,
+                        qint64 record_started_ms);
 
  private slots:
-  void ModelLoaded(
-      const std::vector<Vector3D> &vertices,
-      const std::vector<std::vector<unsigned int>> &faces,
-      const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
-          &edges);
-  void ModelLoadedMemento(
-      const std::vector<Vector3D> &vertices,
-      const std::vector<std::vector<unsigned int>> &faces,
-      const std::unordered_set<std::pair<unsigned int, unsigned int>, PairHash>
-          &edges);
   void LoadError(const std::string &error_message);
 
  private:
@@ -119,6 +179,15 @@ class Scene : public QObject {
   S21Matrix get_proj_matrix_temp_(double far);
   S21Matrix update_proj_orth_temp_(double far);
   S21Matrix update_proj_persp_temp_(double far);
+  void start_load_job_(const std::string &obj_file_name, bool restore);
+  void swap_model_slot_(ModelSlot &slot, const std::string &obj_file_name,
+                        bool restore);
+  void release_model_slot_(ModelSlot &slot);
+  void start_lod_job_(std::shared_ptr<const Model3DDataGl> gl_data);
+  void start_feature_job_();
+  void start_validation_job_();
+  void start_gif_job_(std::function<std::unique_ptr<GifCreator>()> creator);
+  void start_gif_thread_(GifCreator *creator);
 };
 
 }  // namespace s21
@@ -0,0 +1,47 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include "include_common.h"
+#include "viewer_memento.h"
+
+namespace s21 {
+
+struct SessionSnapshot {
+  SceneMemento scene;
+  GLWidgetMemento gl_widget;
+};
+
+/**
+ * @brief Хранение состояния сессии в компактном двоичном виде (QDataStream с
+ * заголовком и версией формата). Файл пишется атомарно через QSaveFile:
+ * после сбоя на диске остается либо старый, либо новый снимок целиком.
+ * @details Write() можно вызывать из разных потоков (автосохранение в пуле и
+ * финальное сохранение при выходе). Каждый снимок получает номер из
+ * NextGeneration(), и более старый снимок никогда не перезаписывает более
+ * новый.
+ */
+class SessionStore {
+ private:
+  QString path_;
+  std::mutex write_mutex_;
+  quint64 written_generation_ = 0;
+  std::atomic<quint64> next_generation_ = 0;
+
+ public:
+  static constexpr quint32 kMagic = 0x53323156;  // "S21V"
+  static constexpr quint16 kVersion = 1;
+
+  explicit SessionStore(QString path);
+
+  quint64 NextGeneration();
+  bool Write(const QByteArray &data, quint64 generation);
+  QByteArray Read() const;
+  bool Exists() const;
+
+  static QByteArray Serialize(SceneMemento &scene, GLWidgetMemento &gl_widget);
+  static SessionSnapshot Deserialize(const QByteArray &data);
+};
+
+}  // namespace s21
+
+#endif
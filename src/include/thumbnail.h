@@ -0,0 +1,35 @@
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include "3dmodel.h"
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Программная отрисовка каркаса модели в QImage через QPainter. OpenGL
+ * и окно не нужны, поэтому миниатюры можно строить на сервере без дисплея и
+ * из нескольких потоков одновременно.
+ * @details Модель показывается в параллельной проекции под фиксированным углом
+ * и вписывается в изображение по своей ограничивающей рамке.
+ */
+class ThumbnailRenderer {
+ private:
+  int width_;
+  int height_;
+  QColor line_color_ = QColor(0, 0, 0);
+  QColor back_color_ = QColor(255, 255, 255);
+
+  const double yaw_deg_ = 35.0;
+  const double pitch_deg_ = 25.0;
+  const double margin_ = 0.05;  // доля изображения, оставляемая по краям
+
+ public:
+  ThumbnailRenderer(int width = 256, int height = 256);
+
+  QImage Render(Model3D &model) const;
+};
+
+}  // namespace s21
+
+#endif
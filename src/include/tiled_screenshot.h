@@ -0,0 +1,68 @@
+#ifndef TILED_SCREENSHOT_H
+#define TILED_SCREENSHOT_H
+
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Потоковая запись большого изображения в BMP (24 бита, строки сверху
+ * вниз) полосами. В памяти держится только текущая полоса, поэтому размер
+ * изображения ограничен форматом файла, а не оперативной памятью.
+ */
+class StripImageWriter {
+ private:
+  std::ofstream out_;
+  int width_ = 0;
+  int height_ = 0;
+  int rows_written_ = 0;
+  std::vector<char> row_;
+
+ public:
+  StripImageWriter() = default;
+
+  void Open(const std::string &path, int width, int height);
+  void WriteStrip(const QImage &strip);
+  void Close();
+
+  int GetRowsWritten() const;
+
+ private:
+  void write_header_();
+  void write_u16_(uint16_t value);
+  void write_u32_(uint32_t value);
+  size_t row_stride_() const;
+};
+
+/**
+ * @brief Сохранение скриншота, собранного из плиток, в фоновом потоке. Полосы
+ * плиток приходят из потока gui через очередь сигналов, после записи каждой
+ * полосы испускается StripWritten, чтобы gui не рендерил новые полосы быстрее,
+ * чем они уходят на диск.
+ */
+class TiledScreenshotSaver : public QObject {
+  Q_OBJECT
+ private:
+  StripImageWriter writer_;
+  QString path_;
+  int width_;
+  int height_;
+  bool failed_ = false;
+
+ public:
+  TiledScreenshotSaver(QString path, int width, int height);
+
+ public slots:
+  void Start();
+  void WriteStrip(const QImage &strip);
+  void Finish();
+
+ signals:
+  void StripWritten();
+  void Finished(const QString &path);
+  void SaveError(const std::string &error_message);
+};
+
+}  // namespace s21
+
+#endif
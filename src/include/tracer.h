@@ -0,0 +1,85 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include "include_common.h"
+
+namespace s21 {
+
+/**
+ * @brief Запись трассировки в формате Chrome trace event (открывается в
+ * chrome://tracing и ui.perfetto.dev). Включается переменной окружения
+ * S21_TRACE=файл или параметром --trace=файл, файл пишется при Stop().
+ * @details События хранятся в памяти до Stop(). Пока трассировка выключена,
+ * TraceScope проверяет только один атомарный флаг и ничего не записывает.
+ */
+class Tracer {
+ private:
+  struct Event {
+    const char *name;  // строковые литералы, не копируются
+    const char *category;
+    qint64 start_ns;
+    qint64 duration_ns;
+    int thread_id;
+  };
+
+  static inline std::atomic<bool> enabled_{false};
+
+  mutable std::mutex mutex_;
+  std::vector<Event> events_;
+  std::vector<std::pair<int, std::string>> thread_names_;
+  size_t dropped_events_ = 0;
+  QString path_;
+
+  const size_t max_events_ = 4'000'000;
+
+ public:
+  static Tracer &Instance();
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+  static bool StartFromEnvironment(int argc, char *argv[]);
+  static qint64 NowNs();
+  static int CurrentThreadId();
+
+  void Start(const QString &path = QString());
+  bool Stop();
+  void AddEvent(const char *name, const char *category, qint64 start_ns,
+                qint64 duration_ns);
+  void SetThreadName(const std::string &name);
+  size_t GetEventsCount() const;
+  QJsonObject ToJson() const;
+
+ private:
+  Tracer() = default;
+};
+
+/**
+ * @brief Интервал трассировки от создания объекта до выхода из области
+ * видимости. Конструктор и деструктор в заголовке, чтобы при выключенной
+ * трассировке от них оставалась одна проверка флага.
+ */
+class TraceScope {
+ private:
+  const char *name_;
+  const char *category_;
+  qint64 start_ns_ = -1;
+
+ public:
+  explicit TraceScope(const char *name, const char *category = "viewer")
+      : name_(name), category_(category) {
+    if (Tracer::IsEnabled()) {
+      start_ns_ = Tracer::NowNs();
+    }
+  }
+  ~TraceScope() {
+    if (start_ns_ >= 0) {
+      Tracer::Instance().AddEvent(name_, category_, start_ns_,
+                                  Tracer::NowNs() - start_ns_);
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+};
+
+}  // namespace s21
+
+#endif
@@ -30,6 +30,8 @@ class GLWidgetMemento {
 
   QJsonObject WriteToJson();
   static GLWidgetMemento ReadFromJson(const QJsonObject &json);
+  void WriteToStream(QDataStream &out);
+  static GLWidgetMemento ReadFromStream(QDataStream &in);
 
   QVector4D GetLineColor();
   QVector4D GetBackColor();
@@ -54,6 +56,8 @@ class SceneMemento {
                Projection &projection);
   QJsonObject WriteToJson();
   static SceneMemento ReadFromJson(const QJsonObject &json);
+  void WriteToStream(QDataStream &out);
+  static SceneMemento ReadFromStream(QDataStream &in);
 
   // геттеры
   std::string GetFilePath();
@@ -2,15 +2,29 @@
 #include "./include/include_common.h"
 #include "./include/include_gui_common.h"
 #include "include/affine.h"
+#include "include/batch_cli.h"
 #include "include/controller.h"
 #include "include/scene.h"
+#include "include/tracer.h"
 
 int main(int argc, char *argv[]) {
-  QApplication app(argc, argv);
-  auto model = std::make_unique<s21::Scene>();
-  auto view = std::make_unique<s21::MainWindow>();
-  auto controller =
-      std::make_unique<s21::Controller>(std::move(model), std::move(view));
-  controller->Start();
-  return app.exec();
-}
\ No newline at end of file
+  int result = 0;
+  s21::Tracer::StartFromEnvironment(argc, argv);
+  s21::Tracer::Instance().SetThreadName("main");
+  if (s21::BatchCli::IsBatchMode(argc, argv)) {
+    // консольный режим: без окна и без подключения к дисплею
+    QCoreApplication app(argc, argv);
+    result = s21::BatchCli::Run(app.arguments());
+  } else {
+    Magick::InitializeMagick(*argv);
+    QApplication app(argc, argv);
+    auto model = std::make_unique<s21::Scene>();
+    auto view = std::make_unique<s21::MainWindow>();
+    auto controller =
+        std::make_unique<s21::Controller>(std::move(model), std::move(view));
+    controller->Start();
+    result = app.exec();
+  }
+  s21::Tracer::Instance().Stop();
+  return result;
+}
@@ -0,0 +1,67 @@
+# -----------------------------
+#  obj_converter: прогрев кэша моделей для 3d_viewer (без gui)
+# -----------------------------
+TEMPLATE = app
+CONFIG += c++20 console
+CONFIG += qt warn_on thread
+CONFIG -= app_bundle
+QT += core gui widgets
+
+TARGET = obj_converter
+
+# объектные файлы отдельно от 3d_viewer, чтобы проекты можно было собирать
+# одновременно
+OBJECTS_DIR = .obj_converter
+MOC_DIR = .obj_converter
+
+INCLUDEPATH += \
+    . \
+    include
+
+SOURCES += \
+    cpp_files/affine.cpp \
+    include/matrix/s21_matrix_oop.cpp \
+    include/matrix/s21_matrix_oop_private.cpp \
+    cpp_files/3dmodel.cpp \
+    cpp_files/feature_edges.cpp \
+    cpp_files/mesh_adjacency.cpp \
+    cpp_files/mesh_validation.cpp \
+    cpp_files/job_system.cpp \
+    cpp_files/memory_stats.cpp \
+    cpp_files/tracer.cpp \
+    cpp_files/mesh_cache.cpp \
+    cpp_files/thumbnail.cpp \
+    cpp_files/batch_cli.cpp \
+    converter_main.cpp
+
+HEADERS += \
+    include/3dmodel.h \
+    include/feature_edges.h \
+    include/mesh_adjacency.h \
+    include/mesh_validation.h \
+    include/affine.h \
+    include/job_system.h \
+    include/memory_stats.h \
+    include/tracer.h \
+    include/mesh_cache.h \
+    include/thumbnail.h \
+    include/batch_cli.h \
+    include/include_common.h
+
+# -----------------------------
+#  ImageMagick (подключается через include_common.h)
+# -----------------------------
+IMAGEMAGICK_CFLAGS = $$system(pkg-config --cflags Magick++-6.Q16)
+IMAGEMAGICK_LIBS   = $$system(pkg-config --libs Magick++-6.Q16 MagickWand-6.Q16 MagickCore-6.Q16)
+
+QMAKE_CXXFLAGS += $$IMAGEMAGICK_CFLAGS
+LIBS += $$IMAGEMAGICK_LIBS
+
+QMAKE_CXXFLAGS += -fopenmp
+LIBS += -fopenmp
+
+DEFINES += MAGICKCORE_HDRI_ENABLE=0
+DEFINES += MAGICKCORE_QUANTUM_DEPTH=16
+DEFINES += QT_NO_DEBUG
+
+QMAKE_CXXFLAGS += -O2 -Wall -Wextra -Werror -fPIC
@@ -74,6 +74,17 @@ bool AreEdgesSetEqual(const unordered_set_pair_hash &e1,
   return res;
 }
 
+/**
+ * @brief Можно ли создать QApplication и контекст OpenGL: нужен дисплей или
+ * QT_QPA_PLATFORM=offscreen (llvmpipe подходит). Без них тесты gui
+ * пропускаются.
+ */
+bool HasGuiPlatform() {
+  return qEnvironmentVariableIsSet("DISPLAY") ||
+         qEnvironmentVariableIsSet("WAYLAND_DISPLAY") ||
+         qEnvironmentVariableIsSet("QT_QPA_PLATFORM");
+}
+
 void SignalTaker::TakeSignal(const std::string &error_message) {
   got_error_ = true;
   last_error_ = error_message;
@@ -566,6 +577,72 @@ TEST(ObjTest, LoadCube11) {
   EXPECT_THROW(loader.Load(), std::out_of_range);
 }
 
+TEST(ObjTest, StrictStopsAtFirstError) {
+  s21::ObjLoader loader("tests/cube_errors.obj");
+  loader.Load();
+  EXPECT_FALSE(loader.IsLoaded());
+  ASSERT_EQ(loader.GetErrors().size(), 1);
+  EXPECT_EQ(loader.GetErrors()[0].rfind("line 2:", 0), 0);
+  EXPECT_TRUE(loader.GetVertices().empty());
+}
+
+TEST(ObjTest, LenientSkipsErrors) {
+  s21::ObjLoader loader("tests/cube_errors.obj");
+  loader.SetMode(s21::ObjLoadMode::kLenient);
+  SignalTaker taker;
+  QObject::connect(&loader, &s21::ObjLoader::LoadError, &taker,
+                   &SignalTaker::TakeSignal);
+  loader.Load();
+  EXPECT_TRUE(loader.IsLoaded());
+  EXPECT_TRUE(taker.IsThereError());
+  // без пропущенной вершины 8 грани с ней тоже становятся ошибочными
+  EXPECT_EQ(loader.GetErrors().size(), 7);
+  EXPECT_EQ(loader.GetVertices().size(), 7);
+  EXPECT_EQ(loader.GetFaces().size(), 6);
+}
+
+TEST(ObjTest, LenientIndexOutOfRange) {
+  s21::ObjLoader loader("tests/cube_errors4.obj");
+  loader.SetMode(s21::ObjLoadMode::kLenient);
+  EXPECT_NO_THROW(loader.Load());
+  EXPECT_TRUE(loader.IsLoaded());
+  EXPECT_EQ(loader.GetErrors().size(), 1);
+  EXPECT_EQ(loader.GetFaces().size(), 11);
+}
+
+TEST(ObjTest, CancelAndProgress) {
+  std::string path = "tests/big_generated.obj";
+  {
+    std::ofstream out(path);
+    for (int i = 0; i < 20000; ++i) {
+      out << "v " << i << " 0.5 -0.5\n";
+    }
+  }
+  s21::ObjLoader loader(path);
+  qint64 last_bytes = 0;
+  qint64 file_bytes = 0;
+  int progress_count = 0;
+  QObject::connect(&loader, &s21::ObjLoader::Progress,
+                   [&](qint64 bytes_read, qint64 total_bytes) {
+                     last_bytes = bytes_read;
+                     file_bytes = total_bytes;
+                     ++progress_count;
+                   });
+  loader.Load();
+  EXPECT_TRUE(loader.IsLoaded());
+  EXPECT_GT(progress_count, 10);
+  EXPECT_LE(progress_count, 102);
+  EXPECT_EQ(last_bytes, file_bytes);
+
+  s21::CancellationToken token;
+  token.Cancel();
+  loader.SetCancellationToken(token);
+  loader.Load();
+  EXPECT_TRUE(loader.IsCancelled());
+  EXPECT_FALSE(loader.IsLoaded());
+  std::remove(path.c_str());
+}
+
 TEST(ModelTest, LoadCube12) {
   s21::ObjLoader loader("tests/cube.obj");
   loader.Load();
@@ -700,9 +777,1447 @@ TEST(ModelTest, LoadCube21) {
   EXPECT_TRUE(res == exp_res);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для FrameRingBuffer
+
+TEST(FrameBufferTest, PushPop) {
+  s21::FrameRingBuffer buffer(2, 4, 2);
+  QImage image(4, 2, QImage::Format_RGB32);
+  image.fill(QColor(10, 20, 30));
+  EXPECT_TRUE(buffer.Push(image));
+  EXPECT_EQ(buffer.GetSize(), 1);
+  s21::RawFrame frame;
+  EXPECT_TRUE(buffer.Pop(frame));
+  EXPECT_EQ(frame.width, 4);
+  EXPECT_EQ(frame.height, 2);
+  EXPECT_EQ(frame.pixels[0], 30);  // B
+  EXPECT_EQ(frame.pixels[1], 20);  // G
+  EXPECT_EQ(frame.pixels[2], 10);  // R
+}
+
+TEST(FrameBufferTest, DropWhenFull) {
+  s21::FrameRingBuffer buffer(2, 4, 2);
+  QImage image(4, 2, QImage::Format_RGB32);
+  image.fill(Qt::black);
+  EXPECT_TRUE(buffer.Push(image));
+  EXPECT_TRUE(buffer.Push(image));
+  EXPECT_FALSE(buffer.Push(image));
+  EXPECT_EQ(buffer.GetDroppedCount(), 1);
+  EXPECT_EQ(buffer.GetPushedCount(), 2);
+}
+
+TEST(FrameBufferTest, Close) {
+  s21::FrameRingBuffer buffer(2, 4, 2);
+  QImage image(8, 8, QImage::Format_RGB32);
+  image.fill(Qt::white);
+  EXPECT_TRUE(buffer.Push(image));
+  buffer.Close();
+  s21::RawFrame frame;
+  EXPECT_TRUE(buffer.Pop(frame));
+  EXPECT_EQ(frame.width, 8);
+  EXPECT_EQ(frame.GetBytes(), 8 * 8 * 4);
+  EXPECT_FALSE(buffer.Pop(frame));
+  EXPECT_FALSE(buffer.Push(image));
+}
+
+TEST(FrameBufferTest, PopKeepsSlotsAllocated) {
+  s21::FrameRingBuffer buffer(2, 4, 2);
+  const size_t allocated = buffer.GetAllocatedBytes();
+  EXPECT_EQ(allocated, 2 * 4 * 2 * 4);
+  QImage image(4, 2, QImage::Format_RGB32);
+  image.fill(Qt::black);
+  EXPECT_TRUE(buffer.Push(image));
+  s21::RawFrame frame;
+  EXPECT_TRUE(buffer.Pop(frame));
+  EXPECT_EQ(frame.GetBytes(), 4 * 2 * 4);
+  // слот получил буфер нужного размера: следующий Push не выделяет память
+  EXPECT_EQ(buffer.GetAllocatedBytes(), allocated);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для GifFrameEncoder
+
+s21::RawFrame MakeFilledFrame(int width, int height, const QColor &color) {
+  QImage image(width, height, QImage::Format_RGB32);
+  image.fill(color);
+  s21::RawFrame frame;
+  frame.CopyFrom(image);
+  return frame;
+}
+
+TEST(GifEncoderTest, GlobalPalette) {
+  std::vector<s21::RawFrame> frames = {
+      MakeFilledFrame(4, 4, QColor(255, 255, 255)),
+      MakeFilledFrame(4, 4, QColor(0, 0, 0)),
+      MakeFilledFrame(4, 4, QColor(255, 255, 255))};
+  s21::GifFrameEncoder encoder(256);
+  encoder.BuildPalette(frames);
+  EXPECT_EQ(encoder.GetPalette().size(), 2);
+  encoder.ApplyPalette(frames);
+  EXPECT_EQ(frames[0].pixels[0], 255);
+  EXPECT_EQ(frames[1].pixels[0], 0);
+}
+
+TEST(GifEncoderTest, PaletteLimit) {
+  QImage image(16, 16, QImage::Format_RGB32);
+  for (int y = 0; y < 16; ++y) {
+    for (int x = 0; x < 16; ++x) {
+      image.setPixelColor(x, y, QColor(x * 16, y * 16, 128));
+    }
+  }
+  std::vector<s21::RawFrame> frames(1);
+  frames[0].CopyFrom(image);
+  s21::GifFrameEncoder encoder(8);
+  encoder.BuildPalette(frames);
+  EXPECT_EQ(encoder.GetPalette().size(), 8);
+}
+
+TEST(GifEncoderTest, ChangedRect) {
+  s21::RawFrame prev = MakeFilledFrame(10, 10, QColor(0, 0, 0));
+  QImage image(10, 10, QImage::Format_RGB32);
+  image.fill(QColor(0, 0, 0));
+  image.setPixelColor(2, 3, QColor(255, 0, 0));
+  image.setPixelColor(6, 5, QColor(255, 0, 0));
+  s21::RawFrame cur;
+  cur.CopyFrom(image);
+  s21::FrameRect rect = s21::GifFrameEncoder::FindChangedRect(prev, cur);
+  EXPECT_EQ(rect.x, 2);
+  EXPECT_EQ(rect.y, 3);
+  EXPECT_EQ(rect.width, 5);
+  EXPECT_EQ(rect.height, 3);
+}
+
+TEST(GifEncoderTest, ChangedRectEmpty) {
+  s21::RawFrame prev = MakeFilledFrame(10, 10, QColor(0, 0, 0));
+  s21::RawFrame cur = MakeFilledFrame(10, 10, QColor(0, 0, 0));
+  EXPECT_TRUE(s21::GifFrameEncoder::FindChangedRect(prev, cur).IsEmpty());
+}
+
+TEST(GifEncoderTest, SkipSameFrames) {
+  std::vector<s21::RawFrame> frames = {
+      MakeFilledFrame(4, 4, QColor(0, 0, 0)),
+      MakeFilledFrame(4, 4, QColor(0, 0, 0)),
+      MakeFilledFrame(4, 4, QColor(255, 0, 0))};
+  s21::GifFrameEncoder encoder;
+  std::vector<Magick::Image> images = encoder.Encode(frames, 10);
+  EXPECT_EQ(images.size(), 2);
+  EXPECT_EQ(images[0].animationDelay(), 20);
+}
+
+TEST(GifEncoderTest, NoFrames) {
+  std::vector<s21::RawFrame> frames;
+  s21::GifFrameEncoder encoder;
+  EXPECT_TRUE(encoder.Encode(frames, 10).empty());
+  // пустой первый кадр не к чему присоединить, он пропускается
+  frames.emplace_back();
+  frames.push_back(MakeFilledFrame(4, 4, QColor(255, 0, 0)));
+  std::vector<Magick::Image> images = encoder.Encode(frames, 10);
+  EXPECT_EQ(images.size(), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для ImageEncodingService
+
+TEST(ImageEncoderTest, SaveInBackground) {
+  s21::ImageEncodingService service(4, 2);
+  for (int i = 0; i < 3; ++i) {
+    QImage image(8, 8, QImage::Format_RGB32);
+    image.fill(QColor(0, 255, 0));
+    QString path = QString("tests/encoder_test_%1.bmp").arg(i);
+    EXPECT_TRUE(service.Submit(std::move(image), path, "BMP"));
+  }
+  service.WaitIdle();
+  EXPECT_EQ(service.GetQueueDepth(), 0);
+  EXPECT_EQ(service.GetEncodedCount(), 3);
+  EXPECT_EQ(service.GetFailedCount(), 0);
+  for (int i = 0; i < 3; ++i) {
+    QString path = QString("tests/encoder_test_%1.bmp").arg(i);
+    EXPECT_TRUE(QFileInfo(path).exists());
+    QFile::remove(path);
+  }
+}
+
+TEST(ImageEncoderTest, DropAfterStop) {
+  s21::ImageEncodingService service(1, 1);
+  service.Stop();
+  QImage image(8, 8, QImage::Format_RGB32);
+  EXPECT_FALSE(service.Submit(image, "tests/encoder_test_drop.bmp", "BMP"));
+  EXPECT_EQ(service.GetDroppedCount(), 1);
+  EXPECT_FALSE(QFileInfo("tests/encoder_test_drop.bmp").exists());
+}
+
+TEST(ImageEncoderTest, FailedSave) {
+  s21::ImageEncodingService service;
+  QImage image(8, 8, QImage::Format_RGB32);
+  image.fill(QColor(0, 0, 0));
+  service.Submit(image, "tests/no_such_dir/encoder_test.bmp", "BMP");
+  service.WaitIdle();
+  EXPECT_EQ(service.GetFailedCount(), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для асинхронного захвата кадров
+
+TEST(CaptureTest, ReadbackFlip) {
+  // 2 x 2 пикселя, строки снизу вверх: нижняя строка красная, верхняя синяя
+  const unsigned char pixels[] = {0,   0, 255, 255, 0,   0, 255, 255,
+                                  255, 0, 0,   255, 255, 0, 0,   255};
+  QImage image = s21::GLWidget::ImageFromReadback(pixels, 2, 2);
+  EXPECT_EQ(image.format(), QImage::Format_RGB32);
+  EXPECT_EQ(image.pixelColor(0, 0), QColor(0, 0, 255));
+  EXPECT_EQ(image.pixelColor(1, 1), QColor(255, 0, 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для JobSystem
+
+TEST(JobSystemTest, Priorities) {
+  s21::JobSystem jobs(1);
+  std::mutex gate;
+  std::vector<int> order;
+  gate.lock();
+  // первая задача держит единственный поток, пока очередь заполняется
+  jobs.Submit([&gate](const s21::CancellationToken &) {
+    std::lock_guard<std::mutex> lock(gate);
+  });
+  auto push = [&order](int value) {
+    return [&order, value](const s21::CancellationToken &) {
+      order.push_back(value);
+    };
+  };
+  jobs.Submit(push(1), s21::JobPriority::kLow);
+  jobs.Submit(push(2), s21::JobPriority::kNormal);
+  jobs.Submit(push(3), s21::JobPriority::kHigh);
+  jobs.Submit(push(4), s21::JobPriority::kHigh);
+  gate.unlock();
+  jobs.WaitIdle();
+  EXPECT_EQ(order, std::vector<int>({3, 4, 2, 1}));
+}
+
+TEST(JobSystemTest, CancelBeforeStart) {
+  s21::JobSystem jobs(1);
+  std::mutex gate;
+  gate.lock();
+  jobs.Submit([&gate](const s21::CancellationToken &) {
+    std::lock_guard<std::mutex> lock(gate);
+  });
+  bool executed = false;
+  bool was_cancelled = false;
+  s21::CancellationToken token = jobs.Submit(
+      [&executed](const s21::CancellationToken &) { executed = true; },
+      s21::JobPriority::kNormal, nullptr,
+      [&was_cancelled](bool cancelled) { was_cancelled = cancelled; });
+  token.Cancel();
+  gate.unlock();
+  jobs.WaitIdle();
+  EXPECT_FALSE(executed);
+  EXPECT_TRUE(was_cancelled);
+}
+
+TEST(JobSystemTest, CancelRunning) {
+  s21::JobSystem jobs(2);
+  std::atomic<bool> started = false;
+  std::atomic<int> iterations = 0;
+  s21::CancellationToken token =
+      jobs.Submit([&](const s21::CancellationToken &job_token) {
+        started = true;
+        while (!job_token.IsCancelled()) {
+          ++iterations;
+          std::this_thread::yield();
+        }
+      });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  token.Cancel();
+  jobs.WaitIdle();
+  EXPECT_TRUE(token.IsCancelled());
+  EXPECT_GT(iterations, 0);
+}
+
+TEST(JobSystemTest, ExceptionInJob) {
+  s21::JobSystem jobs(1);
+  bool done = false;
+  jobs.Submit(
+      [](const s21::CancellationToken &) {
+        throw std::runtime_error("job error");
+      },
+      s21::JobPriority::kNormal, nullptr, [&done](bool) { done = true; });
+  jobs.WaitIdle();
+  EXPECT_TRUE(done);
+  EXPECT_EQ(jobs.GetPendingCount(), 0);
+}
+
+TEST(JobSystemTest, CompletionOnCreatorThread) {
+  int argc = 1;
+  char name[] = "tests";
+  char *argv[] = {name};
+  std::unique_ptr<QCoreApplication> application;
+  if (!QCoreApplication::instance()) {
+    application = std::make_unique<QCoreApplication>(argc, argv);
+  }
+  s21::JobSystem jobs(1);
+  auto receiver = std::make_unique<QObject>();
+  auto deleted_receiver = std::make_unique<QObject>();
+  std::thread::id done_thread;
+  bool deleted_done = false;
+  jobs.Submit([](const s21::CancellationToken &) {},
+              s21::JobPriority::kNormal, receiver.get(),
+              [&done_thread](bool) {
+                done_thread = std::this_thread::get_id();
+              });
+  jobs.Submit([](const s21::CancellationToken &) {},
+              s21::JobPriority::kNormal, deleted_receiver.get(),
+              [&deleted_done](bool) { deleted_done = true; });
+  jobs.WaitIdle();
+  // получатель удален после завершения задачи, но до доставки
+  deleted_receiver.reset();
+  QCoreApplication::processEvents();
+  EXPECT_EQ(done_thread, std::this_thread::get_id());
+  EXPECT_FALSE(deleted_done);
+}
+
+TEST(JobSystemTest, SubmitAfterShutdown) {
+  s21::JobSystem jobs(1);
+  jobs.Shutdown();
+  s21::CancellationToken token =
+      jobs.Submit([](const s21::CancellationToken &) {});
+  EXPECT_TRUE(token.IsCancelled());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для скриншота из плиток
+
+TEST(TestAffine, ProjTileWhole) {
+  std::unique_ptr mat = std::make_unique<s21::S21MatrixWrapper>(4, 4);
+  s21::AffineTransDecorator aff(std::move(mat));
+  S21Matrix proj = aff.CreateProjMatrixOrth(-16, 16, -12, 12, 1, 10);
+  S21Matrix tile = aff.CreateProjMatrixTile(proj, 0, 0, 1, 1);
+  EXPECT_TRUE(AreMatricesEqual(tile, proj));
+}
+
+TEST(TestAffine, ProjTileCorner) {
+  std::unique_ptr mat = std::make_unique<s21::S21MatrixWrapper>(4, 4);
+  s21::AffineTransDecorator aff(std::move(mat));
+  S21Matrix proj(4, 4);
+  proj.SetIdentity();
+  // левая верхняя плитка из 2 x 2: центр плитки (-0.5, 0.5) уходит в центр
+  S21Matrix tile = aff.CreateProjMatrixTile(proj, 0, 0, 2, 2);
+  S21Matrix point(4, 1);
+  point(0, 0) = -0.5;
+  point(1, 0) = 0.5;
+  point(3, 0) = 1.0;
+  S21Matrix result = tile * point;
+  EXPECT_TRUE(AreDoublesEq(result(0, 0), 0.0));
+  EXPECT_TRUE(AreDoublesEq(result(1, 0), 0.0));
+  EXPECT_THROW(aff.CreateProjMatrixTile(proj, 2, 0, 2, 2),
+               std::invalid_argument);
+}
+
+TEST(TestAffine, ProjAspect) {
+  std::unique_ptr mat = std::make_unique<s21::S21MatrixWrapper>(4, 4);
+  s21::AffineTransDecorator aff(std::move(mat));
+  S21Matrix persp = aff.CreateProjMatrixPersp(90, 4.0 / 3.0, 0.01, 15);
+  EXPECT_TRUE(AreMatricesEqual(
+      aff.CreateProjMatrixAspect(persp, 4.0 / 3.0, 2.0),
+      aff.CreateProjMatrixPersp(90, 2.0, 0.01, 15)));
+  // при aspect 2 видимая ширина 48 при той же высоте 24
+  S21Matrix orth = aff.CreateProjMatrixOrth(-16, 16, -12, 12, 0.01, 15);
+  EXPECT_TRUE(AreMatricesEqual(aff.CreateProjMatrixAspect(orth, 4.0 / 3.0, 2.0),
+                               aff.CreateProjMatrixOrth(-24, 24, -12, 12,
+                                                        0.01, 15)));
+  EXPECT_THROW(aff.CreateProjMatrixAspect(orth, 4.0 / 3.0, 0.0),
+               std::invalid_argument);
+}
+
+TEST(StripWriterTest, WriteBmp) {
+  std::string path = "tests/strip_writer_test.bmp";
+  s21::StripImageWriter writer;
+  writer.Open(path, 3, 4);
+  QImage strip(3, 2, QImage::Format_RGB32);
+  strip.fill(QColor(255, 0, 0));
+  writer.WriteStrip(strip);
+  strip.fill(QColor(0, 0, 255));
+  writer.WriteStrip(strip);
+  EXPECT_EQ(writer.GetRowsWritten(), 4);
+  writer.Close();
+
+  std::ifstream in(path, std::ios::binary);
+  std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)),
+                                  std::istreambuf_iterator<char>());
+  // 54 байта заголовка + 4 строки по 12 байт (9 байт пикселей + выравнивание)
+  ASSERT_EQ(data.size(), 54 + 4 * 12);
+  EXPECT_EQ(data[0], 'B');
+  EXPECT_EQ(data[1], 'M');
+  // первая строка файла - верхняя строка изображения (красная, порядок BGR)
+  EXPECT_EQ(data[54], 0);
+  EXPECT_EQ(data[56], 255);
+  // последняя строка - синяя
+  EXPECT_EQ(data[54 + 3 * 12], 255);
+  EXPECT_EQ(data[54 + 3 * 12 + 2], 0);
+  std::remove(path.c_str());
+}
+
+TEST(StripWriterTest, WrongStrip) {
+  std::string path = "tests/strip_writer_test_wrong.bmp";
+  s21::StripImageWriter writer;
+  writer.Open(path, 3, 2);
+  QImage strip(4, 2, QImage::Format_RGB32);
+  EXPECT_THROW(writer.WriteStrip(strip), std::invalid_argument);
+  EXPECT_THROW(writer.Close(), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для SessionStore
+
+static s21::GLWidgetMemento CreateTestGLMemento() {
+  return s21::GLWidgetMemento(QVector4D(1.0f, 0.0f, 0.0f, 1.0f),
+                              QVector4D(0.0f, 0.0f, 0.0f, 1.0f), 2.0f, false,
+                              0x00FF, 2, 5.0f, true, true,
+                              QVector4D(0.0f, 1.0f, 0.0f, 1.0f));
+}
+
+TEST(SessionStoreTest, RoundTrip) {
+  std::string path = "models/cube.obj";
+  S21Matrix transformation(4, 4);
+  for (int i = 0; i < 4; ++i) transformation(i, i) = 1.0;
+  transformation(0, 3) = 2.5;
+  s21::Projection projection;
+  projection.SetFar(150.0);
+  projection.SetOrthogonal();
+  s21::SceneMemento scene(path, transformation, projection);
+  s21::GLWidgetMemento gl_widget = CreateTestGLMemento();
+
+  QByteArray data = s21::SessionStore::Serialize(scene, gl_widget);
+  s21::SessionSnapshot snapshot = s21::SessionStore::Deserialize(data);
+
+  EXPECT_EQ(snapshot.scene.GetFilePath(), path);
+  EXPECT_TRUE(snapshot.scene.GetTransformationMatrix() == transformation);
+  s21::Projection restored = snapshot.scene.GetProjection();
+  EXPECT_FALSE(restored.IsPerspectiveProjection());
+  EXPECT_TRUE(AreDoublesEq(restored.GetFar(), 150.0));
+  EXPECT_EQ(snapshot.gl_widget.GetLineColor(), gl_widget.GetLineColor());
+  EXPECT_EQ(snapshot.gl_widget.GetStipplePattern(), 0x00FF);
+  EXPECT_EQ(snapshot.gl_widget.GetStippleFactor(), 2);
+  EXPECT_FALSE(snapshot.gl_widget.IsLineSolid());
+  EXPECT_TRUE(snapshot.gl_widget.IsPointVertexRound());
+}
+
+TEST(SessionStoreTest, WrongData) {
+  EXPECT_THROW(s21::SessionStore::Deserialize(QByteArray("{\"scene\": {}}")),
+               std::invalid_argument);
+  EXPECT_THROW(s21::SessionStore::Deserialize(QByteArray()),
+               std::invalid_argument);
+
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out << s21::SessionStore::kMagic << quint16(s21::SessionStore::kVersion + 1);
+  EXPECT_THROW(s21::SessionStore::Deserialize(data), std::invalid_argument);
+}
+
+TEST(SessionStoreTest, StaleGenerationSkipped) {
+  std::string path = "tests/session_store_test.bin";
+  s21::SessionStore store(QString::fromStdString(path));
+  quint64 older = store.NextGeneration();
+  quint64 newer = store.NextGeneration();
+  EXPECT_TRUE(store.Write(QByteArray("new"), newer));
+  EXPECT_FALSE(store.Write(QByteArray("old"), older));
+  EXPECT_EQ(store.Read(), QByteArray("new"));
+  std::remove(path.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для MeshCache, ThumbnailRenderer и пакетного режима
+
+TEST(MeshCacheTest, RoundTrip) {
+  QString source = "tests/cube.obj";
+  QString cache = "tests/mesh_cache_test.s21mesh";
+  s21::ObjLoader loader(source.toStdString());
+  loader.Load();
+  s21::MeshCache::Write(cache, source, loader.GetVertices(),
+                        loader.GetFaces(), loader.GetEdges());
+  EXPECT_TRUE(s21::MeshCache::IsValid(cache, source));
+  EXPECT_FALSE(s21::MeshCache::IsValid(cache, "tests/cube_errors.obj"));
+
+  s21::MeshData mesh = s21::MeshCache::Read(cache);
+  EXPECT_TRUE(AreVerticesVectorsEqual(mesh.vertices, loader.GetVertices()));
+  EXPECT_EQ(mesh.faces, loader.GetFaces());
+  EXPECT_EQ(mesh.edges, loader.GetEdges());
+  std::remove(cache.toStdString().c_str());
+}
+
+TEST(MeshCacheTest, CorruptedFile) {
+  QString source = "tests/cube.obj";
+  QString cache = "tests/mesh_cache_corrupted.s21mesh";
+  s21::ObjLoader loader(source.toStdString());
+  loader.Load();
+  // ребро ссылается на вершину, которой нет
+  auto edges = loader.GetEdges();
+  edges.insert({0, 100});
+  s21::MeshCache::Write(cache, source, loader.GetVertices(),
+                        loader.GetFaces(), edges);
+  EXPECT_THROW(s21::MeshCache::Read(cache), std::invalid_argument);
+
+  s21::MeshCache::Write(cache, source, loader.GetVertices(),
+                        loader.GetFaces(), loader.GetEdges());
+  QFile file(cache);
+  ASSERT_TRUE(file.resize(file.size() / 2));
+  EXPECT_THROW(s21::MeshCache::Read(cache), std::invalid_argument);
+  std::remove(cache.toStdString().c_str());
+}
+
+TEST(MeshCacheTest, WrongFile) {
+  EXPECT_THROW(s21::MeshCache::Read("tests/cube.obj"), std::invalid_argument);
+  EXPECT_THROW(s21::MeshCache::Read("tests/blabla.s21mesh"),
+               std::invalid_argument);
+  EXPECT_FALSE(s21::MeshCache::IsValid("tests/cube.obj", "tests/cube.obj"));
+}
+
+TEST(ThumbnailTest, RenderCube) {
+  s21::ObjLoader loader("tests/cube.obj");
+  loader.Load();
+  s21::Model3D model;
+  model.SetData(loader.GetVertices(), loader.GetFaces(), loader.GetEdges());
+  QImage image = s21::ThumbnailRenderer(64, 64).Render(model);
+  EXPECT_EQ(image.width(), 64);
+  EXPECT_EQ(image.height(), 64);
+  // углы остаются цветом фона, модель рисуется в середине
+  EXPECT_EQ(image.pixelColor(0, 0), QColor(255, 255, 255));
+  bool has_lines = false;
+  for (int x = 0; x < 64 && !has_lines; ++x) {
+    has_lines = image.pixelColor(x, 32) != QColor(255, 255, 255);
+  }
+  EXPECT_TRUE(has_lines);
+  EXPECT_THROW(s21::ThumbnailRenderer(0, 64), std::invalid_argument);
+}
+
+TEST(BatchTest, ProcessFiles) {
+  s21::BatchOptions options;
+  options.files = {"tests/cube.obj", "tests/blabla.obj"};
+  options.threads = 2;
+  std::vector<s21::BatchResult> results = s21::BatchProcessor(options).Run();
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_TRUE(results[0].loaded);
+  EXPECT_EQ(results[0].vertices, 8);
+  EXPECT_EQ(results[0].faces, 12);
+  EXPECT_TRUE(AreDoublesEq(results[0].box.min.x, -1.0));
+  EXPECT_TRUE(AreDoublesEq(results[0].box.max.z, 1.0));
+  EXPECT_FALSE(results[1].loaded);
+  EXPECT_FALSE(results[1].errors.empty());
+
+  QJsonObject report = s21::BatchProcessor::ReportToJson(results, options, 0);
+  EXPECT_EQ(report["failed"].toInt(), 1);
+}
+
+TEST(BatchTest, ParseArguments) {
+  QStringList arguments = {"3d_viewer", "--batch",  "--threads", "3",
+                           "--lenient", "--cache",  "cache",     "a.obj",
+                           "b.obj"};
+  s21::BatchOptions options = s21::BatchCli::ParseArguments(arguments);
+  EXPECT_EQ(options.threads, 3);
+  EXPECT_EQ(options.mode, s21::ObjLoadMode::kLenient);
+  EXPECT_EQ(options.cache_dir, QString("cache"));
+  EXPECT_TRUE(options.thumbnail_dir.isEmpty());
+  EXPECT_EQ(options.files.size(), 2);
+
+  EXPECT_THROW(s21::BatchCli::ParseArguments({"3d_viewer", "--batch"}),
+               std::invalid_argument);
+  EXPECT_THROW(
+      s21::BatchCli::ParseArguments({"3d_viewer", "--threads", "0", "a.obj"}),
+      std::invalid_argument);
+  EXPECT_THROW(s21::BatchCli::ParseArguments({"3d_viewer", "--unknown"}),
+               std::invalid_argument);
+  EXPECT_THROW(s21::BatchCli::ParseArguments({"3d_viewer", "--cache"}),
+               std::invalid_argument);
+}
+
+TEST(BatchTest, CollectObjFiles) {
+  std::vector<QString> files = s21::BatchProcessor::CollectObjFiles("tests");
+  ASSERT_EQ(files.size(), 5);
+  EXPECT_TRUE(std::is_sorted(files.begin(), files.end()));
+  EXPECT_TRUE(files.front().endsWith("cube.obj"));
+  EXPECT_EQ(s21::BatchProcessor::CollectObjFiles("tests/cube.obj").size(), 1);
+}
+
+TEST(BatchTest, SkipValidCache) {
+  QString cache_dir = "tests/batch_cache_test";
+  QDir().mkpath(cache_dir);
+  s21::BatchOptions options;
+  options.files = {"tests/cube.obj", "tests/cube_errors.obj"};
+  options.cache_dir = cache_dir;
+  options.mode = s21::ObjLoadMode::kLenient;
+  options.skip_valid_cache = true;
+
+  std::vector<s21::BatchResult> first = s21::BatchProcessor(options).Run();
+  EXPECT_FALSE(first[0].skipped);
+  EXPECT_FALSE(first[0].cache_path.isEmpty());
+  // файл с ошибками загружен, но кэш для него не пишется
+  EXPECT_TRUE(first[1].loaded);
+  EXPECT_TRUE(first[1].cache_path.isEmpty());
+
+  std::vector<s21::BatchResult> second = s21::BatchProcessor(options).Run();
+  EXPECT_TRUE(second[0].skipped);
+  EXPECT_FALSE(second[1].skipped);
+
+  // просмотрщик читает модель из того же кэша
+  s21::ObjLoader loader("tests/cube.obj");
+  loader.SetCacheDir(cache_dir);
+  loader.Load();
+  EXPECT_TRUE(loader.IsLoaded());
+  EXPECT_TRUE(loader.IsFromCache());
+  EXPECT_EQ(loader.GetVertices().size(), 8);
+  EXPECT_EQ(loader.GetFaces().size(), 12);
+
+  QDir(cache_dir).removeRecursively();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для Tracer
+
+TEST(TracerTest, ScopesRecordedOnlyWhenEnabled) {
+  s21::Tracer &tracer = s21::Tracer::Instance();
+  tracer.Start();
+  tracer.Stop();
+  { s21::TraceScope scope("disabled"); }
+  EXPECT_EQ(tracer.GetEventsCount(), 0);
+
+  tracer.Start();
+  { s21::TraceScope scope("enabled", "test"); }
+  std::thread([] { s21::TraceScope scope("other thread", "test"); }).join();
+  EXPECT_TRUE(tracer.Stop());
+  EXPECT_EQ(tracer.GetEventsCount(), 2);
+
+  QJsonArray events = tracer.ToJson()["traceEvents"].toArray();
+  std::vector<QJsonObject> intervals;
+  for (const auto &event : events) {
+    if (event.toObject()["ph"].toString() == "X") {
+      intervals.push_back(event.toObject());
+    }
+  }
+  ASSERT_EQ(intervals.size(), 2);
+  EXPECT_EQ(intervals[0]["name"].toString(), "enabled");
+  EXPECT_EQ(intervals[0]["cat"].toString(), "test");
+  EXPECT_GE(intervals[0]["dur"].toDouble(), 0.0);
+  EXPECT_NE(intervals[0]["tid"].toInt(), intervals[1]["tid"].toInt());
+}
+
+TEST(TracerTest, WritesTraceFile) {
+  QString path = "tests/trace_test.json";
+  s21::Tracer &tracer = s21::Tracer::Instance();
+  tracer.Start(path);
+  s21::ObjLoader loader("tests/cube.obj");
+  loader.Load();
+  EXPECT_TRUE(tracer.Stop());
+
+  QFile file(path);
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  QJsonObject trace = QJsonDocument::fromJson(file.readAll()).object();
+  file.close();
+  bool has_load = false;
+  for (const auto &event : trace["traceEvents"].toArray()) {
+    has_load |= event.toObject()["name"].toString() == "ObjLoader::Load";
+  }
+  EXPECT_TRUE(has_load);
+  QFile::remove(path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для MemoryStats
+
+TEST(MemoryStatsTest, HeapEstimates) {
+  EXPECT_EQ(s21::MemoryStats::HeapBlockBytes(0), 0);
+  EXPECT_EQ(s21::MemoryStats::HeapBlockBytes(1), 32);
+  EXPECT_EQ(s21::MemoryStats::HeapBlockBytes(24), 32);
+  EXPECT_EQ(s21::MemoryStats::HeapBlockBytes(25), 48);
+  // узел 24 байта (блок 32) на элемент и 29 корзин по 8 байт (блок 240)
+  EXPECT_EQ(s21::MemoryStats::HashSetOverheadBytes(18, 29, 8),
+            18 * (32 - 8) + 240);
+  EXPECT_EQ(s21::MemoryStats::FormatBytes(512), "512 B");
+  EXPECT_EQ(s21::MemoryStats::FormatBytes(3 * 1024 * 1024), "3.0 MB");
+}
+
+TEST(MemoryStatsTest, ModelCategories) {
+  s21::ObjLoader loader("tests/cube.obj");
+  loader.Load();
+  s21::Model3D model;
+  model.SetData(loader.GetVertices(), loader.GetFaces(), loader.GetEdges());
+  s21::MemoryStats stats;
+  model.AccountMemory(stats);
+
+  EXPECT_GE(stats.Get(s21::MemoryCategory::kVertices),
+            8 * sizeof(s21::Vector3D));
+  EXPECT_GE(stats.Get(s21::MemoryCategory::kFaces), 12 * 3 * sizeof(unsigned));
+  EXPECT_EQ(stats.Get(s21::MemoryCategory::kEdges),
+            model.GetEdgesCount() * sizeof(std::pair<unsigned, unsigned>));
+  EXPECT_GT(stats.Get(s21::MemoryCategory::kEdgesHashOverhead), 0);
+  EXPECT_EQ(stats.Get(s21::MemoryCategory::kGlVertexBuffer), 0);
+  EXPECT_EQ(stats.GetGpuBytes(), 0);
+  EXPECT_EQ(stats.GetCpuBytes(),
+            stats.Get(s21::MemoryCategory::kVertices) +
+                stats.Get(s21::MemoryCategory::kFaces) +
+                stats.Get(s21::MemoryCategory::kEdges) +
+                stats.Get(s21::MemoryCategory::kEdgesHashOverhead));
+  EXPECT_EQ(stats.ToJson()["edges"].toInt(),
+            static_cast<int>(stats.Get(s21::MemoryCategory::kEdges)));
+}
+
+TEST(MemoryStatsTest, LoadPrediction) {
+  size_t predicted = 0, available = 0;
+  EXPECT_FALSE(s21::MemoryStats::IsLoadTooLarge(1024, predicted, available));
+  EXPECT_EQ(predicted, s21::MemoryStats::PredictLoadBytes(1024));
+  EXPECT_GT(available, 0);
+  EXPECT_TRUE(s21::MemoryStats::IsLoadTooLarge(
+      static_cast<qint64>(available), predicted, available));
+  EXPECT_GT(s21::MemoryStats::PeakRssBytes(), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для ModelCache
+
+static std::shared_ptr<const s21::MeshData> LoadTestMesh() {
+  s21::ObjLoader loader("tests/cube.obj");
+  loader.Load();
+  return std::make_shared<const s21::MeshData>(loader.TakeData());
+}
+
+TEST(ModelCacheTest, HitsMissesAndEvictions) {
+  std::shared_ptr<const s21::MeshData> mesh = LoadTestMesh();
+  EXPECT_EQ(mesh->vertices.size(), 8);
+  s21::ModelCache cache(mesh->GetBytes() * 2);
+
+  EXPECT_EQ(cache.Find("tests/cube.obj"), nullptr);
+  cache.Insert("tests/cube.obj", s21::FileStamp::Of("tests/cube.obj"), mesh);
+  cache.Insert("tests/cube_errors.obj",
+               s21::FileStamp::Of("tests/cube_errors.obj"), mesh);
+  EXPECT_EQ(cache.Find("tests/cube.obj"), mesh);
+  EXPECT_EQ(cache.GetEntriesCount(), 2);
+  EXPECT_EQ(cache.GetUsedBytes(), mesh->GetBytes() * 2);
+
+  // cube_errors.obj использовался давнее всех и вытесняется первым
+  cache.Insert("tests/cube_errors2.obj",
+               s21::FileStamp::Of("tests/cube_errors2.obj"), mesh);
+  EXPECT_TRUE(cache.Contains("tests/cube.obj"));
+  EXPECT_FALSE(cache.Contains("tests/cube_errors.obj"));
+  EXPECT_TRUE(cache.Contains("tests/cube_errors2.obj"));
+
+  s21::MemoryStats stats;
+  cache.AccountMemory(stats);
+  EXPECT_EQ(stats.Get(s21::MemoryCategory::kModelCache), mesh->GetBytes() * 2);
+  EXPECT_EQ(stats.GetCounter("model_cache_hits"), 1);
+  EXPECT_EQ(stats.GetCounter("model_cache_misses"), 1);
+  EXPECT_EQ(stats.GetCounter("model_cache_evictions"), 1);
+
+  cache.SetBudget(0);
+  EXPECT_EQ(cache.GetEntriesCount(), 0);
+  EXPECT_EQ(cache.GetUsedBytes(), 0);
+}
+
+TEST(ModelCacheTest, ChangedFileIsStale) {
+  std::string path = "tests/model_cache_test.obj";
+  QFile::remove(QString::fromStdString(path));
+  ASSERT_TRUE(QFile::copy("tests/cube.obj", QString::fromStdString(path)));
+  s21::ModelCache cache;
+  cache.Insert(path, s21::FileStamp::Of(path), LoadTestMesh());
+  EXPECT_NE(cache.Find(path), nullptr);
+
+  std::ofstream(path, std::ios::app) << "v 1 2 3\n";
+  EXPECT_EQ(cache.Find(path), nullptr);
+  EXPECT_EQ(cache.GetEntriesCount(), 0);
+
+  // файл изменился во время разбора: запись устарела сразу после вставки
+  s21::FileStamp stamp = s21::FileStamp::Of(path);
+  std::ofstream(path, std::ios::app) << "v 4 5 6\n";
+  cache.Insert(path, stamp, LoadTestMesh());
+  EXPECT_EQ(cache.Find(path), nullptr);
+  QFile::remove(QString::fromStdString(path));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для ModelPrefetcher
+
+static bool EndsWith(const std::string &text, const std::string &suffix) {
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+TEST(ModelPrefetcherTest, Neighbours) {
+  EXPECT_TRUE(EndsWith(s21::ModelPrefetcher::Neighbour("tests/cube.obj", 1),
+                       "/tests/cube_errors.obj"));
+  EXPECT_TRUE(s21::ModelPrefetcher::Neighbour("tests/cube.obj", -1).empty());
+  EXPECT_TRUE(
+      s21::ModelPrefetcher::Neighbour("tests/cube_errors4.obj", 1).empty());
+
+  std::vector<std::string> candidates =
+      s21::ModelPrefetcher::Candidates("tests/cube_errors.obj", 2);
+  ASSERT_EQ(candidates.size(), 3);
+  EXPECT_TRUE(EndsWith(candidates[0], "/cube_errors2.obj"));
+  EXPECT_TRUE(EndsWith(candidates[1], "/cube_errors3.obj"));
+  EXPECT_TRUE(EndsWith(candidates[2], "/cube.obj"));
+}
+
+TEST(ModelPrefetcherTest, PrefetchIntoCache) {
+  s21::JobSystem jobs(2);
+  s21::ModelCache cache;
+  s21::ModelPrefetcher prefetcher(cache);
+  prefetcher.Prefetch(jobs, "tests/cube_errors.obj");
+  jobs.WaitIdle();
+  EXPECT_EQ(cache.GetEntriesCount(), 0);  // выключен по умолчанию
+
+  prefetcher.SetEnabled(true);
+  prefetcher.Prefetch(jobs, "tests/cube_errors.obj");
+  jobs.WaitIdle();
+  // файлы с ошибками не кэшируются
+  EXPECT_TRUE(cache.Contains("tests/cube.obj"));
+  EXPECT_FALSE(cache.Contains("tests/cube_errors2.obj"));
+  EXPECT_EQ(cache.GetEntriesCount(), 1);
+
+  s21::MemoryStats stats;
+  prefetcher.AccountMemory(stats);
+  EXPECT_EQ(stats.GetCounter("prefetch_completed"), 1);
+  EXPECT_EQ(cache.Find("tests/cube.obj")->faces.size(), 12);
+  // завершенные задачи не остаются в списке ожидающих
+  EXPECT_EQ(prefetcher.GetPendingCount(), 0);
+}
+
+TEST(ModelPrefetcherTest, ClaimQueuedJob) {
+  s21::JobSystem jobs(1);
+  std::atomic<bool> gate{false};
+  jobs.Submit([&gate](const s21::CancellationToken &) {
+    while (!gate) std::this_thread::yield();
+  });
+  s21::ModelCache cache;
+  s21::ModelPrefetcher prefetcher(cache);
+  prefetcher.SetEnabled(true);
+  prefetcher.Prefetch(jobs, "tests/cube_errors.obj");
+  std::shared_ptr<s21::PrefetchJob> job = prefetcher.Claim("tests/cube.obj");
+  ASSERT_TRUE(job != nullptr);
+  EXPECT_TRUE(prefetcher.Claim("tests/cube.obj") == nullptr);
+  // разбор не начинался: загрузка пользователя забирает файл себе
+  EXPECT_TRUE(job->Join(s21::CancellationToken()) == nullptr);
+  gate = true;
+  jobs.WaitIdle();
+  EXPECT_FALSE(cache.Contains("tests/cube.obj"));
+}
+
+TEST(ModelPrefetcherTest, JoinRunningJob) {
+  s21::PrefetchJob job;
+  EXPECT_TRUE(job.Start());
+  auto mesh = std::make_shared<const s21::MeshData>();
+  std::thread worker([&job, mesh]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    job.Finish(mesh);
+  });
+  EXPECT_EQ(job.Join(s21::CancellationToken()), mesh);
+  worker.join();
+  EXPECT_FALSE(job.Start());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для ModelSlot
+
+TEST(ModelSlotTest, BuildFromMesh) {
+  s21::ObjLoader loader("tests/cube.obj");
+  loader.Load();
+  ASSERT_TRUE(loader.IsLoaded());
+  s21::MeshData mesh = loader.TakeData();
+  std::shared_ptr<s21::ModelSlot> slot = s21::ModelSlot::Build(mesh);
+
+  ASSERT_TRUE(slot->model && slot->gl_data);
+  EXPECT_EQ(slot->model->GetVerticesCount(), 8);
+  EXPECT_EQ(slot->model->GetEdgesCount(), mesh.edges.size());
+  EXPECT_EQ(slot->gl_data->vertices.size(), 8 * 3);
+  EXPECT_EQ(slot->gl_data->edges.size(), mesh.edges.size() * 2);
+  // исходные данные не перемещаются: их же кладет в кэш Scene
+  EXPECT_EQ(mesh.vertices.size(), 8);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для GlUploader
+
+TEST(GlUploaderTest, UploadsIntoSharedContextBuffers) {
+  if (!HasGuiPlatform()) {
+    GTEST_SKIP() << "no display";
+  }
+  QOffscreenSurface surface;
+  surface.create();
+  QOpenGLContext context;
+  ASSERT_TRUE(context.create());
+  ASSERT_TRUE(context.makeCurrent(&surface));
+  QOpenGLExtraFunctions *gl = context.extraFunctions();
+  GLuint buffers[2] = {0, 0};
+  gl->glGenBuffers(2, buffers);
+  context.doneCurrent();
+
+  // больше одной части, чтобы проверить загрузку частями
+  auto vertices = std::make_shared<std::vector<float>>(
+      s21::GlUploader::kChunkBytes / sizeof(float) + 1000);
+  for (size_t i = 0; i < vertices->size(); ++i) {
+    (*vertices)[i] = static_cast<float>(i % 1000);
+  }
+  auto indices = std::make_shared<std::vector<unsigned int>>(
+      std::vector<unsigned int>{0, 1, 1, 2, 2, 0});
+
+  std::vector<size_t> uploaded;
+  GLint vertex_bytes = 0, index_bytes = 0;
+  {
+    s21::GlUploader uploader(&context);
+    ASSERT_TRUE(uploader.IsValid());
+    QObject::connect(&uploader, &s21::GlUploader::Uploaded,
+                     [&](size_t generation, GLint vertex_size,
+                         GLint index_size) {
+                       uploaded.push_back(generation);
+                       vertex_bytes = vertex_size;
+                       index_bytes = index_size;
+                     });
+    uploader.Upload({1, buffers[0], buffers[1], vertices, indices});
+    uploader.Upload({2, buffers[0], buffers[1], vertices, indices});
+    for (int i = 0; i < 500 && (uploaded.empty() || uploaded.back() != 2);
+         ++i) {
+      QCoreApplication::processEvents();
+      QThread::msleep(10);
+    }
+  }
+  ASSERT_FALSE(uploaded.empty());
+  EXPECT_EQ(uploaded.back(), 2);
+  EXPECT_EQ(vertex_bytes,
+            static_cast<GLint>(vertices->size() * sizeof(float)));
+  EXPECT_EQ(index_bytes,
+            static_cast<GLint>(indices->size() * sizeof(unsigned int)));
+
+  // данные видны в контексте, с которым загрузчик разделяет объекты
+  ASSERT_TRUE(context.makeCurrent(&surface));
+  std::vector<float> read_back(vertices->size());
+  gl->glBindBuffer(GL_COPY_READ_BUFFER, buffers[0]);
+  float *mapped = static_cast<float *>(
+      gl->glMapBufferRange(GL_COPY_READ_BUFFER, 0,
+                           vertices->size() * sizeof(float), GL_MAP_READ_BIT));
+  ASSERT_NE(mapped, nullptr);
+  std::copy(mapped, mapped + vertices->size(), read_back.begin());
+  gl->glUnmapBuffer(GL_COPY_READ_BUFFER);
+  gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  gl->glDeleteBuffers(2, buffers);
+  context.doneCurrent();
+  EXPECT_EQ(read_back, *vertices);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для MeshLod
+
+// плоская сетка side x side вершин с ребрами по строкам и столбцам
+static void MakeGrid(int side, std::vector<float> &vertices,
+                     std::vector<unsigned int> &edges) {
+  for (int row = 0; row < side; ++row) {
+    for (int col = 0; col < side; ++col) {
+      vertices.insert(vertices.end(), {static_cast<float>(col),
+                                       static_cast<float>(row), 0.0f});
+      unsigned int index = static_cast<unsigned int>(row * side + col);
+      if (col + 1 < side) {
+        edges.insert(edges.end(), {index, index + 1});
+      }
+      if (row + 1 < side) {
+        edges.insert(edges.end(), {index, index + side});
+      }
+    }
+  }
+}
+
+TEST(MeshLodTest, ClusterMergesVertices) {
+  std::vector<float> vertices;
+  std::vector<unsigned int> edges;
+  MakeGrid(4, vertices, edges);
+  s21::BoundingBox box = s21::MeshLod::BoxOf(vertices);
+  EXPECT_TRUE(AreVectorsEqual(box.max, s21::Vector3D(3, 3, 0)));
+
+  // 2 x 2 ячейки: 4 вершины, 4 ребра между соседними ячейками
+  s21::LodLevel level = s21::MeshLod::Cluster(vertices, edges, box, 2);
+  EXPECT_EQ(level.vertices.size(), 4 * 3);
+  EXPECT_EQ(level.GetEdgesCount(), 4);
+  EXPECT_FLOAT_EQ(level.vertices[0], 0.5f);  // средняя точка ячейки
+
+  level = s21::MeshLod::Cluster(vertices, edges, box, 1);
+  EXPECT_EQ(level.vertices.size(), 3);
+  EXPECT_EQ(level.GetEdgesCount(), 0);
+}
+
+TEST(MeshLodTest, BuildHierarchyAndSelect) {
+  std::vector<float> vertices;
+  std::vector<unsigned int> edges;
+  MakeGrid(400, vertices, edges);
+  ASSERT_TRUE(s21::MeshLod::IsNeeded(edges.size() / 2));
+  EXPECT_FALSE(s21::MeshLod::IsNeeded(1000));
+
+  s21::MeshLod lod = s21::MeshLod::Build(vertices, edges);
+  const auto &levels = lod.GetLevels();
+  ASSERT_GE(levels.size(), 3);
+  size_t previous = lod.GetSourceEdgesCount();
+  for (const auto &level : levels) {
+    EXPECT_LE(level.GetEdgesCount() * 2, previous);
+    previous = level.GetEdgesCount();
+  }
+  EXPECT_LE(levels.back().GetEdgesCount(), s21::MeshLod::kMinLevelEdges);
+  EXPECT_GT(lod.GetBytes(), 0);
+
+  EXPECT_EQ(lod.SelectByScreenSize(1e6), -1);
+  EXPECT_EQ(lod.SelectByScreenSize(levels.back().resolution),
+            static_cast<int>(levels.size()) - 1);
+  EXPECT_EQ(lod.SelectByBudget(lod.GetSourceEdgesCount()), -1);
+  EXPECT_EQ(lod.SelectByBudget(levels[0].GetEdgesCount()), 0);
+  EXPECT_EQ(lod.SelectByBudget(1), static_cast<int>(levels.size()) - 1);
+
+  s21::BoundingBox box;
+  box.min = s21::Vector3D(-1, -1, 0);
+  box.max = s21::Vector3D(1, 0, 0);
+  s21::S21MatrixWrapper mvp(4, 4);
+  mvp.SetIdentity();
+  EXPECT_DOUBLE_EQ(s21::MeshLod::ScreenExtent(mvp, box, 200, 100), 200);
+}
+
+TEST(MeshLodTest, SmallModelDropsPreviousLod) {
+  if (!HasGuiPlatform()) {
+    GTEST_SKIP() << "no display";
+  }
+  std::vector<float> vertices;
+  std::vector<unsigned int> edges;
+  MakeGrid(400, vertices, edges);
+  s21::GLWidget widget(nullptr);
+  widget.SetModelData(vertices, edges, nullptr);
+  widget.SetLodLevels(std::make_shared<const s21::MeshLod>(
+      s21::MeshLod::Build(vertices, edges)));
+  s21::MemoryStats stats;
+  widget.AccountMemory(stats);
+  EXPECT_GT(stats.Get(s21::MemoryCategory::kLodLevels), 0);
+
+  // для маленькой модели уровни не строятся, прежние не должны остаться
+  vertices.clear();
+  edges.clear();
+  MakeGrid(4, vertices, edges);
+  ASSERT_FALSE(s21::MeshLod::IsNeeded(edges.size() / 2));
+  widget.SetModelData(vertices, edges, nullptr);
+  widget.AccountMemory(stats);
+  EXPECT_EQ(stats.Get(s21::MemoryCategory::kLodLevels), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для InteractionQuality
+
+TEST(InteractionQualityTest, StrideOrderPrefixIsUniformSample) {
+  std::vector<unsigned int> edges;
+  for (unsigned int i = 0; i < 10; ++i) {
+    edges.push_back(i);
+    edges.push_back(i + 100);
+  }
+  std::vector<unsigned int> ordered =
+      s21::InteractionQuality::StrideOrder(edges);
+  ASSERT_EQ(ordered.size(), edges.size());
+  std::vector<unsigned int> firsts;
+  for (size_t i = 0; i < ordered.size(); i += 2) {
+    EXPECT_EQ(ordered[i + 1], ordered[i] + 100);
+    firsts.push_back(ordered[i]);
+  }
+  EXPECT_EQ(firsts,
+            std::vector<unsigned int>({0, 8, 4, 2, 6, 1, 3, 5, 7, 9}));
+  EXPECT_TRUE(s21::InteractionQuality::StrideOrder({}).empty());
+}
+
+TEST(InteractionQualityTest, BudgetFollowsMeasuredTimes) {
+  s21::InteractionQuality quality(20.0);
+  EXPECT_EQ(quality.GetEdgesBudget(), std::numeric_limits<size_t>::max());
+
+  quality.AddDrawSample(1000, 10.0);  // 100 ребер в мс
+  EXPECT_EQ(quality.GetEdgesBudget(), 2000);
+  quality.AddFrameSample(1000, 40.0);  // кадр вдвое дольше бюджета
+  EXPECT_DOUBLE_EQ(quality.GetScale(), 0.5);
+  EXPECT_EQ(quality.GetEdgesBudget(), 1000);
+  quality.AddFrameSample(1000, 20.0);  // отрисовка - половина кадра
+  EXPECT_DOUBLE_EQ(quality.GetScale(), 0.5);
+
+  quality.AddDrawSample(500, 2.0);
+  EXPECT_DOUBLE_EQ(quality.GetEdgesPerMs(), 130.0);
+  quality.AddFrameSample(500, 20.0);
+  EXPECT_DOUBLE_EQ(quality.GetScale(), 0.55);
+  quality.RestartScale();
+  EXPECT_EQ(quality.GetEdgesBudget(), 2600);
+}
+
+TEST(InteractionQualityTest, FrameIntervalsWithoutTimerQueries) {
+  s21::InteractionQuality quality(20.0);
+  quality.AddFrameSample(1000, 50.0);
+  EXPECT_DOUBLE_EQ(quality.GetEdgesPerMs(), 20.0);
+  EXPECT_DOUBLE_EQ(quality.GetScale(), 0.5);
+  EXPECT_EQ(quality.GetEdgesBudget(), 200);
+  for (int i = 0; i < 20; ++i) {
+    quality.AddFrameSample(200, 200.0);
+  }
+  EXPECT_DOUBLE_EQ(quality.GetScale(),
+                   s21::InteractionQuality::kMinScale);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для EdgeClusters
+
+static std::vector<std::pair<unsigned int, unsigned int>> SortedEdgePairs(
+    const std::vector<unsigned int> &edges) {
+  std::vector<std::pair<unsigned int, unsigned int>> pairs;
+  for (size_t i = 0; i + 1 < edges.size(); i += 2) {
+    pairs.emplace_back(edges[i], edges[i + 1]);
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+TEST(EdgeClustersTest, BuildKeepsEdgesAndBoundsClusters) {
+  std::vector<float> vertices;
+  std::vector<unsigned int> edges;
+  MakeGrid(200, vertices, edges);
+  std::vector<unsigned int> ordered = edges;
+  s21::EdgeClusters clusters = s21::EdgeClusters::Build(vertices, ordered);
+  ASSERT_EQ(ordered.size(), edges.size());
+  EXPECT_EQ(SortedEdgePairs(ordered), SortedEdgePairs(edges));
+
+  const std::vector<s21::EdgeCluster> &list = clusters.GetClusters();
+  size_t edges_count = edges.size() / 2;
+  EXPECT_EQ(list.size(), (edges_count + s21::EdgeClusters::kClusterEdges - 1) /
+                             s21::EdgeClusters::kClusterEdges);
+  size_t next_edge = 0;
+  for (const s21::EdgeCluster &cluster : list) {
+    EXPECT_EQ(cluster.first_edge, next_edge);
+    next_edge += cluster.edges_count;
+    for (size_t i = cluster.first_edge * 2; i < next_edge * 2; ++i) {
+      const float *point = &vertices[ordered[i] * 3];
+      EXPECT_TRUE(point[0] >= cluster.box.min.x &&
+                  point[0] <= cluster.box.max.x &&
+                  point[1] >= cluster.box.min.y &&
+                  point[1] <= cluster.box.max.y);
+    }
+  }
+  EXPECT_EQ(next_edge, clusters.GetEdgesCount());
+  EXPECT_GT(clusters.GetBytes(), 0);
+}
+
+TEST(EdgeClustersTest, CullKeepsOnlyVisibleClusters) {
+  std::vector<float> vertices;
+  std::vector<unsigned int> edges;
+  MakeGrid(200, vertices, edges);
+  s21::EdgeClusters clusters = s21::EdgeClusters::Build(vertices, edges);
+  std::vector<size_t> visible;
+
+  // в пирамиду [-1, 1] попадает только угол сетки у начала координат
+  s21::S21MatrixWrapper mvp(4, 4);
+  mvp.SetIdentity();
+  clusters.Cull(mvp, visible);
+  EXPECT_GE(visible.size(), 1);
+  EXPECT_LT(visible.size(), clusters.GetClusters().size());
+  for (size_t index : visible) {
+    const s21::BoundingBox &box = clusters.GetClusters()[index].box;
+    EXPECT_TRUE(box.min.x <= 1 && box.min.y <= 1);
+  }
+
+  // вся сетка в [-1, 1]
+  mvp(0, 0) = mvp(1, 1) = 1.0 / 100;
+  mvp(0, 3) = mvp(1, 3) = -1.0;
+  clusters.Cull(mvp, visible);
+  EXPECT_EQ(visible.size(), clusters.GetClusters().size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для FeatureEdges
+
+// куб [0, 1]^3, вершина i = x + 2y + 4z, грани обходятся против часовой
+// стрелки при взгляде снаружи
+static void MakeCube(std::vector<s21::Vector3D> &vertices,
+                     std::vector<std::vector<unsigned int>> &faces) {
+  for (int i = 0; i < 8; ++i) {
+    vertices.emplace_back(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+  }
+  faces = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+           {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+}
+
+TEST(FeatureEdgesTest, ClassifiesEdges) {
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  s21::FeatureEdges cube = s21::FeatureEdges::Build(
+      vertices, faces, s21::MeshAdjacency::Build(vertices.size(), faces));
+  EXPECT_EQ(cube.GetCount(s21::EdgeKind::kCrease), 12);
+  EXPECT_EQ(cube.GetCount(s21::EdgeKind::kSmooth), 0);
+  EXPECT_EQ(cube.GetFeatureEdges().size(), 24);
+
+  // плоскость из четырех квадратов и лишний треугольник на ребре 1-4
+  vertices.clear();
+  for (int i = 0; i < 9; ++i) {
+    vertices.emplace_back(i % 3, i / 3, 0);
+  }
+  vertices.emplace_back(1, 0.5, 1);
+  faces = {{0, 1, 4, 3}, {1, 2, 5, 4}, {3, 4, 7, 6}, {4, 5, 8, 7}, {1, 4, 9}};
+  s21::FeatureEdges plane = s21::FeatureEdges::Build(
+      vertices, faces, s21::MeshAdjacency::Build(vertices.size(), faces));
+  EXPECT_EQ(plane.GetCount(s21::EdgeKind::kBoundary), 10);
+  EXPECT_EQ(plane.GetCount(s21::EdgeKind::kSmooth), 3);
+  EXPECT_EQ(plane.GetCount(s21::EdgeKind::kNonManifold), 1);
+  EXPECT_EQ(plane.GetCount(s21::EdgeKind::kCrease), 0);
+  EXPECT_GT(plane.GetBytes(), 0);
+}
+
+TEST(FeatureEdgesTest, SilhouetteFollowsView) {
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  // при пороге больше 90 градусов все ребра куба гладкие
+  s21::FeatureEdges cube = s21::FeatureEdges::Build(
+      vertices, faces, s21::MeshAdjacency::Build(vertices.size(), faces),
+      100.0);
+  EXPECT_TRUE(cube.GetFeatureEdges().empty());
+
+  // параллельная проекция вдоль z: камера - направление (0, 0, 1)
+  s21::S21MatrixWrapper mvp(4, 4);
+  mvp.SetIdentity();
+  std::array<double, 4> camera = s21::FeatureEdges::CameraPoint(mvp);
+  EXPECT_DOUBLE_EQ(camera[0], 0);
+  EXPECT_DOUBLE_EQ(camera[1], 0);
+  EXPECT_DOUBLE_EQ(camera[2], 1);
+  EXPECT_DOUBLE_EQ(camera[3], 0);
+
+  // контур - рамка лицевой грани z = 1
+  std::vector<unsigned int> silhouette;
+  cube.Silhouette(mvp, silhouette);
+  ASSERT_EQ(silhouette.size(), 8);
+  for (unsigned int index : silhouette) {
+    EXPECT_GE(index, 4);
+  }
+
+  // поворот на 90 градусов вокруг y: к камере обращена грань x = 1
+  // (нечетные вершины)
+  mvp(0, 0) = 0;
+  mvp(0, 2) = -1;
+  mvp(2, 2) = 0;
+  mvp(2, 0) = 1;
+  cube.Silhouette(mvp, silhouette);
+  ASSERT_EQ(silhouette.size(), 8);
+  for (unsigned int index : silhouette) {
+    EXPECT_EQ(index % 2, 1);
+  }
+}
+
+TEST(FeatureEdgesTest, NewModelDropsFeatures) {
+  if (!HasGuiPlatform()) {
+    GTEST_SKIP() << "no display";
+  }
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  s21::GLWidget widget(nullptr);
+  widget.SetFeatureEdges(std::make_shared<const s21::FeatureEdges>(
+      s21::FeatureEdges::Build(
+          vertices, faces,
+          s21::MeshAdjacency::Build(vertices.size(), faces))));
+  s21::MemoryStats stats;
+  widget.AccountMemory(stats);
+  EXPECT_GT(stats.Get(s21::MemoryCategory::kFeatureEdges), 0);
+
+  // ребра прежней модели не занимают память, пока режим не включат снова
+  widget.SetModelData({0, 0, 0, 1, 0, 0}, {0, 1}, nullptr);
+  widget.AccountMemory(stats);
+  EXPECT_EQ(stats.Get(s21::MemoryCategory::kFeatureEdges), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для MeshAdjacency
+
+TEST(MeshAdjacencyTest, CubeConnectivity) {
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  s21::MeshAdjacency adjacency =
+      s21::MeshAdjacency::Build(vertices.size(), faces);
+  ASSERT_EQ(adjacency.GetEdgesCount(), 12);
+  EXPECT_EQ(adjacency.GetFacesCount(), 6);
+  EXPECT_EQ(adjacency.GetVerticesCount(), 8);
+
+  for (size_t edge = 0; edge < adjacency.GetEdgesCount(); ++edge) {
+    auto [a, b] = adjacency.GetEdge(edge);
+    EXPECT_LT(a, b);
+    EXPECT_EQ(adjacency.GetEdgeFaces(edge).size(), 2);
+    EXPECT_TRUE(adjacency.IsManifoldEdge(edge));
+  }
+  // сторона j грани соединяет ее вершины j и j + 1, у каждой стороны есть
+  // соседняя грань через ребро
+  for (size_t face = 0; face < faces.size(); ++face) {
+    std::span<const unsigned int> edges = adjacency.GetFaceEdges(face);
+    ASSERT_EQ(edges.size(), 4);
+    for (size_t j = 0; j < edges.size(); ++j) {
+      auto [a, b] = adjacency.GetEdge(edges[j]);
+      unsigned int first = faces[face][j];
+      unsigned int second = faces[face][(j + 1) % 4];
+      EXPECT_EQ(a, std::min(first, second));
+      EXPECT_EQ(b, std::max(first, second));
+      unsigned int opposite = adjacency.GetOppositeFace(edges[j], face);
+      EXPECT_TRUE(opposite < faces.size() && opposite != face);
+    }
+  }
+  for (size_t vertex = 0; vertex < vertices.size(); ++vertex) {
+    EXPECT_EQ(adjacency.GetVertexEdges(vertex).size(), 3);
+  }
+  EXPECT_GT(adjacency.GetBytes(), 0);
+}
+
+TEST(MeshAdjacencyTest, BoundaryAndNonManifoldEdges) {
+  // два треугольника на общем ребре 0-1, третий на нем же, отрезок 3-4 и
+  // вершина 5 без ребер
+  std::vector<std::vector<unsigned int>> faces = {
+      {0, 1, 2}, {1, 0, 3}, {0, 1, 4}, {3, 4}};
+  s21::MeshAdjacency adjacency = s21::MeshAdjacency::Build(6, faces);
+  ASSERT_EQ(adjacency.GetEdgesCount(), 8);
+  EXPECT_EQ(adjacency.GetEdge(0), std::make_pair(0u, 1u));
+  EXPECT_EQ(adjacency.GetEdgeFaces(0).size(), 3);
+  EXPECT_FALSE(adjacency.IsManifoldEdge(0));
+  EXPECT_EQ(adjacency.GetOppositeFace(0, 0), s21::MeshAdjacency::kNone);
+  EXPECT_EQ(adjacency.GetFaceEdges(3).size(), 1);
+  EXPECT_EQ(adjacency.GetEdgeFaces(adjacency.GetFaceEdges(3)[0]).size(), 1);
+  EXPECT_EQ(adjacency.GetVertexEdges(0).size(), 4);
+  EXPECT_EQ(adjacency.GetVertexEdges(5).size(), 0);
+}
+
+TEST(MeshAdjacencyTest, CancelledBuildIsEmpty) {
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  s21::CancellationToken token;
+  token.Cancel();
+  s21::MeshAdjacency adjacency =
+      s21::MeshAdjacency::Build(vertices.size(), faces, token);
+  EXPECT_EQ(adjacency.GetFacesCount(), 0);
+  EXPECT_EQ(adjacency.GetEdgesCount(), 0);
+  EXPECT_EQ(adjacency.GetVerticesCount(), 0);
+}
+
+TEST(MeshAdjacencyTest, ModelBuildsAdjacencyOnce) {
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  s21::Model3D model;
+  model.SetData(vertices, faces, {{0, 1}});
+  EXPECT_FALSE(model.HasAdjacency());
+  s21::MemoryStats stats;
+  model.AccountMemory(stats);
+  EXPECT_EQ(stats.Get(s21::MemoryCategory::kMeshAdjacency), 0);
+
+  std::shared_ptr<const s21::MeshAdjacency> adjacency = model.GetAdjacency();
+  EXPECT_TRUE(model.HasAdjacency());
+  EXPECT_TRUE(model.GetAdjacency() == adjacency);
+  EXPECT_EQ(adjacency->GetEdgesCount(), 12);
+  model.AccountMemory(stats);
+  EXPECT_EQ(stats.Get(s21::MemoryCategory::kMeshAdjacency),
+            adjacency->GetBytes());
+
+  model.SetData(vertices, {{0, 1, 3}}, {{0, 1}});
+  EXPECT_FALSE(model.HasAdjacency());
+  EXPECT_EQ(model.GetAdjacency()->GetEdgesCount(), 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Тесты для MeshValidation
+
+TEST(MeshValidationTest, ClosedCubeIsValid) {
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  s21::MeshValidation validation = s21::MeshValidation::Run(
+      vertices, faces, s21::MeshAdjacency::Build(vertices.size(), faces));
+  EXPECT_TRUE(validation.IsValid());
+  EXPECT_EQ(validation.GetIssuesCount(), 0);
+  EXPECT_TRUE(validation.Summary() == "Validation: no issues");
+}
+
+TEST(MeshValidationTest, ModelAdjacencyIsNotKept) {
+  std::vector<s21::Vector3D> vertices;
+  std::vector<std::vector<unsigned int>> faces;
+  MakeCube(vertices, faces);
+  s21::Model3D model;
+  model.SetData(vertices, faces, {{0, 1}});
+  EXPECT_TRUE(s21::MeshValidation::Run(model).IsValid());
+  EXPECT_FALSE(model.HasAdjacency());
+
+  // уже построенная смежность (режим характерных ребер) используется
+  std::shared_ptr<const s21::MeshAdjacency> adjacency = model.GetAdjacency();
+  EXPECT_TRUE(s21::MeshValidation::Run(model).IsValid());
+  EXPECT_TRUE(model.GetAdjacency() == adjacency);
+}
+
+TEST(MeshValidationTest, FindsIssues) {
+  // 6 - вершина без граней, 7 и 8 - без граней и с неверными координатами
+  std::vector<s21::Vector3D> vertices = {
+      {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 1},
+      {2, 0, 1}, {5, 5, 5}, {1e9, 0, 0},
+      {std::numeric_limits<double>::quiet_NaN(), 0, 0}};
+  // грань 1 повторяет грань 0, ребро 0-1 у трех граней, грань 3 лежит на
+  // прямой, грань 4 - отрезок (линия, а не вырожденная грань)
+  std::vector<std::vector<unsigned int>> faces = {
+      {0, 1, 2}, {2, 1, 0}, {0, 1, 3}, {3, 4, 5}, {4, 5}};
+  s21::MeshValidation validation = s21::MeshValidation::Run(
+      vertices, faces, s21::MeshAdjacency::Build(vertices.size(), faces));
+  using s21::MeshIssue;
+  ASSERT_EQ(validation.GetCount(MeshIssue::kDegenerateFace), 1);
+  EXPECT_EQ(validation.GetSamples(MeshIssue::kDegenerateFace)[0].index, 3);
+  ASSERT_EQ(validation.GetCount(MeshIssue::kDuplicateFace), 1);
+  EXPECT_EQ(validation.GetSamples(MeshIssue::kDuplicateFace)[0].index, 1);
+  EXPECT_EQ(validation.GetSamples(MeshIssue::kDuplicateFace)[0].other, 0);
+  EXPECT_EQ(validation.GetCount(MeshIssue::kUnreferencedVertex), 3);
+  EXPECT_EQ(validation.GetSamples(MeshIssue::kUnreferencedVertex)[0].index,
+            6);
+  ASSERT_EQ(validation.GetCount(MeshIssue::kNonManifoldEdge), 1);
+  EXPECT_EQ(validation.GetSamples(MeshIssue::kNonManifoldEdge)[0].index, 0);
+  EXPECT_EQ(validation.GetSamples(MeshIssue::kNonManifoldEdge)[0].other, 1);
+  EXPECT_EQ(validation.GetCount(MeshIssue::kOutOfRangeCoordinate), 2);
+  EXPECT_EQ(validation.GetIssuesCount(), 8);
+  EXPECT_FALSE(validation.IsValid());
+
+  // примеров не больше kMaxSamples, повторы ссылаются на первую грань
+  faces.assign(20, {0, 1, 2});
+  validation = s21::MeshValidation::Run(
+      vertices, faces, s21::MeshAdjacency::Build(vertices.size(), faces));
+  EXPECT_EQ(validation.GetCount(MeshIssue::kDuplicateFace), 19);
+  ASSERT_EQ(validation.GetSamples(MeshIssue::kDuplicateFace).size(),
+            s21::MeshValidation::kMaxSamples);
+  for (const s21::MeshIssueSample &sample :
+       validation.GetSamples(MeshIssue::kDuplicateFace)) {
+    EXPECT_EQ(sample.other, 0);
+  }
+}
+
+TEST(MeshValidationTest, BatchReport) {
+  s21::BatchOptions options = s21::BatchCli::ParseArguments(
+      {"3d_viewer", "--batch", "--validate", "tests/cube.obj"});
+  EXPECT_TRUE(options.validate);
+  std::vector<s21::BatchResult> results = s21::BatchProcessor(options).Run();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_TRUE(results[0].validated);
+  EXPECT_TRUE(results[0].validation.IsValid());
+  // смежность нужна только на время проверки и у модели не остается
+  EXPECT_EQ(results[0].memory.Get(s21::MemoryCategory::kMeshAdjacency), 0);
+
+  QJsonObject json = s21::BatchProcessor::ResultToJson(results[0]);
+  QJsonObject validation = json["validation"].toObject();
+  EXPECT_TRUE(validation["valid"].toBool());
+  EXPECT_EQ(validation["issues"]
+                .toObject()["degenerate_faces"]
+                .toObject()["count"]
+                .toInt(),
+            0);
+  QJsonObject report = s21::BatchProcessor::ReportToJson(results, options, 0);
+  EXPECT_EQ(report["invalid"].toInt(), 0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char *argv[]) {
   testing::InitGoogleTest(&argc, argv);
+  // одно приложение на все тесты: QApplication, созданный и удаленный внутри
+  // теста вокруг контекстов OpenGL, ненадежен
+  std::unique_ptr<QApplication> application;
+  if (HasGuiPlatform()) {
+    application = std::make_unique<QApplication>(argc, argv);
+  }
   return RUN_ALL_TESTS();
 }
\ No newline at end of file
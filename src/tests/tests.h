@@ -5,6 +5,25 @@
 
 #include "../include/3dmodel.h"
 #include "../include/affine.h"
+#include "../include/batch_cli.h"
+#include "../include/edge_clusters.h"
+#include "../include/feature_edges.h"
+#include "../include/frame_buffer.h"
+#include "../include/gif_encoder.h"
+#include "../include/gui.h"
+#include "../include/image_encoder.h"
+#include "../include/interaction_quality.h"
+#include "../include/job_system.h"
+#include "../include/memory_stats.h"
+#include "../include/mesh_adjacency.h"
+#include "../include/mesh_validation.h"
+#include "../include/mesh_lod.h"
+#include "../include/model_cache.h"
+#include "../include/model_prefetcher.h"
+#include "../include/scene.h"
+#include "../include/session_store.h"
+#include "../include/tiled_screenshot.h"
+#include "../include/tracer.h"
 
 using faces_vector_type = std::vector<std::vector<unsigned int>>;
 bool AreDoublesEq(const double first, const double second);
@@ -23,6 +42,7 @@ bool IsEdgesSizeEqual(const unordered_set_pair_hash &e1,
                       const unordered_set_pair_hash &e2);
 bool AreEdgesSetEqual(const unordered_set_pair_hash &e1,
                       const unordered_set_pair_hash &e2);
+bool HasGuiPlatform();
 
 class SignalTaker : public QObject {
   Q_OBJECT